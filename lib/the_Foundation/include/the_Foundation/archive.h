@@ -68,6 +68,9 @@ const iBlock *          data_Archive        (const iArchive *, const iString *pa
 const iBlock *          dataCStr_Archive    (const iArchive *d, const char *pathCStr);
 const iBlock *          dataAt_Archive      (const iArchive *, size_t index);
 
+void    releaseData_Archive     (const iArchive *, const iString *path); /* until next access */
+void    releaseDataCStr_Archive (const iArchive *, const char *pathCStr);
+
 void    setData_Archive     (iArchive *, const iString *path, const iBlock *data);
 void    setDataCStr_Archive (iArchive *, const char *path, const iBlock *data);
 void    serialize_Archive   (const iArchive *, iStream *);
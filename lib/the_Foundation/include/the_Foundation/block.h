@@ -131,6 +131,9 @@ void            insertData_Block    (iBlock *, size_t insertAt, const void *data
 
 uint32_t        crc32_Block         (const iBlock *);
 void            md5_Block           (const iBlock *, uint8_t md5_out[16]);
+#if defined (iHaveTlsRequest)
+void            sha256_Block        (const iBlock *, uint8_t sha256_out[32]);
+#endif
 
 iString *       decode_Block        (const iBlock *, const char *textEncoding);
 iString *       hexEncode_Block     (const iBlock *);
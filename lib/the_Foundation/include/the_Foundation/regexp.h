@@ -40,6 +40,8 @@ iDeclareType(RegExpMatch)
 
 #define iRegExpMaxSubstrings  32
 
+typedef iBool (*iRegExpMatchFunc)(void *context, const iRegExpMatch *);
+
 enum iRegExpOption {
     caseSensitive_RegExpOption      = 0,
     caseInsensitive_RegExpOption    = 0x1,
@@ -67,12 +69,30 @@ void        deinit_RegExp(iRegExp *);
 
 iBool       match_RegExp(const iRegExp *, const char *subject, size_t len, iRegExpMatch *match);
 
+/**
+ * Finds all matches of the regular expression in the subject. The callback is called for
+ * each match in order; returning false from it stops the iteration. Matching state is
+ * set up only once for the entire subject.
+ *
+ * @return Number of matches found.
+ */
+size_t      matchAll_RegExp(const iRegExp *, const char *subject, size_t len,
+                            iRegExpMatchFunc func, void *context);
+
 iLocalDef iBool matchString_RegExp(const iRegExp *d, const iString *str, iRegExpMatch *match) {
     return match_RegExp(d, cstr_String(str), size_String(str), match);
 }
 iLocalDef iBool matchRange_RegExp(const iRegExp *d, iRangecc subject, iRegExpMatch *match) {
     return match_RegExp(d, subject.start, size_Range(&subject), match);
 }
+iLocalDef size_t matchAllString_RegExp(const iRegExp *d, const iString *str,
+                                      iRegExpMatchFunc func, void *context) {
+    return matchAll_RegExp(d, cstr_String(str), size_String(str), func, context);
+}
+iLocalDef size_t matchAllRange_RegExp(const iRegExp *d, iRangecc subject,
+                                     iRegExpMatchFunc func, void *context) {
+    return matchAll_RegExp(d, subject.start, size_Range(&subject), func, context);
+}
 
 /*----------------------------------------------------------------------------------------------*/
 
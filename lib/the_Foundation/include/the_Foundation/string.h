@@ -338,6 +338,7 @@ iLocalDef iRangecc range_CStr(const char *cstr) {
 const char *    cstr_Rangecc        (iRangecc); /* returns NULL-terminated collected copy */
 const iString * string_Rangecc      (iRangecc); /* returns a collected String */
 
+iBool           isAscii_Rangecc     (iRangecc); /* checks if the range is all 7-bit ASCII */
 iBool           isUtf8_Rangecc      (iRangecc); /* checks if the range is well-formed UTF-8 */
 size_t          length_Rangecc      (iRangecc); /* returns number of characters in the range */
 
@@ -608,6 +608,20 @@ const iBlock *dataCStr_Archive(const iArchive *d, const char *pathCStr) {
     return data_Archive(d, &iStringLiteral(pathCStr)); /* string used for lookup; not retained */
 }
 
+void releaseData_Archive(const iArchive *d, const iString *path) {
+    const size_t index = findPath_Archive_(d, path);
+    if (!d->isWritable && index < size_SortedArray(d->entries)) {
+        /* The data can be reloaded from the source. */
+        iArchiveEntry *entry = at_SortedArray(d->entries, index);
+        delete_Block(entry->data);
+        entry->data = NULL;
+    }
+}
+
+void releaseDataCStr_Archive(const iArchive *d, const char *pathCStr) {
+    releaseData_Archive(d, &iStringLiteral(pathCStr)); /* string used for lookup; not retained */
+}
+
 void setData_Archive(iArchive *d, const iString *path, const iBlock *data) {
     if (d->isWritable) {
         iArchiveEntry *entry = writableEntryAt_Archive_(d, findOrAddEntry_Archive_(d, path));
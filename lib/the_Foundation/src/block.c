@@ -40,6 +40,9 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.</small>
 #if defined (iHaveZlib)
 #   include <zlib.h>
 #endif
+#if defined (iHaveTlsRequest)
+#   include <openssl/sha.h>
+#endif
 
 /// @todo Needs a ref-counting mutex.
 static iBlockData emptyBlockData = {
@@ -462,6 +465,12 @@ void md5_Block(const iBlock *d, uint8_t md5_out[16]) {
     iMd5Hash(d->i->data, d->i->size, md5_out);
 }
 
+#if defined (iHaveTlsRequest)
+void sha256_Block(const iBlock *d, uint8_t sha256_out[32]) {
+    SHA256((const unsigned char *) d->i->data, d->i->size, sha256_out);
+}
+#endif
+
 iString *decode_Block(const iBlock *d, const char *textEncoding) {
     size_t len = 0;
     uint8_t *data = u8_conv_from_encoding(textEncoding,
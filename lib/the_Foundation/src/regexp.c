@@ -34,12 +34,47 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.</small>
 #   error libpcre or libpcre2 is required for regular expressions
 #endif
 
+#include "the_Foundation/stdthreads.h"
+
 #include <stdio.h>
+#include <stdlib.h>
+
+/* Per-thread matching state, so that matching does not allocate anything after the first
+   call in each thread. */
+iDeclareType(RegExpThreadData)
+
+static tss_t threadLocal_RegExp_;
+
+static iRegExpThreadData *new_RegExpThreadData_    (void);
+static void               delete_RegExpThreadData_ (iRegExpThreadData *);
+
+void init_RegExp_(void) {
+    tss_create(&threadLocal_RegExp_, (tss_dtor_t) delete_RegExpThreadData_);
+}
+
+void deinitForThread_RegExp_(void) {
+    iRegExpThreadData *d = tss_get(threadLocal_RegExp_);
+    if (d) {
+        delete_RegExpThreadData_(d);
+        tss_set(threadLocal_RegExp_, NULL);
+    }
+}
+
+static iRegExpThreadData *threadData_RegExp_(void) {
+    iRegExpThreadData *d = tss_get(threadLocal_RegExp_);
+    if (!d) {
+        tss_set(threadLocal_RegExp_, d = new_RegExpThreadData_());
+    }
+    return d;
+}
 
 iBool isSyntaxChar_RegExp(iChar ch) {
     return strchr("|()[]{}.\\", ch) != NULL;
 }
 
+#define iJitStackInitialSize    (32 * 1024)
+#define iJitStackMaxSize        (512 * 1024)
+
 #if defined (iHavePcre2) /* PCRE version 10 */
 
 #define PCRE2_CODE_UNIT_WIDTH 8
@@ -48,8 +83,35 @@ iBool isSyntaxChar_RegExp(iChar ch) {
 struct Impl_RegExp {
     iObject object;
     pcre2_code *re;
+    uint32_t numCaptures;
+};
+
+struct Impl_RegExpThreadData {
+    pcre2_match_data    *matchData;
+    pcre2_match_context *context;
+    pcre2_jit_stack     *jitStack;
 };
 
+static iRegExpThreadData *new_RegExpThreadData_(void) {
+    iRegExpThreadData *d = iMalloc(RegExpThreadData);
+    d->matchData = pcre2_match_data_create(iRegExpMaxSubstrings + 1, NULL);
+    d->context   = pcre2_match_context_create(NULL);
+    d->jitStack  = pcre2_jit_stack_create(iJitStackInitialSize, iJitStackMaxSize, NULL);
+    if (d->jitStack) {
+        pcre2_jit_stack_assign(d->context, NULL, d->jitStack);
+    }
+    return d;
+}
+
+static void delete_RegExpThreadData_(iRegExpThreadData *d) {
+    if (d) {
+        pcre2_jit_stack_free(d->jitStack);
+        pcre2_match_context_free(d->context);
+        pcre2_match_data_free(d->matchData);
+        free(d);
+    }
+}
+
 iRegExp *new_RegExp(const char *pattern, enum iRegExpOption options) {
     uint32_t opts = PCRE2_UTF | PCRE2_UCP | PCRE2_NO_UTF_CHECK;
     if (options & caseInsensitive_RegExpOption) {
@@ -61,6 +123,7 @@ iRegExp *new_RegExp(const char *pattern, enum iRegExpOption options) {
     int errorCode = 0;
     PCRE2_SIZE errorOffset = 0;
     iRegExp *d = iNew(RegExp);
+    d->numCaptures = 0;
     d->re = pcre2_compile((PCRE2_SPTR) pattern, PCRE2_ZERO_TERMINATED, opts,
                           &errorCode, &errorOffset, NULL);
     if (!d->re) {
@@ -68,6 +131,11 @@ iRegExp *new_RegExp(const char *pattern, enum iRegExpOption options) {
         pcre2_get_error_message(errorCode, errorMsg, sizeof(errorMsg));
         iDebug("new_RegExp: \"%s\" %s (at offset %i)\n", pattern, errorMsg, errorOffset);
     }
+    else {
+        pcre2_pattern_info(d->re, PCRE2_INFO_CAPTURECOUNT, &d->numCaptures);
+        /* If JIT is unavailable, matching falls back to the interpreter. */
+        pcre2_jit_compile(d->re, PCRE2_JIT_COMPLETE);
+    }
     return d;
 }
 
@@ -77,29 +145,22 @@ void deinit_RegExp(iRegExp *d) {
     }
 }
 
-iBool match_RegExp(const iRegExp *d, const char *subject, size_t len, iRegExpMatch *match) {
-    if (!d->re || !subject) return iFalse;
-    if (!match->subject) {
-        /* The match object is uninitialized, so initialize it now. */
-        match->subject = subject;        
-    }
-    iAssert(match->subject == subject); /* first or subsequent match */
-    if (match->pos > len) return iFalse;
-    pcre2_match_data *matchData = pcre2_match_data_create_from_pattern(d->re, NULL);
+static iBool match_RegExp_(const iRegExp *d, iRegExpThreadData *td, const char *subject,
+                           size_t len, iBool isUtfChecked, iRegExpMatch *match) {
     int rc = pcre2_match(d->re, (PCRE2_SPTR) subject, (PCRE2_SIZE) len, (PCRE2_SIZE) match->pos,
-                         0, matchData, NULL);
-    if (rc >= 1) {
-        PCRE2_SIZE *output = pcre2_get_ovector_pointer(matchData);
-        uint32_t count = pcre2_get_ovector_count(matchData);
+                         isUtfChecked ? PCRE2_NO_UTF_CHECK : 0, td->matchData, td->context);
+    /* Zero means a match with more captures than fit in the vector. */
+    if (rc >= 0) {
+        const PCRE2_SIZE *output = pcre2_get_ovector_pointer(td->matchData);
+        const uint32_t count = iMin(d->numCaptures + 1, iRegExpMaxSubstrings + 1);
         iRangei *mrange = &match->range;
-        for (uint32_t i = 0; i < count && i <= iRegExpMaxSubstrings; i++, mrange++) {
+        for (uint32_t i = 0; i < count; i++, mrange++) {
             mrange->start = (int) output[2 * i];
             mrange->end   = (int) output[2 * i + 1];
         }
         match->pos = match->range.end;
     }
-    pcre2_match_data_free(matchData);
-    return rc >= 1;
+    return rc >= 0;
 }
 
 #else /* PCRE version 8 */
@@ -109,8 +170,33 @@ iBool match_RegExp(const iRegExp *d, const char *subject, size_t len, iRegExpMat
 struct Impl_RegExp {
     iObject object;
     pcre *re;
+    pcre_extra *extra;
+};
+
+struct Impl_RegExpThreadData {
+    pcre_jit_stack *jitStack;
 };
 
+static iRegExpThreadData *new_RegExpThreadData_(void) {
+    iRegExpThreadData *d = iMalloc(RegExpThreadData);
+    d->jitStack = pcre_jit_stack_alloc(iJitStackInitialSize, iJitStackMaxSize);
+    return d;
+}
+
+static void delete_RegExpThreadData_(iRegExpThreadData *d) {
+    if (d) {
+        if (d->jitStack) {
+            pcre_jit_stack_free(d->jitStack);
+        }
+        free(d);
+    }
+}
+
+static pcre_jit_stack *jitStack_RegExp_(void *context) {
+    iUnused(context);
+    return threadData_RegExp_()->jitStack;
+}
+
 iRegExp *new_RegExp(const char *pattern, enum iRegExpOption options) {
     int opts = PCRE_UTF8 | PCRE_UCP;
     if (options & caseInsensitive_RegExpOption) {
@@ -122,30 +208,35 @@ iRegExp *new_RegExp(const char *pattern, enum iRegExpOption options) {
     const char *errorMsg = NULL;
     int errorOffset;
     iRegExp *d = iNew(RegExp);
+    d->extra = NULL;
     d->re = pcre_compile(pattern, opts, &errorMsg, &errorOffset, NULL);
     if (!d->re) {
         iDebug("new_RegExp: \"%s\" %s (at offset %i)\n", pattern, errorMsg, errorOffset);
     }
+    else {
+        d->extra = pcre_study(d->re, PCRE_STUDY_JIT_COMPILE, &errorMsg);
+        if (d->extra) {
+            pcre_assign_jit_stack(d->extra, jitStack_RegExp_, NULL);
+        }
+    }
     return d;
 }
 
 void deinit_RegExp(iRegExp *d) {
+    if (d->extra) {
+        pcre_free_study(d->extra);
+    }
     if (d->re) {
         pcre_free(d->re);
     }
 }
 
-iBool match_RegExp(const iRegExp *d, const char *subject, size_t len, iRegExpMatch *match) {
-    if (!d->re || !subject) return iFalse;
-    if (!match->subject) {
-        /* The match object is uninitialized, so initialize it now. */
-        match->subject = subject;        
-    }
-    iAssert(match->subject == subject); /* first or subsequent match */
-    if (match->pos > len) return iFalse;
-    int rc = pcre_exec(d->re, NULL,
+static iBool match_RegExp_(const iRegExp *d, iRegExpThreadData *td, const char *subject,
+                           size_t len, iBool isUtfChecked, iRegExpMatch *match) {
+    iUnused(td);
+    int rc = pcre_exec(d->re, d->extra,
                        subject, (int) len,
-                       (int) match->pos, 0,
+                       (int) match->pos, isUtfChecked ? PCRE_NO_UTF8_CHECK : 0,
                        &match->range.start,
                        iRegExpMaxSubstrings + 1);
     if (rc > 0) {
@@ -157,6 +248,46 @@ iBool match_RegExp(const iRegExp *d, const char *subject, size_t len, iRegExpMat
 
 #endif /* defined (iHavePcre) */
 
+static void begin_RegExpMatch_(iRegExpMatch *match, const char *subject) {
+    if (!match->subject) {
+        /* The match object is uninitialized, so initialize it now. */
+        match->subject = subject;
+    }
+    iAssert(match->subject == subject); /* first or subsequent match */
+}
+
+iBool match_RegExp(const iRegExp *d, const char *subject, size_t len, iRegExpMatch *match) {
+    if (!d->re || !subject) return iFalse;
+    begin_RegExpMatch_(match, subject);
+    if (match->pos > len) return iFalse;
+    return match_RegExp_(d, threadData_RegExp_(), subject, len, iFalse, match);
+}
+
+size_t matchAll_RegExp(const iRegExp *d, const char *subject, size_t len,
+                       iRegExpMatchFunc func, void *context) {
+    if (!d->re || !subject) return 0;
+    iRegExpThreadData *td = threadData_RegExp_();
+    iRegExpMatch match;
+    init_RegExpMatch(&match);
+    begin_RegExpMatch_(&match, subject);
+    size_t count = 0;
+    /* The subject is valid UTF-8 if the first match succeeds, so it is not checked again. */
+    while (match.pos <= len && match_RegExp_(d, td, subject, len, count > 0, &match)) {
+        count++;
+        if (func && !func(context, &match)) {
+            break;
+        }
+        if (match.range.start == match.range.end) {
+            /* Step over an empty match, keeping to character boundaries. */
+            if (match.pos == len) break;
+            do {
+                match.pos++;
+            } while (match.pos < len && (subject[match.pos] & 0xc0) == 0x80);
+        }
+    }
+    return count;
+}
+
 void init_RegExpMatch(iRegExpMatch *d) {
     iZap(*d);
 }
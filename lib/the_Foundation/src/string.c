@@ -49,6 +49,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.</small>
 #   include "platform/strnstr.h"
 #endif
 
+#if defined (iHaveAVX2)
+#   include <immintrin.h>
+#elif defined (iHaveSSE4_1)
+#   include <emmintrin.h>
+#elif defined (__ARM_NEON) && defined (__aarch64__)
+#   include <arm_neon.h>
+#   define iHaveNeon_
+#endif
+
 static char localeCharSet_[64];
 
 iLocalDef const char *currentLocaleLanguage_(void) {
@@ -390,41 +399,54 @@ void replace_String(iString *d, const char *src, const char *dst) {
 }
 
 #if defined (iHaveRegExp)
-int replaceRegExp_String(iString *d, const iRegExp *regexp, const char *replacement,
-                         void (*matchHandler)(void *, const iRegExpMatch *),
-                         void *context) {
-    iRegExpMatch m;
-    iString      result;
-    int          numMatches = 0;
-    const char  *pos        = constBegin_String(d);
-    init_RegExpMatch(&m);
-    init_String(&result);
-    while (matchString_RegExp(regexp, d, &m)) {
-        appendRange_String(&result, (iRangecc){ pos, begin_RegExpMatch(&m) });
-        /* Replace any capture group back-references. */
-        for (const char *ch = replacement; *ch; ch++) {
+iDeclareType(RegExpReplacement)
+
+struct Impl_RegExpReplacement {
+    const char *replacement;
+    void      (*matchHandler)(void *, const iRegExpMatch *);
+    void *      context;
+    iString     result;
+    const char *pos; /* end of the previous match */
+};
+
+static iBool replaceMatch_RegExpReplacement_(void *context, const iRegExpMatch *m) {
+    iRegExpReplacement *d = context;
+    appendRange_String(&d->result, (iRangecc){ d->pos, begin_RegExpMatch(m) });
+    /* Replace any capture group back-references. */
+    for (const char *ch = d->replacement; *ch; ch++) {
+        if (*ch == '\\') {
+            ch++;
             if (*ch == '\\') {
-                ch++;
-                if (*ch == '\\') {
-                    appendCStr_String(&result, "\\");
-                }
-                else if (*ch >= '0' && *ch <= '9') {
-                    appendRange_String(&result, capturedRange_RegExpMatch(&m, *ch - '0'));
-                }
+                appendCStr_String(&d->result, "\\");
             }
-            else {
-                appendData_Block(&result.chars, ch, 1);
+            else if (*ch >= '0' && *ch <= '9') {
+                appendRange_String(&d->result, capturedRange_RegExpMatch(m, *ch - '0'));
             }
         }
-        if (matchHandler) {
-            matchHandler(context, &m);
+        else {
+            appendData_Block(&d->result.chars, ch, 1);
         }
-        pos = end_RegExpMatch(&m);
-        numMatches++;
     }
-    appendRange_String(&result, (iRangecc){ pos, constEnd_String(d) });
-    set_String(d, &result);
-    deinit_String(&result);
+    if (d->matchHandler) {
+        d->matchHandler(d->context, m);
+    }
+    d->pos = end_RegExpMatch(m);
+    return iTrue;
+}
+
+int replaceRegExp_String(iString *d, const iRegExp *regexp, const char *replacement,
+                         void (*matchHandler)(void *, const iRegExpMatch *),
+                         void *context) {
+    iRegExpReplacement rep = { .replacement  = replacement,
+                               .matchHandler = matchHandler,
+                               .context      = context,
+                               .pos          = constBegin_String(d) };
+    init_String(&rep.result);
+    const int numMatches =
+        (int) matchAllString_RegExp(regexp, d, replaceMatch_RegExpReplacement_, &rep);
+    appendRange_String(&rep.result, (iRangecc){ rep.pos, constEnd_String(d) });
+    set_String(d, &rep.result);
+    deinit_String(&rep.result);
     return numMatches;
 }
 #endif
@@ -450,8 +472,64 @@ size_t length_String(const iString *d) {
     return u8_mbsnlen((const uint8_t *) cstr_String(d), size_String(d));
 }
 
+/* Returns a pointer to the first byte that is not 7-bit ASCII, or `end`. The vector loops
+   only locate the block; the exact byte is found by the scalar loops. */
+#if defined (iHaveAVX2)
+/* The library is not built for AVX2, so this is only called after a runtime CPU check. */
+__attribute__((target("avx2")))
+static const char *skipAsciiAVX2_(const char *ptr, const char *end) {
+    for (; end - ptr >= 32; ptr += 32) {
+        if (_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i *) ptr))) break;
+    }
+    return ptr;
+}
+#endif
+
+static const char *skipAscii_(const char *ptr, const char *end) {
+#if defined (iHaveAVX2)
+    if (end - ptr >= 32 && __builtin_cpu_supports("avx2")) {
+        ptr = skipAsciiAVX2_(ptr, end);
+    }
+#endif
+#if defined (iHaveAVX2) || defined (iHaveSSE4_1)
+    for (; end - ptr >= 16; ptr += 16) {
+        if (_mm_movemask_epi8(_mm_loadu_si128((const __m128i *) ptr))) break;
+    }
+#elif defined (iHaveNeon_)
+    for (; end - ptr >= 16; ptr += 16) {
+        if (vmaxvq_u8(vld1q_u8((const uint8_t *) ptr)) & 0x80) break;
+    }
+#endif
+    for (; end - ptr >= 8; ptr += 8) {
+        uint64_t word;
+        memcpy(&word, ptr, 8);
+        if (word & 0x8080808080808080ull) break;
+    }
+    while (ptr < end && !(*ptr & 0x80)) {
+        ptr++;
+    }
+    return ptr;
+}
+
+iBool isAscii_Rangecc(iRangecc d) {
+    return skipAscii_(d.start, d.end) == d.end;
+}
+
 iBool isUtf8_Rangecc(iRangecc d) {
-    return u8_check((const uint8_t *) d.start, size_Range(&d)) == NULL;
+    /* Multibyte sequences never contain ASCII bytes, so each run of non-ASCII bytes can be
+       validated on its own. */
+    const char *pos = d.start;
+    while ((pos = skipAscii_(pos, d.end)) < d.end) {
+        const char *runEnd = pos;
+        while (runEnd < d.end && (*runEnd & 0x80)) {
+            runEnd++;
+        }
+        if (u8_check((const uint8_t *) pos, runEnd - pos)) {
+            return iFalse;
+        }
+        pos = runEnd;
+    }
+    return iTrue;
 }
 
 size_t length_Rangecc(const iRangecc d) {
@@ -842,6 +920,20 @@ void prependCStr_String(iString *d, const char *cstr) {
     deinit_String(&pre);
 }
 
+static const char *findSeparator_(const char *start, const char *end, const char *separator,
+                                  size_t separatorSize) {
+    /* Bounded by `end`: the range is not necessarily NULL-terminated, and scanning past it
+       would make splitting a long buffer quadratic. */
+    while (end - start >= (ptrdiff_t) separatorSize) {
+        const char *found = memchr(start, separator[0], end - start - separatorSize + 1);
+        if (!found || !memcmp(found + 1, separator + 1, separatorSize - 1)) {
+            return found;
+        }
+        start = found + 1;
+    }
+    return NULL;
+}
+
 iBool nextSplit_Rangecc(const iRangecc str, const char *separator, iRangecc *range) {
     iAssert(range->start == NULL || contains_Range(&str, range->start));
     const size_t separatorSize = strlen(separator);
@@ -869,8 +961,8 @@ iBool nextSplit_Rangecc(const iRangecc str, const char *separator, iRangecc *ran
             return iFalse;
         }
     }
-    const char *found = strstr(range->start, separator);
-    range->end = (found && found < str.end ? found : str.end);
+    const char *found = findSeparator_(range->start, str.end, separator, separatorSize);
+    range->end = (found ? found : str.end);
     iAssert(range->start <= range->end);
     return iTrue;
 }
@@ -48,11 +48,13 @@ void deinit_Windows_(void);
 #endif
 
 void deinitForThread_Garbage_(void); /* garbage.c */
+void deinitForThread_RegExp_(void);  /* regexp.c */
 void deinit_DatagramThreads_(void);  /* datagram.c */
 void deinit_Address_(void);          /* address.c */
 void deinit_Threads_(void);          /* thread.c */
 void init_DatagramThreads_(void);    /* datagram.c */
 void init_Locale(void);              /* locale */
+void init_RegExp_(void);             /* regexp.c */
 void init_Threads(void);             /* thread.c */
 
 static iBool hasBeenInitialized_ = iFalse;
@@ -68,6 +70,9 @@ static void checkDeinit_Foundation_(void) {
 void init_Foundation(void) {
     init_Threads();
     init_Garbage();
+#if defined (iHaveRegExp)
+    init_RegExp_();
+#endif
     iDebug("[the_Foundation] version:" iFoundationLibraryVersionCStr " cstd:%li\n",
            __STDC_VERSION__);
     /* Locale. */ {
@@ -86,6 +91,9 @@ void deinit_Foundation(void) {
         deinit_DatagramThreads_();
         deinit_Address_();
         deinitForThread_Garbage_();
+#if defined (iHaveRegExp)
+        deinitForThread_RegExp_();
+#endif
         deinit_Threads_();
 #if defined (iPlatformWindows)
         deinit_Windows_();
@@ -144,5 +144,65 @@ int main(int argc, char *argv[]) {
             delete_String(s);
         }
     }
+    /* ASCII and UTF-8 checks across the 16- and 32-byte scanning blocks. */ {
+        static const size_t edges[] = { 8, 16, 32, 48, 64 };
+        char buf[80];
+        const iRangecc all = { buf, buf + sizeof(buf) };
+        int failures = 0;
+        memset(buf, 'a', sizeof(buf));
+        failures += !isAscii_Rangecc(all) + !isUtf8_Rangecc(all);
+        iForIndices(i, edges) {
+            const size_t edge = edges[i];
+            memcpy(buf + edge - 1, "\xc3\xa4", 2);     /* straddles the edge */
+            failures += isAscii_Rangecc(all) + !isUtf8_Rangecc(all);
+            buf[edge] = 'a';                            /* lead byte without continuation */
+            failures += isUtf8_Rangecc(all);
+            buf[edge - 1] = 'a';
+            buf[edge] = '\x80';                         /* stray continuation byte */
+            failures += isAscii_Rangecc(all) + isUtf8_Rangecc(all);
+            memcpy(buf + edge - 2, "\xe2\x82\xac", 3);  /* three-byte sequence over the edge */
+            failures += !isUtf8_Rangecc(all);
+            buf[edge] = 'a';                            /* truncated in the middle */
+            failures += isUtf8_Rangecc(all);
+            memset(buf, 'a', sizeof(buf));
+        }
+        /* Multibyte sequences truncated by the end of the range. */
+        memcpy(buf + sizeof(buf) - 4, "\xf0\x9f\x9a\x98", 4);
+        failures += !isUtf8_Rangecc(all);
+        for (size_t cut = 1; cut < 4; cut++) {
+            failures += isUtf8_Rangecc((iRangecc){ buf, buf + sizeof(buf) - cut });
+        }
+        printf("ASCII/UTF-8 block edges: %d failures\n", failures);
+        iAssert(failures == 0);
+    }
+    /* Splitting ranges that are not NULL-terminated. */ {
+        static const struct {
+            const char *text;
+            size_t      size;
+            const char *separator;
+            const char *segments[3];
+        } splits[] = {
+            { "a/b/c",              4,  "/",            { "a", "b" } },    /* separator at end */
+            { "one::two::three",    9,  "::",           { "one", "two:" } }, /* cut separator */
+            { "x\u2192y\u2192z",      8,  "\u2192",       { "x", "y" } },    /* multibyte */
+            { "x\u2192y\u2192z",      7,  "\u2192",       { "x", "y\xe2\x86" } },
+        };
+        int failures = 0;
+        iForIndices(i, splits) {
+            const iRangecc rng = { splits[i].text, splits[i].text + splits[i].size };
+            iRangecc seg = iNullRange;
+            size_t count = 0;
+            while (nextSplit_Rangecc(rng, splits[i].separator, &seg)) {
+                if (count >= iElemCount(splits[i].segments) || !splits[i].segments[count] ||
+                    !equal_Rangecc(seg, splits[i].segments[count])) {
+                    failures++;
+                }
+                count++;
+            }
+            failures += (count != 2);
+        }
+        printf("Bounded splitting: %d failures\n", failures);
+        iAssert(failures == 0);
+    }
     deinit_Foundation();
 }
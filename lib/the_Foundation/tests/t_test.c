@@ -152,6 +152,20 @@ static iThreadResult run_WorkerThread(iThread *d) {
     return 12345;
 }
 
+#if defined (iHaveRegExp)
+static iBool printMatch_(void *context, const iRegExpMatch *match) {
+    iUnused(context);
+    printf("matchAll: %i -> %i [%s]\n", match->range.start, match->range.end,
+           cstr_Rangecc(capturedRange_RegExpMatch(match, 0)));
+    return iTrue;
+}
+
+static iBool stopAtFirstMatch_(void *context, const iRegExpMatch *match) {
+    iUnused(context, match);
+    return iFalse;
+}
+#endif
+
 int main(int argc, char *argv[]) {
     init_Foundation();
     /* Test command line options parsing. */ {
@@ -513,6 +527,33 @@ int main(int argc, char *argv[]) {
         iRelease(rx);
         delete_String(s);
     }
+    /* Test iterating over all matches. */ {
+        size_t count;
+        iString *s = newCStr_String("Hello world Äöäö, there is a \U0001f698 out there.");
+        iRegExp *rx = new_RegExp("\\b(THERE|WORLD|äöäö)\\b", caseInsensitive_RegExpOption);
+        count = matchAllString_RegExp(rx, s, printMatch_, NULL);
+        printf("matchAll count: %zu\n", count);
+        iAssert(count == 4);
+        count = matchAllString_RegExp(rx, s, stopAtFirstMatch_, NULL);
+        printf("matchAll count: %zu\n", count);
+        iAssert(count == 1);
+        iRelease(rx);
+        /* Empty matches step forward one character at a time. */
+        rx = new_RegExp("x*", 0);
+        count = matchAllRange_RegExp(rx, range_CStr("axxb"), printMatch_, NULL);
+        printf("matchAll count: %zu\n", count);
+        iAssert(count == 4);
+        iRelease(rx);
+        rx = new_RegExp("", 0);
+        count = matchAllRange_RegExp(rx, range_CStr("aä\U0001f698"), printMatch_, NULL);
+        printf("matchAll count: %zu\n", count);
+        iAssert(count == 4);
+        count = matchAllRange_RegExp(rx, range_CStr(""), NULL, NULL);
+        printf("matchAll count: %zu\n", count);
+        iAssert(count == 1);
+        iRelease(rx);
+        delete_String(s);
+    }
 #endif
 #if defined (iHaveZlib)
     /* Test zlib compression. */ {
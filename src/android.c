@@ -108,7 +108,7 @@ void setupApplication_Android(void) {
 #endif
     /* Cache the monospace font into a file where it can be loaded directly by the Java code. */
     const char *path = monospaceFontPath_();
-    const iBlock *iosevka = dataCStr_Archive(archive_Resources(), "fonts/IosevkaTerm-Extended.ttf");
+    const iBlock *iosevka = dataCStr_Archive(lockArchive_Resources(), "fonts/IosevkaTerm-Extended.ttf");
     if (!fileExistsCStr_FileInfo(path) || fileSizeCStr_FileInfo(path) != size_Block(iosevka)) {
         iFile *f = newCStr_File(path);
         if (open_File(f, writeOnly_FileMode)) {
@@ -116,6 +116,7 @@ void setupApplication_Android(void) {
         }
         iRelease(f);
     }
+    unlockArchive_Resources();
     /* Tell the Java code where we expect cached file contents to be stored. */
     const iString *cachePath = collectNewCStr_String(cachePath_());
     if (!fileExists_FileInfo(cachePath)) {
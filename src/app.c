@@ -25,17 +25,22 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "defs.h"
 #include "export.h"
 #include "feeds.h"
+#include "fontpack.h"
 #include "gmcerts.h"
 #include "gmdocument.h"
 #include "gmutil.h"
 #include "history.h"
+#include "imagecache.h"
 #include "ipc.h"
+#include "media.h"
 #include "mimehooks.h"
 #include "misfin.h"
 #include "periodic.h"
 #include "resources.h"
+#include "responsecache.h"
 #include "sitespec.h"
 #include "snippets.h"
+#include "trace.h"
 #include "ui/certimportwidget.h"
 #include "ui/color.h"
 #include "ui/command.h"
@@ -45,9 +50,11 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "ui/labelwidget.h"
 #include "ui/listwidget.h"
 #include "ui/lookupwidget.h"
+#include "ui/profiler.h"
 #include "ui/root.h"
 #include "ui/sidebarwidget.h"
 #include "ui/text.h"
+#include "ui/texturepool.h"
 #include "ui/touch.h"
 #include "ui/uploadwidget.h"
 #include "ui/util.h"
@@ -382,6 +389,7 @@ static iString *serializePrefs_App_(const iApp *d) {
         { "prefs.mono.gemini", &d->prefs.monospaceGemini },
         { "prefs.mono.gopher", &d->prefs.monospaceGopher },
         { "prefs.plaintext.wrap", &d->prefs.plainTextWrap },
+        { "prefs.prefetch", &d->prefs.prefetchLinks },
         { "prefs.quote.italic", &d->prefs.italicQuote },
         { "prefs.redirect.allowscheme", &d->prefs.allowSchemeChangingRedirect },
         { "prefs.retaintabs", &d->prefs.retainTabs },
@@ -562,16 +570,17 @@ void updateCACertificates_App(void) {
     iApp *d = &app_;
     if (isEmpty_String(&d->prefs.strings[caFile_PrefsString]) &&
         isEmpty_String(&d->prefs.strings[caPath_PrefsString]) &&
-        !isEmpty_Block(&blobCacertPem_Resources)) {
+        size_Resources(&blobCacertPem_Resources) > 0) {
         /* Use the bundled CA root cert store. */
         iFile *f = new_File(collect_String(concatCStr_Path(dataDir_App(), "cacert.pem")));
         iBool load = iFalse;
         if (fileExists_FileInfo(path_File(f)) &&
-            fileSize_FileInfo(path_File(f)) == size_Block(&blobCacertPem_Resources)) {
+            fileSize_FileInfo(path_File(f)) == size_Resources(&blobCacertPem_Resources)) {
             load = iTrue;
         }
         else if (open_File(f, writeOnly_FileMode)) {
-            write_File(f, &blobCacertPem_Resources);
+            write_File(f, load_Resources(&blobCacertPem_Resources));
+            release_Resources(&blobCacertPem_Resources); /* only needed in the file */
             close_File(f);
             load = iTrue;
         }
@@ -1315,6 +1324,9 @@ static void init_App_(iApp *d, int argc, char **argv) {
         defineValues_CommandLine(&d->args, replaceTab_CommandLineOption, 1);
         defineValues_CommandLine(&d->args, "sw", 0);
         defineValues_CommandLine(&d->args, "tab-url", 0);
+#if defined (LAGRANGE_ENABLE_TRACE)
+        defineValues_CommandLine(&d->args, trace_CommandLineOption, 1);
+#endif
         defineValues_CommandLine(&d->args, uiTheme_CommandLineOption, 1);
         defineValues_CommandLine(&d->args, userDataDir_CommandLineOption, 1);
         defineValues_CommandLine(&d->args, "version;V", 0);
@@ -1324,7 +1336,7 @@ static void init_App_(iApp *d, int argc, char **argv) {
     doDump = checkArgument_CommandLine(&d->args, dump_CommandLineOption);
     /* Handle command line options. */ {
         if (contains_CommandLine(&d->args, "help")) {
-            puts(cstr_Block(&blobArghelp_Resources));
+            puts(cstr_Block(load_Resources(&blobArghelp_Resources)));
             terminate_App_(0);
         }
         if (contains_CommandLine(&d->args, "version;V")) {
@@ -1374,6 +1386,13 @@ static void init_App_(iApp *d, int argc, char **argv) {
         }
     }
 #endif
+#if defined (LAGRANGE_ENABLE_TRACE)
+    /* Performance tracing. */ {
+        const iCommandLineArg *arg =
+            iClob(checkArgumentValues_CommandLine(&d->args, trace_CommandLineOption, 1));
+        init_Trace(arg ? cstr_String(value_CommandLineArg(arg, 0)) : NULL);
+    }
+#endif
 #if defined (LAGRANGE_ENABLE_IPC)
     /* Only one instance is allowed to run at a time; the runtime files (bookmarks, etc.)
        are not shareable. */
@@ -1531,6 +1550,8 @@ static void init_App_(iApp *d, int argc, char **argv) {
         postCommand_App("~bookmarks.changed");
     }
     init_Feeds(dataDir_App_());
+    init_ResponseCache();
+    init_ImageCache();
     /* Widget state init. */
     processEvents_App(postedEventsOnly_AppEventMode);
     if (!loadState_App_(d)) {
@@ -1639,6 +1660,8 @@ static void deinit_App(iApp *d) {
     iAssert(isEmpty_PtrArray(&d->mainWindows));
     deinit_PtrArray(&d->mainWindows);
     d->window = NULL;
+    deinit_ImageCache();
+    deinit_ResponseCache();
     deinit_Feeds();
     save_Keys(dataDir_App_());
     deinit_Keys();
@@ -1676,6 +1699,7 @@ static void deinit_App(iApp *d) {
     iRelease(d->recentlyClosedTabUrls);
     iRelease(d->tempFilesPendingDeletion);
     d->tempFilesPendingDeletion = NULL;
+    deinit_Trace();
 }
 
 const iString *execPath_App(void) {
@@ -1810,6 +1834,13 @@ const iString *debugInfo_App(void) {
         }
         appendFormat_String(msg, "Total cache: %.3f MB\n", total.cacheSize / 1.0e6f);
         appendFormat_String(msg, "Total memory: %.3f MB\n", total.memorySize / 1.0e6f);
+        appendFormat_String(msg, "=> about:memory Memory usage by subsystem\n");
+    }
+    appendFormat_String(msg, "\n## Fonts\n"); {
+        size_t hits, probesSaved;
+        fallbackCacheStats_Text(text_Window(get_Window()), &hits, &probesSaved);
+        appendFormat_String(msg, "Fallback cache: %zu hits, %zu glyph lookups saved\n",
+                            hits, probesSaved);
     }
     appendFormat_String(msg, "\n## Documents\n");
     iForEach(ObjectList, k, docs) {
@@ -1818,6 +1849,9 @@ const iString *debugInfo_App(void) {
                             constAs_Widget(doc)->root == get_Window()->roots[0] ? 1 : 2,
                             indexOfChild_Widget(constAs_Widget(doc)->parent, k.object) + 1,
                             cstr_String(bookmarkTitle_DocumentWidget(doc)));
+        appendFormat_String(msg, "Page memory: %.3f MB%s\n",
+                            memorySize_DocumentWidget(doc) / 1.0e6f,
+                            isHibernating_DocumentWidget(doc) ? " (hibernating)" : "");
         append_String(msg, collect_String(debugInfo_History(history_DocumentWidget(doc))));
     }
     appendCStr_String(msg, "## Environment\n```\n");
@@ -1838,6 +1872,123 @@ const iString *debugInfo_App(void) {
     return msg;
 }
 
+iDeclareType(MemoryUsage)
+
+struct Impl_MemoryUsage {
+    size_t pages;         /* open documents, including their media */
+    size_t pageTextures;  /* decoded images of open documents (part of `pages`) */
+    size_t viewBuffers;   /* document view textures */
+    size_t history;       /* cached responses and documents of tab histories */
+    size_t responseCache;
+    size_t drawBuffers;   /* widget draw buffer textures */
+    size_t glyphCaches;   /* glyph atlas textures */
+    size_t texturePool;   /* released render targets kept for reuse */
+    size_t imageCache;    /* decoded images no longer used by any page */
+    size_t fonts;         /* loaded font files */
+    size_t bookmarks;
+    size_t feeds;
+    size_t visited;
+};
+
+static size_t historyMemorySize_App_(iDocumentWidget *doc) {
+    /* The current page is normally also cached in the history, but it is accounted for
+       as part of the page. */
+    iHistory *hist = history_DocumentWidget(doc);
+    size_t    size = memorySize_History(hist);
+    lock_History(hist);
+    const iRecentUrl *current = constMostRecentUrl_History(hist);
+    if (current && current->cachedDoc && current->cachedDoc == document_DocumentWidget(doc)) {
+        size -= iMin(size, memorySize_GmDocument(current->cachedDoc));
+    }
+    unlock_History(hist);
+    return size;
+}
+
+static iMemoryUsage memoryUsage_App_(iApp *d, iObjectList *docs) {
+    iMemoryUsage mem;
+    iZap(mem);
+    iForEach(ObjectList, i, docs) {
+        iDocumentWidget *doc = i.object;
+        mem.pages        += memorySize_DocumentWidget(doc);
+        mem.pageTextures += textureMemorySize_Media(constMedia_GmDocument(document_DocumentWidget(doc)));
+        mem.viewBuffers  += textureMemorySize_DocumentWidget(doc);
+        mem.history      += historyMemorySize_App_(doc);
+    }
+    iPtrArray *winList = listWindows_App();
+    iConstForEach(PtrArray, w, winList) {
+        const iWindow *win = w.ptr;
+        mem.glyphCaches += glyphCacheSize_Text(text_Window(win));
+        iForIndices(r, win->roots) {
+            if (win->roots[r]) {
+                mem.drawBuffers += drawBufferSize_Widget(win->roots[r]->widget);
+            }
+        }
+    }
+    delete_PtrArray(winList);
+    mem.texturePool   = idleMemorySize_TexturePool();
+    mem.imageCache    = memorySize_ImageCache();
+    mem.responseCache = memorySize_ResponseCache();
+    mem.fonts         = memorySize_Fonts();
+    mem.bookmarks     = memorySize_Bookmarks(d->bookmarks);
+    mem.feeds         = memorySize_Feeds();
+    mem.visited       = memorySize_Visited(d->visited);
+    return mem;
+}
+
+const iString *memoryInfo_App(void) {
+    iApp *d = &app_;
+    iString *msg = collectNew_String();
+    iObjectList *docs = iClob(listAllDocuments_App());
+    const iMemoryUsage mem = memoryUsage_App_(d, docs);
+    const struct { const char *label; size_t size; iBool isPart; } rows[] = {
+        { "Open pages",               mem.pages,         iFalse },
+        { "  of which textures",      mem.pageTextures,  iTrue  },
+        { "Page view buffers (GPU)",  mem.viewBuffers,   iFalse },
+        { "Tab histories",            mem.history,       iFalse },
+        { "Shared response cache",    mem.responseCache, iFalse },
+        { "Shared image cache (GPU)", mem.imageCache,    iFalse },
+        { "Widget buffers (GPU)",     mem.drawBuffers,   iFalse },
+        { "Glyph caches (GPU)",       mem.glyphCaches,   iFalse },
+        { "Idle texture pool (GPU)",  mem.texturePool,   iFalse },
+        { "Font files",               mem.fonts,         iFalse },
+        { "Bookmarks",                mem.bookmarks,     iFalse },
+        { "Feed entries",             mem.feeds,         iFalse },
+        { "Visited URLs",             mem.visited,       iFalse },
+    };
+    size_t total = 0;
+    format_String(msg, "# Memory usage\n");
+    appendCStr_String(msg, "These are estimates of the memory held by each part of the app. "
+                           "GPU textures may be stored in video memory.\n");
+    appendCStr_String(msg, "\n## Subsystems\n```\n");
+    iForIndices(i, rows) {
+        appendFormat_String(msg, "%-24s %9.3f MB\n", rows[i].label, rows[i].size / 1.0e6);
+        if (!rows[i].isPart) {
+            total += rows[i].size;
+        }
+    }
+    appendFormat_String(msg, "%-24s %9.3f MB\n", "Total", total / 1.0e6);
+    appendCStr_String(msg, "```\n");
+    appendFormat_String(msg, "Pages cached in tab histories may use up to %d MB before the "
+                             "least important ones are released.\n", d->prefs.maxMemorySize);
+    appendCStr_String(msg, "\n## Tabs\n```\n");
+    appendFormat_String(msg, "%9s %9s %9s %9s  %s\n", "Page", "Textures", "Buffers", "History",
+                        "Title");
+    iForEach(ObjectList, k, docs) {
+        iDocumentWidget *doc = k.object;
+        appendFormat_String(
+            msg,
+            "%9.3f %9.3f %9.3f %9.3f  %s%s\n",
+            memorySize_DocumentWidget(doc) / 1.0e6,
+            textureMemorySize_Media(constMedia_GmDocument(document_DocumentWidget(doc))) / 1.0e6,
+            textureMemorySize_DocumentWidget(doc) / 1.0e6,
+            historyMemorySize_App_(doc) / 1.0e6,
+            cstr_String(bookmarkTitle_DocumentWidget(doc)),
+            isHibernating_DocumentWidget(doc) ? " (hibernating)" : "");
+    }
+    appendCStr_String(msg, "```\n");
+    return msg;
+}
+
 static void clearCache_App_(void) {
     iForEach(ObjectList, i, iClob(listDocuments_App(NULL))) {
         clearCache_History(history_DocumentWidget(i.object));
@@ -1893,8 +2044,9 @@ void trimMemory_App(void) {
     size_t memorySize = 0;
     const size_t limit = d->prefs.maxMemorySize * 1000000;
     iObjectList *docs = listAllDocuments_App();
+    /* Only the cached history pages can be released, so the rest does not count. */
     iForEach(ObjectList, i, docs) {
-        memorySize += memorySize_History(history_DocumentWidget(i.object));
+        memorySize += prunableMemorySize_History(history_DocumentWidget(i.object));
     }
     init_ObjectListIterator(&i, docs);
     iBool wasPruned = iFalse;
@@ -2053,6 +2205,7 @@ static iBool nextEvent_App_(iApp *d, enum iAppEventMode eventMode, SDL_Event *ev
 }
 
 void processEvents_App(enum iAppEventMode eventMode) {
+    iTrace("processEvents_App");
     iApp *d = &app_;
     iRoot *oldCurrentRoot = current_Root(); /* restored afterwards */
     SDL_Event ev;
@@ -2116,6 +2269,8 @@ void processEvents_App(enum iAppEventMode eventMode) {
             }
             case SDL_APP_LOWMEMORY:
                 clearCache_App_();
+                clear_TexturePool();
+                clear_ImageCache();
                 break;
             case SDL_APP_WILLENTERFOREGROUND:
                 invalidate_Window(as_Window(d->window));
@@ -2530,6 +2685,7 @@ static void runTickers_App_(iApp *d) {
     /* Tickers may add themselves again, so we'll run off a copy. */
     iSortedArray *pending = copy_SortedArray(&d->tickers);
     clear_SortedArray(&d->tickers);
+    iCountFrameN(tickers, (int) size_SortedArray(pending));
     iConstForEach(Array, i, &pending->values) {
         const iTicker *ticker = i.value;
         if (ticker->callback) {
@@ -2787,12 +2943,26 @@ int run_App(int argc, char **argv) {
     return rc;
 }
 
-void postRefresh_Window(iAnyWindow *windowPtr) {
+#if defined (LAGRANGE_ENABLE_BENCHMARK)
+void initHeadless_App(int argc, char **argv) {
+    iApp *d = &app_;
+    init_App_(d, argc, argv);
+    /* An offscreen window never gets an expose event, but glyphs can only be cached
+       in an exposed window. */
+    d->window->isExposed = iTrue;
+    processEvents_App(postedEventsOnly_AppEventMode);
+}
+
+void deinitHeadless_App(void) {
+    deinit_App(&app_);
+}
+#endif
+
+static void postRefreshEvent_App_(iWindow *window) {
     iApp *d = &app_;
 #if defined (LAGRANGE_ENABLE_IDLE_SLEEP)
     d->isIdling = iFalse;
 #endif
-    iWindow *window = windowPtr;
     iAtomicInt *pendingWindow = (window ? &window->isRefreshPending : NULL);
     iBool wasPending = exchange_Atomic(&d->pendingRefresh, iTrue);
     if (pendingWindow) {
@@ -2805,6 +2975,20 @@ void postRefresh_Window(iAnyWindow *windowPtr) {
     }
 }
 
+void postRefresh_Window(iAnyWindow *windowPtr) {
+    setFullDamage_Window(windowPtr);
+    postRefreshEvent_App_(windowPtr);
+}
+
+void postDamage_Window(iAnyWindow *windowPtr, iRect rect) {
+    /* Must be called in the main thread. */
+    iWindow *window = windowPtr;
+    if (window && !isEmpty_Rect(rect)) {
+        window->damage = union_Rect(window->damage, rect);
+        postRefreshEvent_App_(window);
+    }
+}
+
 void postRefreshAllWindows_App(void) {
     iApp *d = &app_;
     iConstForEach(PtrArray, m, &d->mainWindows) {
@@ -3023,6 +3207,10 @@ void removeTicker_App(iTickerFunc ticker, iAny *context) {
     remove_SortedArray(&d->tickers, &(iTicker){ context, NULL, ticker });
 }
 
+size_t numTickers_App(void) {
+    return size_SortedArray(&app_.tickers);
+}
+
 void addWindow_App(iMainWindow *win) {
     iApp *d = &app_;
     pushBack_PtrArray(&d->mainWindows, win);
@@ -4115,6 +4303,11 @@ static iBool handleNonWindowRelatedCommand_App_(iApp *d, const char *cmd) {
         postRefreshAllWindows_App();
         return iTrue;
     }
+    else if (equal_Command(cmd, "debug.profiler")) {
+        setEnabled_Profiler(!isEnabled_Profiler());
+        postRefreshAllWindows_App();
+        return iTrue;
+    }
     else if (equal_Command(cmd, "prefs.dataurl.openimages.changed")) {
         d->prefs.openDataUrlImagesOnLoad = arg_Command(cmd) != 0;
         return iTrue;
@@ -4147,6 +4340,17 @@ static iBool handleNonWindowRelatedCommand_App_(iApp *d, const char *cmd) {
         d->prefs.allowSchemeChangingRedirect = arg_Command(cmd) != 0;
         return iTrue;
     }
+    else if (equal_Command(cmd, "prefs.prefetch.changed")) {
+        d->prefs.prefetchLinks = arg_Command(cmd) != 0;
+        if (!d->prefs.prefetchLinks) {
+            cancelPrefetch_ResponseCache();
+        }
+        return iTrue;
+    }
+    else if (equal_Command(cmd, "responsecache.prefetched")) {
+        prefetchFinished_ResponseCache(argU32Label_Command(cmd, "reqid"));
+        return iTrue;
+    }
     else if (equal_Command(cmd, "smoothscroll")) {
         d->prefs.smoothScrolling = arg_Command(cmd);
         return iTrue;
@@ -5149,6 +5353,7 @@ iBool handleCommand_App(const char *cmd) {
         setToggle_Widget(findChild_Widget(dlg, "prefs.swipe.page"), d->prefs.pageSwipe);
         setToggle_Widget(findChild_Widget(dlg, "prefs.gopher.gemstyle"), d->prefs.geminiStyledGopher);
         setToggle_Widget(findChild_Widget(dlg, "prefs.redirect.allowscheme"), d->prefs.allowSchemeChangingRedirect);
+        setToggle_Widget(findChild_Widget(dlg, "prefs.prefetch"), d->prefs.prefetchLinks);
         updatePrefsPinSplitButtons_(dlg, d->prefs.pinSplit);
         updateScrollSpeedButtons_(dlg, mouse_ScrollType, d->prefs.smoothScrollSpeed[mouse_ScrollType]);
         updateScrollSpeedButtons_(dlg, keyboard_ScrollType, d->prefs.smoothScrollSpeed[keyboard_ScrollType]);
@@ -54,6 +54,7 @@ typedef void iAnyWindow;
 #define windowWidth_CommandLineOption       "width;w"
 #define windowHeight_CommandLineOption      "height;h"
 #define uiTheme_CommandLineOption           "theme;t"
+#define trace_CommandLineOption             "trace"
 
 enum iAppDeviceType {
     desktop_AppDeviceType,
@@ -86,6 +87,10 @@ enum iNewTabFlag {
 };
 
 int                 run_App                     (int argc, char **argv);
+#if defined (LAGRANGE_ENABLE_BENCHMARK)
+void                initHeadless_App            (int argc, char **argv); /* no event loop */
+void                deinitHeadless_App          (void);
+#endif
 void                processEvents_App           (enum iAppEventMode mode);
 iBool               handleCommand_App           (const char *cmd);
 void                refresh_App                 (void);
@@ -122,6 +127,7 @@ const iString *     dataDir_App                 (void);
 const iString *     fontsDir_App                (void);
 const iString *     downloadDir_App             (void);
 const iString *     debugInfo_App               (void);
+const iString *     memoryInfo_App              (void);
 const iCommandLine *commandLine_App             (void);
 iGmCerts *          certs_App                   (void);
 iVisited *          visited_App                 (void);
@@ -152,6 +158,7 @@ typedef void (*iTickerFunc)(iAny *);
 void        addTicker_App           (iTickerFunc ticker, iAny *context);
 void        addTickerRoot_App       (iTickerFunc ticker, iRoot *root, iAny *context);
 void        removeTicker_App        (iTickerFunc ticker, iAny *context);
+size_t      numTickers_App          (void);
 
 void        addWindow_App           (iMainWindow *win);
 void        removeWindow_App        (iMainWindow *win);
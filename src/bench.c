@@ -0,0 +1,1007 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+/* lagrange-bench: measures document layout and text shaping performance without a visible
+   window. The app is initialized normally, but with an offscreen software renderer and a
+   separate user data directory, so the results do not depend on the user's setup.
+
+   With `--micro`, a set of small, focused benchmarks is run instead. Each result is divided
+   by the time of a fixed reference workload, and these relative costs can be compared against
+   stored baselines so that CTest fails when something gets slower than allowed. */
+
+#include "app.h"
+#include "bookmarks.h"
+#include "fontpack.h"
+#include "gmdocument.h"
+#include "gmutil.h"
+#include "gopher.h"
+#include "visited.h"
+#include "ui/inputwidget.h"
+#include "ui/root.h"
+#include "ui/text.h"
+
+#include <the_Foundation/archive.h>
+#include <the_Foundation/buffer.h>
+#include <the_Foundation/commandline.h>
+#include <the_Foundation/file.h>
+#include <the_Foundation/fileinfo.h>
+#include <the_Foundation/garbage.h>
+#include <the_Foundation/path.h>
+#include <the_Foundation/regexp.h>
+#include <the_Foundation/stringlist.h>
+#include <SDL.h>
+#include <stdio.h>
+
+enum iBenchPhase {
+    convert_BenchPhase,  /* Gopher menu to Gemtext */
+    source_BenchPhase,   /* import and initial layout */
+    relayout_BenchPhase, /* layout at a different width */
+    render_BenchPhase,   /* finding the visible runs, one viewport at a time */
+    shape_BenchPhase,    /* measuring each line of the source */
+    max_BenchPhase
+};
+
+/* Same as SKIP_RETURN_CODE of the perf tests. */
+enum { skipped_BenchExitCode = 77 };
+
+static const char *phaseNames_[max_BenchPhase] = { "convert", "source", "relayout", "render", "shape" };
+
+iDeclareType(BenchTiming)
+
+struct Impl_BenchTiming {
+    double min; /* seconds */
+    double total;
+    int    count;
+};
+
+iDeclareType(BenchCorpus)
+
+struct Impl_BenchCorpus {
+    iString            name;
+    iString            url;
+    enum iSourceFormat format;
+    iBool              isGopher;
+    iString            source;
+};
+
+static double now_Bench_(void) {
+    return (double) SDL_GetPerformanceCounter() / (double) SDL_GetPerformanceFrequency();
+}
+
+static void record_BenchTiming_(iBenchTiming *d, double startTime) {
+    const double elapsed = now_Bench_() - startTime;
+    d->min = (d->count == 0 ? elapsed : iMin(d->min, elapsed));
+    d->total += elapsed;
+    d->count++;
+}
+
+/*----------------------------------------------------------------------------------------------*/
+
+static const char *prose_[] = {
+    "The quick brown fox jumps over the lazy dog, while the dog keeps on sleeping.",
+    "Typography is the craft of endowing human language with a durable visual form.",
+    "Geminispace is a quiet corner of the Internet where documents are just text and links.",
+    "Long paragraphs have to be wrapped onto many lines, which is what layout is all about.",
+    "Numbers like 3.14159, 2718 and 1,000,000 mix with words and punctuation (like this).",
+};
+
+static const char *cjk_[] = {
+    "日本語の文章は単語の間に空白がないので、どこでも改行できることが多いです。",
+    "中文排版需要处理全角标点符号，例如逗号、句号和引号。",
+    "한국어는 띄어쓰기를 사용하지만 글자는 음절 단위로 모아 씁니다.",
+    "東京、大阪、京都、そして北海道の雪景色はとても美しい。",
+};
+
+static const char *rtl_[] = {
+    "هذه فقرة باللغة العربية تحتوي على بعض الأرقام مثل 123 و 456 وكلمات English مختلطة.",
+    "זוהי פסקה בעברית עם מספרים כמו 2024 ומילים באנגלית באמצע.",
+    "الكتابة من اليمين إلى اليسار تتطلب إعادة ترتيب النص عند العرض.",
+};
+
+static void appendParagraph_(iString *out, const char **samples, size_t numSamples, int seed,
+                             int numSentences) {
+    for (int i = 0; i < numSentences; i++) {
+        if (i) {
+            appendCStr_String(out, " ");
+        }
+        appendCStr_String(out, samples[(size_t) (seed * 7 + i * 3) % numSamples]);
+    }
+    appendCStr_String(out, "\n");
+}
+
+static void makeGemtext_(iString *out, size_t size, const char **samples, size_t numSamples) {
+    for (int n = 1; size_String(out) < size; n++) {
+        appendFormat_String(out, "## Section %d\n\n", n);
+        appendParagraph_(out, samples, numSamples, n, 6);
+        appendCStr_String(out, "\n");
+        appendParagraph_(out, samples, numSamples, n + 1, 3);
+        appendFormat_String(out,
+                            "\n* First item of list %d\n"
+                            "* The second item is a bit longer than the first one\n"
+                            "* Third\n\n",
+                            n);
+        appendFormat_String(out,
+                            "=> gemini://example.com/page/%d.gmi Page %d\n"
+                            "=> https://example.org/%d An external link\n\n",
+                            n, n, n);
+        appendCStr_String(out, "> ");
+        appendParagraph_(out, samples, numSamples, n + 2, 2);
+        appendFormat_String(out,
+                            "\n```C source\n"
+                            "int main(void) {\n"
+                            "    return %d;\n"
+                            "}\n"
+                            "```\n\n",
+                            n);
+    }
+}
+
+static void makeMarkdown_(iString *out, size_t size) {
+    for (int n = 1; size_String(out) < size; n++) {
+        appendFormat_String(out,
+                            "## Section %d\n\n"
+                            "Some **bold text**, *emphasis* and `inline code`, followed by "
+                            "[a link](gemini://example.com/%d.gmi) in the middle of a sentence. ",
+                            n, n);
+        appendParagraph_(out, prose_, iElemCount(prose_), n, 4);
+        appendFormat_String(out,
+                            "\n- List item %d\n"
+                            "- Another item with [a link](https://example.org/%d)\n\n"
+                            "```\n"
+                            "code block %d\n"
+                            "```\n\n",
+                            n, n, n);
+    }
+}
+
+static void makeGopherMenu_(iString *out, size_t size) {
+    for (int n = 1; size_String(out) < size; n++) {
+        appendFormat_String(out,
+                            "iWelcome to section %d of this Gopher hole\tfake\t(NULL)\t0\r\n"
+                            "1Directory number %d\t/dir/%d\texample.com\t70\r\n"
+                            "0A text file about topic %d\t/text/%d.txt\texample.com\t70\r\n"
+                            "hWeb link %d\tURL:https://example.org/%d\texample.com\t70\r\n"
+                            "i\tfake\t(NULL)\t0\r\n",
+                            n, n, n, n, n, n, n);
+    }
+    appendCStr_String(out, ".\r\n");
+}
+
+static void makeAnsiText_(iString *out, size_t size) {
+    for (int n = 1; size_String(out) < size; n++) {
+        appendFormat_String(out,
+                            "\x1b[1;3%dmLine %d\x1b[0m: plain text with \x1b[4munderlined\x1b[0m "
+                            "and \x1b[38;5;%dmindexed color\x1b[0m words, ",
+                            n % 8, n, n % 256);
+        appendParagraph_(out, prose_, iElemCount(prose_), n, 1);
+    }
+}
+
+static void makePlainText_(iString *out, size_t size) {
+    for (int n = 1; size_String(out) < size; n++) {
+        appendFormat_String(out,
+                            "%5d | +--------+--------+ | %-40s |\n"
+                            "      | | %6d | %6x | | key=value; path=/usr/lib/%d\n",
+                            n, prose_[n % iElemCount(prose_)] + 4, n * 13, n * 31, n);
+        appendParagraph_(out, prose_, iElemCount(prose_), n, 1);
+    }
+}
+
+static iBenchCorpus *newCorpus_(const char *name, const char *url, enum iSourceFormat format) {
+    iBenchCorpus *d = iMalloc(BenchCorpus);
+    initCStr_String(&d->name, name);
+    initCStr_String(&d->url, url);
+    d->format   = format;
+    d->isGopher = startsWith_CStr(url, "gopher:");
+    init_String(&d->source);
+    return d;
+}
+
+static void delete_BenchCorpus_(iBenchCorpus *d) {
+    deinit_String(&d->name);
+    deinit_String(&d->url);
+    deinit_String(&d->source);
+    free(d);
+}
+
+static void makeBuiltinCorpora_(iPtrArray *corpora) {
+    iBenchCorpus *c;
+    c = newCorpus_("gemtext", "gemini://example.com/huge.gmi", gemini_SourceFormat);
+    makeGemtext_(&c->source, 2000000, prose_, iElemCount(prose_));
+    pushBack_PtrArray(corpora, c);
+    c = newCorpus_("markdown", "gemini://example.com/doc.md", markdown_SourceFormat);
+    makeMarkdown_(&c->source, 300000);
+    pushBack_PtrArray(corpora, c);
+    c = newCorpus_("gopher", "gopher://example.com/1/", gemini_SourceFormat);
+    makeGopherMenu_(&c->source, 300000);
+    pushBack_PtrArray(corpora, c);
+    c = newCorpus_("ansi", "gemini://example.com/log.txt", plainText_SourceFormat);
+    makeAnsiText_(&c->source, 300000);
+    pushBack_PtrArray(corpora, c);
+    c = newCorpus_("plaintext", "gemini://example.com/big.txt", plainText_SourceFormat);
+    makePlainText_(&c->source, 2000000);
+    pushBack_PtrArray(corpora, c);
+    c = newCorpus_("cjk", "gemini://example.com/cjk.gmi", gemini_SourceFormat);
+    makeGemtext_(&c->source, 300000, cjk_, iElemCount(cjk_));
+    pushBack_PtrArray(corpora, c);
+    c = newCorpus_("rtl", "gemini://example.com/rtl.gmi", gemini_SourceFormat);
+    makeGemtext_(&c->source, 300000, rtl_, iElemCount(rtl_));
+    pushBack_PtrArray(corpora, c);
+}
+
+static iBenchCorpus *loadCorpus_(const iString *path) {
+    const iRangecc base = baseName_Path(path);
+    const char *url = "gemini://example.com/file.gmi";
+    enum iSourceFormat format = gemini_SourceFormat;
+    if (endsWithCase_Rangecc(base, ".md") || endsWithCase_Rangecc(base, ".markdown")) {
+        url    = "gemini://example.com/file.md";
+        format = markdown_SourceFormat;
+    }
+    else if (endsWithCase_Rangecc(base, ".txt")) {
+        url    = "gemini://example.com/file.txt";
+        format = plainText_SourceFormat;
+    }
+    else if (endsWithCase_Rangecc(base, ".gph") || equal_Rangecc(base, "gophermap")) {
+        url = "gopher://example.com/1/";
+    }
+    iFile *f = new_File(path);
+    if (!open_File(f, readOnly_FileMode)) {
+        fprintf(stderr, "failed to open: %s\n", cstr_String(path));
+        iRelease(f);
+        return NULL;
+    }
+    iBenchCorpus *d = newCorpus_(cstr_Rangecc(base), url, format);
+    iBlock *data = readAll_File(f);
+    setBlock_String(&d->source, data);
+    delete_Block(data);
+    iRelease(f);
+    return d;
+}
+
+/*----------------------------------------------------------------------------------------------*/
+
+static void shapeLines_(const iString *source, enum iFontId fontId, int width) {
+    iRangecc line = iNullRange;
+    while (nextSplit_Rangecc(range_String(source), "\n", &line)) {
+        if (!isEmpty_Range(&line)) {
+            measureWrapRange_Text(fontId, width, line);
+        }
+    }
+}
+
+static void countRun_(void *context, const iGmRun *run) {
+    iUnused(run);
+    (*(size_t *) context)++;
+}
+
+static size_t renderViewports_(const iGmDocument *doc, int height) {
+    /* Scroll through the document in half-viewport steps, like the visible-run scan does. */
+    size_t count = 0;
+    for (int y = 0; y < size_GmDocument(doc).y; y += height / 2) {
+        render_GmDocument(doc, (iRangei){ y, y + height }, countRun_, &count);
+    }
+    return count;
+}
+
+static void run_BenchCorpus_(const iBenchCorpus *d, int iterations, int width) {
+    iBenchTiming timings[max_BenchPhase];
+    iZap(timings);
+    for (int iter = 0; iter < iterations; iter++) {
+        iString *source = copy_String(&d->source);
+        double   startTime;
+        if (d->isGopher) {
+            iGopher gopher;
+            init_Gopher(&gopher);
+            gopher.type   = '1';
+            gopher.output = new_Block(0);
+            startTime = now_Bench_();
+            processResponse_Gopher(&gopher, &d->source.chars);
+            record_BenchTiming_(&timings[convert_BenchPhase], startTime);
+            setBlock_String(source, gopher.output);
+            delete_Block(gopher.output);
+            deinit_Gopher(&gopher);
+        }
+        iGmDocument *doc = new_GmDocument();
+        setUrl_GmDocument(doc, &d->url);
+        setFormat_GmDocument(doc, d->format);
+        startTime = now_Bench_();
+        setSource_GmDocument(doc, source, width, width, final_GmDocumentUpdate);
+        record_BenchTiming_(&timings[source_BenchPhase], startTime);
+        startTime = now_Bench_();
+        setWidth_GmDocument(doc, width * 2 / 3, width);
+        record_BenchTiming_(&timings[relayout_BenchPhase], startTime);
+        startTime = now_Bench_();
+        renderViewports_(doc, width);
+        record_BenchTiming_(&timings[render_BenchPhase], startTime);
+        iRelease(doc);
+        startTime = now_Bench_();
+        shapeLines_(source,
+                    d->format == plainText_SourceFormat ? preformatted_FontId : paragraph_FontId,
+                    width);
+        record_BenchTiming_(&timings[shape_BenchPhase], startTime);
+        delete_String(source);
+        recycle_Garbage();
+    }
+    iForIndices(i, timings) {
+        const iBenchTiming *t = &timings[i];
+        if (t->count == 0) {
+            continue;
+        }
+        printf("%-12s %10zu  %-9s %10.2f %10.2f %10.2f\n",
+               cstr_String(&d->name),
+               size_String(&d->source),
+               phaseNames_[i],
+               t->min * 1000.0,
+               t->total / t->count * 1000.0,
+               t->min > 0 ? size_String(&d->source) / t->min / 1.0e6 : 0.0);
+    }
+    fflush(stdout);
+}
+
+/*----------------------------------------------------------------------------------------------*/
+
+/* Micro-benchmarks. Each one performs a batch of operations on a shared fixture; the fastest
+   batch is reported as nanoseconds per operation. */
+
+iDeclareType(MicroFixture)
+
+struct Impl_MicroFixture {
+    iStringList *urls;        /* absolute URLs */
+    iStringList *relative;    /* references relative to `urls` */
+    iString      gemtext;
+    iVisited    *visited;
+    iBookmarks  *bookmarks;
+    iRegExp     *linkPattern;
+    iRegExp     *wordPattern;
+    iBlock      *archive;     /* serialized zip */
+    iString      paragraph;   /* long unwrapped prose */
+    const iFontFile *kernFont;  /* regular style of the default font */
+    iArray       kernGlyphs;  /* uint32_t, glyph indices of `paragraph` in `kernFont` */
+    iString      editorText;  /* about 1 MB of gemtext */
+    iInputWidget *editor;     /* focused multi-line editor holding `editorText` */
+};
+
+static void init_MicroFixture(iMicroFixture *d) {
+    static const char *schemes[] = { "gemini", "gopher", "https", "titan" };
+    d->urls     = new_StringList();
+    d->relative = new_StringList();
+    for (int i = 0; i < 1000; i++) {
+        pushBack_StringList(
+            d->urls,
+            collectNewFormat_String(i % 10 == 0 ? "%s://h\u00e4st-%d.example.org:1965/%d/p\u00e4ge.gmi"
+                                    : i % 3 == 0 ? "%s://host%d.example.com/dir/%d/../page.gmi?q=%d"
+                                                 : "%s://host%d.example.com/a/b/%d/index.gmi#x",
+                                    schemes[i % iElemCount(schemes)], i % 97, i, i));
+        pushBack_StringList(d->relative,
+                            collectNewFormat_String(i % 4 == 0   ? "../other/%d.gmi"
+                                                    : i % 4 == 1 ? "/root/%d/"
+                                                    : i % 4 == 2 ? "sub/%d.gmi#frag"
+                                                                 : "?query=%d",
+                                                    i));
+    }
+    init_String(&d->gemtext);
+    makeGemtext_(&d->gemtext, 200000, prose_, iElemCount(prose_));
+    d->visited = new_Visited();
+    for (int i = 0; i < 10000; i++) {
+        visitUrl_Visited(d->visited,
+                         collectNewFormat_String("gemini://site%d.example.com/%d.gmi", i % 500, i),
+                         0);
+    }
+    iConstForEach(StringList, u, d->urls) {
+        visitUrl_Visited(d->visited, u.value, 0);
+    }
+    d->bookmarks = new_Bookmarks();
+    for (int i = 0; i < 2000; i++) {
+        add_Bookmarks(d->bookmarks,
+                      collectNewFormat_String("gemini://site%d.example.com/%d.gmi", i % 300, i),
+                      collectNewFormat_String("Bookmark number %d", i),
+                      collectNewCStr_String(i % 7 == 0 ? "usertag" : ""),
+                      0);
+    }
+    d->linkPattern = new_RegExp("^=>\\s*([^\\s]+)(\\s+(.*))?", 0);
+    d->wordPattern = new_RegExp("\\b[a-z]+ing\\b", caseInsensitive_RegExpOption);
+    /* A zip archive of documents, like the resources or a Gempub. */ {
+        iArchive *arch = new_Archive();
+        openWritable_Archive(arch);
+        for (int i = 0; i < 100; i++) {
+            iString *doc = collectNew_String();
+            makeGemtext_(doc, 20000, prose_, iElemCount(prose_));
+            appendFormat_String(doc, "%d\n", i);
+            setData_Archive(arch, collectNewFormat_String("doc/%03d.gmi", i), utf8_String(doc));
+        }
+        iBuffer *buf = new_Buffer();
+        openEmpty_Buffer(buf);
+        serialize_Archive(arch, stream_Buffer(buf));
+        d->archive = copy_Block(data_Buffer(buf));
+        iRelease(buf);
+        iRelease(arch);
+    }
+    init_String(&d->paragraph);
+    appendParagraph_(&d->paragraph, prose_, iElemCount(prose_), 1, 40);
+    const iFontSpec *spec = findSpec_Fonts("default");
+    d->kernFont = spec ? spec->styles[regular_FontStyle] : NULL;
+    init_Array(&d->kernGlyphs, sizeof(uint32_t));
+#if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
+    if (d->kernFont) {
+        iConstForEach(String, ch, &d->paragraph) {
+            const uint32_t glyph = findGlyphIndex_FontFile(d->kernFont, ch.value);
+            pushBack_Array(&d->kernGlyphs, &glyph);
+        }
+    }
+#endif
+    /* A long text being edited, like in the upload dialog. */ {
+        init_String(&d->editorText);
+        makeGemtext_(&d->editorText, 1000000, prose_, iElemCount(prose_));
+        d->editor = new_InputWidget(0);
+        iWidget *w = as_Widget(d->editor);
+        setFixedSize_Widget(w, init_I2(1000, -1));
+        setUseReturnKeyBehavior_InputWidget(d->editor, iFalse);
+        setLineLimits_InputWidget(d->editor, 7, 20);
+        addChild_Widget(get_Root()->widget, iClob(d->editor));
+        setText_InputWidget(d->editor, &d->editorText);
+        arrange_Widget(w);
+        setFocus_Widget(w);
+        /* Type in the middle of the text rather than at either end. */
+        moveCursorHome_InputWidget(d->editor);
+        SDL_Event down = { .type = SDL_KEYDOWN };
+        down.key.state      = SDL_PRESSED;
+        down.key.keysym.sym = SDLK_DOWN;
+        size_t numLines = 0;
+        iConstForEach(String, ch, &d->editorText) {
+            numLines += (ch.value == '\n');
+        }
+        for (size_t i = 0; i < numLines / 2; i++) {
+            processEvent_Widget(w, &down);
+        }
+    }
+}
+
+static void deinit_MicroFixture(iMicroFixture *d) {
+    setFocus_Widget(NULL);
+    destroy_Widget(as_Widget(d->editor));
+    deinit_String(&d->editorText);
+    deinit_Array(&d->kernGlyphs);
+    deinit_String(&d->paragraph);
+    delete_Block(d->archive);
+    iRelease(d->wordPattern);
+    iRelease(d->linkPattern);
+    delete_Bookmarks(d->bookmarks);
+    delete_Visited(d->visited);
+    deinit_String(&d->gemtext);
+    iRelease(d->relative);
+    iRelease(d->urls);
+}
+
+/* Each of these returns the number of operations performed. */
+
+static size_t initUrl_Micro_(iMicroFixture *d) {
+    size_t count = 0;
+    iConstForEach(StringList, i, d->urls) {
+        iUrl parts;
+        init_Url(&parts, i.value);
+        count++;
+    }
+    return count;
+}
+
+static size_t absoluteUrl_Micro_(iMicroFixture *d) {
+    size_t count = 0;
+    iConstForEach(StringList, i, d->urls) {
+        absoluteUrl_String(i.value, constAt_StringList(d->relative, i.pos));
+        count++;
+    }
+    return count;
+}
+
+static size_t canonicalUrl_Micro_(iMicroFixture *d) {
+    size_t count = 0;
+    iConstForEach(StringList, i, d->urls) {
+        canonicalUrl_String(i.value);
+        count++;
+    }
+    return count;
+}
+
+static size_t lineType_Micro_(iMicroFixture *d) {
+    size_t   count = 0;
+    iRangecc line  = iNullRange;
+    while (nextSplit_Rangecc(range_String(&d->gemtext), "\n", &line)) {
+        lineType_Rangecc(line);
+        count++;
+    }
+    return count;
+}
+
+static size_t containsUrl_Micro_(iMicroFixture *d) {
+    size_t count = 0;
+    iConstForEach(StringList, i, d->urls) {
+        containsUrl_Visited(d->visited, i.value);
+        containsUrl_Visited(d->visited, constAt_StringList(d->relative, i.pos)); /* miss */
+        count += 2;
+    }
+    return count;
+}
+
+static size_t findUrl_Micro_(iMicroFixture *d) {
+    size_t count = 0;
+    for (int i = 0; i < 100; i++) {
+        findUrl_Bookmarks(d->bookmarks,
+                          collectNewFormat_String("gemini://site%d.example.com/%d.gmi",
+                                                  (i * 37) % 300, (i * 37) % 2000));
+        count++;
+    }
+    return count;
+}
+
+static iBool isMatching_Micro_(void *context, const iBookmark *bm) {
+    return indexOfCStr_String(&bm->title, context) != iInvalidPos;
+}
+
+static size_t listBookmarks_Micro_(iMicroFixture *d) {
+    for (int i = 0; i < 10; i++) {
+        list_Bookmarks(d->bookmarks, cmpTitleAscending_Bookmark, isMatching_Micro_, (void *) "number 1");
+    }
+    return 10;
+}
+
+static size_t appendString_Micro_(iMicroFixture *d) {
+    iUnused(d);
+    iString *str = new_String();
+    for (int i = 0; i < 100000; i++) {
+        appendCStr_String(str, "gemini://example.com/");
+        appendChar_String(str, 0x00e4);
+    }
+    delete_String(str);
+    return 200000;
+}
+
+static size_t searchString_Micro_(iMicroFixture *d) {
+    size_t count = 0;
+    for (int i = 0; i < 10; i++) {
+        indexOfCStr_String(&d->gemtext, "not found anywhere");
+        iString *copy = copy_String(&d->gemtext);
+        replace_String(copy, "Section", "Chapter");
+        delete_String(copy);
+        count += 2;
+    }
+    return count;
+}
+
+static size_t compressBlock_Micro_(iMicroFixture *d) {
+    iBlock *comp = compress_Block(utf8_String(&d->gemtext));
+    iBlock *orig = decompress_Block(comp);
+    iAssert(size_Block(orig) == size_String(&d->gemtext));
+    delete_Block(orig);
+    delete_Block(comp);
+    return 2;
+}
+
+static size_t matchLine_Micro_(iMicroFixture *d) {
+    size_t   count = 0;
+    iRangecc line  = iNullRange;
+    while (nextSplit_Rangecc(range_String(&d->gemtext), "\n", &line)) {
+        iRegExpMatch m;
+        init_RegExpMatch(&m);
+        matchRange_RegExp(d->linkPattern, line, &m);
+        count++;
+    }
+    return count;
+}
+
+static size_t matchAll_Micro_(iMicroFixture *d) {
+    return iMax(matchAllString_RegExp(d->wordPattern, &d->gemtext, NULL, NULL), 1u);
+}
+
+static size_t readArchive_Micro_(iMicroFixture *d) {
+    iArchive *arch = new_Archive();
+    openData_Archive(arch, d->archive);
+    const size_t count = numEntries_Archive(arch);
+    for (size_t i = 0; i < count; i++) {
+        dataAt_Archive(arch, i);
+    }
+    iRelease(arch);
+    return count;
+}
+
+static size_t measureParagraph_Micro_(iMicroFixture *d, iBool isKerning) {
+    extern int enableKerning_Text;
+    const int oldKerning = enableKerning_Text;
+    enableKerning_Text = isKerning;
+    for (int i = 0; i < 10; i++) {
+        measureWrapRange_Text(paragraph_FontId, 600, range_String(&d->paragraph));
+    }
+    enableKerning_Text = oldKerning;
+    return 10;
+}
+
+static size_t measureKerned_Micro_(iMicroFixture *d) {
+    return measureParagraph_Micro_(d, iTrue);
+}
+
+static size_t measureUnkerned_Micro_(iMicroFixture *d) {
+    return measureParagraph_Micro_(d, iFalse);
+}
+
+#if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
+/* Kerning of each adjacent glyph pair in the paragraph. The memoized lookup is the one used
+   by the simple text renderer; the stb_truetype call shows the cost without the memo. With
+   HarfBuzz, the "measure" benchmarks do not reach either of these. */
+static size_t kernPairs_Micro_(iMicroFixture *d, iBool isMemoized) {
+    static volatile int sink_;
+    const size_t    count  = size_Array(&d->kernGlyphs);
+    const uint32_t *glyphs = constData_Array(&d->kernGlyphs);
+    int total = 0;
+    for (size_t i = 1; i < count; i++) {
+        total += isMemoized
+                     ? glyphKernAdvance_FontFile(d->kernFont, glyphs[i - 1], glyphs[i])
+                     : stbtt_GetGlyphKernAdvance(&d->kernFont->stbInfo, glyphs[i - 1], glyphs[i]);
+    }
+    sink_ = total;
+    return iMax(count, 2u) - 1;
+}
+
+static size_t kernMemoized_Micro_(iMicroFixture *d) {
+    return kernPairs_Micro_(d, iTrue);
+}
+
+static size_t kernDirect_Micro_(iMicroFixture *d) {
+    return kernPairs_Micro_(d, iFalse);
+}
+#endif
+
+/* Typing a character and erasing it again. Each keystroke is handled like in the app,
+   including saving its undo state and rewrapping the edited line. */
+static size_t typeKeys_Micro_(iMicroFixture *d) {
+    iWidget *w = as_Widget(d->editor);
+    SDL_Event text = { .type = SDL_TEXTINPUT };
+    SDL_Event backspace = { .type = SDL_KEYDOWN };
+    backspace.key.state      = SDL_PRESSED;
+    backspace.key.keysym.sym = SDLK_BACKSPACE;
+    for (int i = 0; i < 100; i++) {
+        strcpy(text.text.text, "x");
+        processEvent_Widget(w, &text);
+        processEvent_Widget(w, &backspace);
+    }
+    return 200;
+}
+
+static volatile uint32_t referenceSink_;
+
+static int compareInts_(const void *a, const void *b) {
+    const int x = *(const int *) a, y = *(const int *) b;
+    return (x > y) - (x < y);
+}
+
+/* A fixed workload that does not use any app code. Other results are given relative to it,
+   which mostly cancels out the speed of the machine. */
+static size_t reference_Micro_(iMicroFixture *d) {
+    const char *text = cstr_String(&d->gemtext);
+    const size_t size = size_String(&d->gemtext);
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ (uint8_t) text[i]) * 16777619u; /* FNV-1a */
+    }
+    int values[4096];
+    uint32_t seed = 1;
+    iForIndices(i, values) {
+        seed = seed * 1103515245u + 12345u;
+        values[i] = (int) (seed >> 8);
+    }
+    qsort(values, iElemCount(values), sizeof(values[0]), compareInts_);
+    referenceSink_ = hash ^ (uint32_t) values[0];
+    return 1;
+}
+
+static double measure_Micro_(size_t (*func)(iMicroFixture *), iMicroFixture *fixture,
+                             int iterations) {
+    double best = 0.0;
+    func(fixture); /* warm up */
+    for (int iter = 0; iter < iterations; iter++) {
+        const double startTime = now_Bench_();
+        const size_t numOps    = func(fixture);
+        const double nsPerOp   = (now_Bench_() - startTime) * 1.0e9 / numOps;
+        best = (iter == 0 ? nsPerOp : iMin(best, nsPerOp));
+        recycle_Garbage();
+    }
+    return best;
+}
+
+static const struct {
+    const char *suite;
+    const char *name;
+    size_t    (*func)(iMicroFixture *);
+} microBenches_[] = {
+    { "url",       "init_Url",              initUrl_Micro_ },
+    { "url",       "absoluteUrl_String",    absoluteUrl_Micro_ },
+    { "url",       "canonicalUrl_String",   canonicalUrl_Micro_ },
+    { "gemtext",   "lineType_Rangecc",      lineType_Micro_ },
+    { "visited",   "containsUrl_Visited",   containsUrl_Micro_ },
+    { "bookmarks", "findUrl_Bookmarks",     findUrl_Micro_ },
+    { "bookmarks", "list_Bookmarks",        listBookmarks_Micro_ },
+    { "string",    "append_String",         appendString_Micro_ },
+    { "string",    "search_String",         searchString_Micro_ },
+    { "string",    "compress_Block",        compressBlock_Micro_ },
+    { "regexp",    "match_RegExp.line",     matchLine_Micro_ },
+    { "regexp",    "match_RegExp.all",      matchAll_Micro_ },
+    { "archive",   "dataAt_Archive",        readArchive_Micro_ },
+    { "text",      "measure.kerning",       measureKerned_Micro_ },
+    { "text",      "measure.noKerning",     measureUnkerned_Micro_ },
+    { "input",     "keystroke",             typeKeys_Micro_ },
+#if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
+    { "text",      "glyphKernAdvance",      kernMemoized_Micro_ },
+    { "text",      "stbtt_GetGlyphKernAdvance", kernDirect_Micro_ },
+#endif
+};
+
+iDeclareType(Baseline)
+
+struct Impl_Baseline {
+    iStringList *names;
+    iArray       values; /* double, cost relative to the reference workload */
+};
+
+static void init_Baseline(iBaseline *d) {
+    d->names = new_StringList();
+    init_Array(&d->values, sizeof(double));
+}
+
+static void deinit_Baseline(iBaseline *d) {
+    deinit_Array(&d->values);
+    iRelease(d->names);
+}
+
+static size_t find_Baseline_(const iBaseline *d, const iString *name) {
+    iConstForEach(StringList, i, d->names) {
+        if (equal_String(i.value, name)) {
+            return i.pos;
+        }
+    }
+    return iInvalidPos;
+}
+
+static void set_Baseline_(iBaseline *d, const iString *name, double value) {
+    const size_t pos = find_Baseline_(d, name);
+    if (pos == iInvalidPos) {
+        pushBack_StringList(d->names, name);
+        pushBack_Array(&d->values, &value);
+    }
+    else {
+        *(double *) at_Array(&d->values, pos) = value;
+    }
+}
+
+/* The file has one "suite/name relative-cost" pair per line; '#' starts a comment. */
+static void load_Baseline_(iBaseline *d, const iString *path) {
+    iFile *f = new_File(path);
+    if (open_File(f, readOnly_FileMode | text_FileMode)) {
+        iString *src = newBlock_String(collect_Block(readAll_File(f)));
+        iRangecc line = iNullRange;
+        while (nextSplit_Rangecc(range_String(src), "\n", &line)) {
+            trim_Rangecc(&line);
+            if (isEmpty_Range(&line) || *line.start == '#') {
+                continue;
+            }
+            iRangecc name = iNullRange;
+            if (nextSplit_Rangecc(line, " ", &name)) {
+                set_Baseline_(d, collectNewRange_String(name), strtod(name.end, NULL));
+            }
+        }
+        delete_String(src);
+    }
+    iRelease(f);
+}
+
+static void save_Baseline_(const iBaseline *d, const iString *path) {
+    iFile *f = new_File(path);
+    if (open_File(f, writeOnly_FileMode | text_FileMode)) {
+        printf_Stream(stream_File(f),
+                      "# lagrange-bench micro-benchmark baselines (cost relative to the "
+                      "reference workload).\n"
+                      "# Regenerate with: lagrange-bench --micro all --baseline FILE "
+                      "--update-baseline\n");
+        iConstForEach(StringList, i, d->names) {
+            printf_Stream(stream_File(f), "%s %.6g\n", cstr_String(i.value),
+                          *(const double *) constAt_Array(&d->values, i.pos));
+        }
+    }
+    else {
+        fprintf(stderr, "failed to write: %s\n", cstr_String(path));
+    }
+    iRelease(f);
+}
+
+/* Returns the number of benchmarks that were slower than the baseline allows. When checking,
+   a benchmark that has no baseline fails as well. */
+static int runMicro_Bench_(const char *suite, int iterations, iBaseline *baseline,
+                           iBool isChecking, double tolerance, iBool update) {
+    iMicroFixture fixture;
+    init_MicroFixture(&fixture);
+    int numFailed = 0;
+    const double refNs = measure_Micro_(reference_Micro_, &fixture, iterations);
+    printf("%-32s %12.2f\n", "reference (ns)", refNs);
+    printf("%-32s %12s %10s %10s %8s\n", "benchmark", "ns/op", "relative", "baseline", "change");
+    iForIndices(i, microBenches_) {
+        if (strcmp(suite, "all") && strcmp(suite, microBenches_[i].suite)) {
+            continue;
+        }
+        iString *name = collectNewFormat_String("%s/%s", microBenches_[i].suite,
+                                                microBenches_[i].name);
+        const double best     = measure_Micro_(microBenches_[i].func, &fixture, iterations);
+        const double relative = best / refNs;
+        const size_t pos      = find_Baseline_(baseline, name);
+        if (pos != iInvalidPos && !update) {
+            const double base   = *(const double *) constAt_Array(&baseline->values, pos);
+            const double change = base > 0 ? (relative / base - 1.0) * 100.0 : 0.0;
+            const iBool  isSlow = change > tolerance;
+            printf("%-32s %12.2f %10.4g %10.4g %+7.1f%%%s\n",
+                   cstr_String(name), best, relative, base, change, isSlow ? "  SLOWER" : "");
+            if (isSlow) {
+                numFailed++;
+            }
+        }
+        else {
+            const iBool isMissing = isChecking && !update;
+            printf("%-32s %12.2f %10.4g %10s %8s%s\n", cstr_String(name), best, relative, "-",
+                   "", isMissing ? "  NO BASELINE" : "");
+            if (isMissing) {
+                numFailed++;
+            }
+        }
+        if (update) {
+            set_Baseline_(baseline, name, relative);
+        }
+    }
+    fflush(stdout);
+    deinit_MicroFixture(&fixture);
+    return numFailed;
+}
+
+int main(int argc, char **argv) {
+    init_Foundation();
+    iCommandLine args;
+    init_CommandLine(&args, argc, argv);
+    defineValues_CommandLine(&args, "help", 0);
+    defineValues_CommandLine(&args, "iterations;n", 1);
+    defineValues_CommandLine(&args, "width;w", 1);
+    defineValues_CommandLine(&args, userDataDir_CommandLineOption, 1);
+    defineValues_CommandLine(&args, "micro", 1);
+    defineValues_CommandLine(&args, "baseline", 1);
+    defineValues_CommandLine(&args, "tolerance", 1);
+    defineValues_CommandLine(&args, "update-baseline", 0);
+    defineValues_CommandLine(&args, "no-fast-shaping", 0);
+    if (contains_CommandLine(&args, "help")) {
+        puts("Usage: lagrange-bench [--iterations N] [--width PX] [--user DIR]\n"
+             "                      [--no-fast-shaping] [FILE...]\n"
+             "       lagrange-bench --micro SUITE [--baseline FILE [--tolerance PCT]\n"
+             "                      [--update-baseline]]\n"
+             "Lays out and shapes a built-in corpus, or the given files (.gmi, .md, .txt,\n"
+             ".gph). Reports the fastest and mean time of each phase in milliseconds.\n"
+             "With --micro, runs the micro-benchmarks of SUITE (url, gemtext, visited,\n"
+             "bookmarks, string, regexp, archive, text, input, or all). Results are also\n"
+             "given relative to a fixed reference workload. With --baseline, exits with an\n"
+             "error if any relative cost is more than PCT percent (default 25) above its\n"
+             "baseline, or if a benchmark has no baseline. Exits with 77 (skipped) if the\n"
+             "baseline FILE does not exist.\n"
+             "--no-fast-shaping sends ASCII monospaced text through HarfBuzz, too.");
+        return 0;
+    }
+    int   iterations = 5;
+    int   width      = 1000;
+    iString *userDir = newCStr_String("lagrange-bench.user");
+    iString *microSuite   = NULL;
+    iString *baselinePath = NULL;
+    double   tolerance    = 25.0;
+    iBool    isUpdatingBaseline = contains_CommandLine(&args, "update-baseline");
+    iPtrArray corpora;
+    init_PtrArray(&corpora);
+    iConstForEach(CommandLine, i, &args) {
+        if (i.argType == value_CommandLineArgType) {
+            iBenchCorpus *corpus = loadCorpus_(collectNewRange_String(i.entry));
+            if (corpus) {
+                pushBack_PtrArray(&corpora, corpus);
+            }
+        }
+        else if (equal_CommandLineConstIterator(&i, "iterations;n")) {
+            const iCommandLineArg *arg = iClob(argument_CommandLineConstIterator(&i));
+            iterations = iMax(1, toInt_String(value_CommandLineArg(arg, 0)));
+        }
+        else if (equal_CommandLineConstIterator(&i, "width;w")) {
+            const iCommandLineArg *arg = iClob(argument_CommandLineConstIterator(&i));
+            width = iMax(100, toInt_String(value_CommandLineArg(arg, 0)));
+        }
+        else if (equal_CommandLineConstIterator(&i, userDataDir_CommandLineOption)) {
+            const iCommandLineArg *arg = iClob(argument_CommandLineConstIterator(&i));
+            set_String(userDir, value_CommandLineArg(arg, 0));
+        }
+        else if (equal_CommandLineConstIterator(&i, "micro")) {
+            const iCommandLineArg *arg = iClob(argument_CommandLineConstIterator(&i));
+            microSuite = copy_String(value_CommandLineArg(arg, 0));
+        }
+        else if (equal_CommandLineConstIterator(&i, "baseline")) {
+            const iCommandLineArg *arg = iClob(argument_CommandLineConstIterator(&i));
+            baselinePath = copy_String(value_CommandLineArg(arg, 0));
+        }
+        else if (equal_CommandLineConstIterator(&i, "tolerance")) {
+            const iCommandLineArg *arg = iClob(argument_CommandLineConstIterator(&i));
+            tolerance = iMax(0.0, toFloat_String(value_CommandLineArg(arg, 0)));
+        }
+    }
+#if defined (LAGRANGE_ENABLE_HARFBUZZ)
+    if (contains_CommandLine(&args, "no-fast-shaping")) {
+        extern int enableShapingFastPath_Text;
+        enableShapingFastPath_Text = iFalse;
+    }
+#endif
+    /* Nothing is shown on screen, so there is no need for a real display. */
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0 /* keep if already set */);
+    if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER)) {
+        fprintf(stderr, "[SDL] init failed: %s\n", SDL_GetError());
+        return 1;
+    }
+    makeDirs_Path(userDir);
+    char *appArgv[] = { argv[0], "--sw", "--user", (char *) cstr_String(userDir) };
+    initHeadless_App(iElemCount(appArgv), appArgv);
+    int exitCode = 0;
+    if (microSuite && baselinePath && !isUpdatingBaseline && !fileExists_FileInfo(baselinePath)) {
+        /* Nothing to compare against; CTest reports this as skipped. */
+        printf("no baselines in %s (record them with the bench-baseline target)\n",
+               cstr_String(baselinePath));
+        exitCode = skipped_BenchExitCode;
+    }
+    else if (microSuite) {
+        iBaseline baseline;
+        init_Baseline(&baseline);
+        if (baselinePath) {
+            load_Baseline_(&baseline, baselinePath);
+        }
+        if (runMicro_Bench_(cstr_String(microSuite), iterations, &baseline,
+                            baselinePath != NULL, tolerance, isUpdatingBaseline)) {
+            exitCode = 1;
+        }
+        if (baselinePath && isUpdatingBaseline) {
+            save_Baseline_(&baseline, baselinePath);
+        }
+        deinit_Baseline(&baseline);
+    }
+    else {
+        if (isEmpty_PtrArray(&corpora)) {
+            makeBuiltinCorpora_(&corpora);
+        }
+        printf("%-12s %10s  %-9s %10s %10s %10s\n",
+               "corpus", "bytes", "phase", "min ms", "mean ms", "MB/s");
+        iConstForEach(PtrArray, c, &corpora) {
+            run_BenchCorpus_(c.ptr, iterations, width);
+        }
+    }
+    iForEach(PtrArray, d, &corpora) {
+        delete_BenchCorpus_(d.ptr);
+    }
+    deinit_PtrArray(&corpora);
+    deinitHeadless_App();
+    delete_String(baselinePath);
+    delete_String(microSuite);
+    delete_String(userDir);
+    deinit_CommandLine(&args);
+    SDL_Quit();
+    deinit_Foundation();
+    return exitCode;
+}
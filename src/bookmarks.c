@@ -209,6 +209,19 @@ void clear_Bookmarks(iBookmarks *d) {
     unlock_Mutex(d->mtx);
 }
 
+size_t memorySize_Bookmarks(const iBookmarks *d) {
+    size_t size = 0;
+    lock_Mutex(d->mtx);
+    iConstForEach(Hash, i, &d->bookmarks) {
+        const iBookmark *bm = (const iBookmark *) i.value;
+        size += sizeof(iBookmark) + size_String(&bm->url) + size_String(&bm->originalUrl) +
+                size_String(&bm->title) + size_String(&bm->tags) + size_String(&bm->notes) +
+                size_String(&bm->identity);
+    }
+    unlock_Mutex(d->mtx);
+    return size;
+}
+
 static void insertId_Bookmarks_(iBookmarks *d, iBookmark *bookmark, int id) {
     bookmark->node.key = id;
     insert_Hash(&d->bookmarks, &bookmark->node);
@@ -84,6 +84,7 @@ typedef iBool (*iBookmarksFilterFunc)   (void *context, const iBookmark *);
 typedef int   (*iBookmarksCompareFunc)  (const iBookmark **, const iBookmark **);
 
 void        clear_Bookmarks             (iBookmarks *);
+size_t      memorySize_Bookmarks        (const iBookmarks *); /* bytes */
 void        load_Bookmarks              (iBookmarks *, const char *dirPath);
 void        save_Bookmarks              (const iBookmarks *, const char *dirPath);
 void        serialize_Bookmarks         (const iBookmarks *, iStream *outs);
@@ -200,6 +200,75 @@ static iBool isUrlIgnored_FeedJob_(const iFeedJob *d, iRangecc url) {
     return iFalse;
 }
 
+/* Whitespace within a line: `\s` without the newline. */
+#define linkPattern_FeedParser_ \
+    "=>[^\\S\\n]*(\\S+)[^\\S\\n]+([0-9][0-9][0-9][0-9]-[0-1][0-9]-[0-3][0-9])([^0-9\\n].*)"
+#define headingPattern_FeedParser_ "#+[^\\S\\n]*(.*)"
+
+iDeclareType(FeedParser)
+
+struct Impl_FeedParser {
+    iFeedJob *job;
+    iTime     now;
+    iTime     perEntryAdjust;
+};
+
+static void addLinkEntry_FeedParser_(iFeedParser *d, const iRegExpMatch *m) {
+    const iRangecc url   = capturedRange_RegExpMatch(m, 1);
+    const iRangecc date  = capturedRange_RegExpMatch(m, 2);
+    iRangecc       title = capturedRange_RegExpMatch(m, 3);
+    trimEnd_Rangecc(&title);
+    if (isEmpty_Range(&title) || isUrlIgnored_FeedJob_(d->job, url)) {
+        return;
+    }
+    iFeedEntry *entry = new_FeedEntry();
+    entry->discovered = d->now;
+    sub_Time(&d->now, &d->perEntryAdjust);
+    entry->bookmarkId = d->job->bookmarkId;
+    setRange_String(&entry->url, url);
+    set_String(&entry->url, canonicalUrl_String(absoluteUrl_String(url_GmRequest(d->job->request), &entry->url)));
+    setRange_String(&entry->title, title);
+    trimTitle_(&entry->title);
+    int year, month, day;
+    sscanf(date.start, "%04d-%02d-%02d", &year, &month, &day);
+    init_Time(
+        &entry->posted,
+        &(iDate){
+            .year = year, .month = month, .day = day, .hour = 12 /* noon UTC */ });
+    pushBack_PtrArray(&d->job->results, entry);
+}
+
+static void addHeadingEntry_FeedParser_(iFeedParser *d, const iRegExpMatch *m) {
+    iRangecc line = capturedRange_RegExpMatch(m, 4);
+    trimEnd_Rangecc(&line);
+    iFeedEntry *entry = new_FeedEntry();
+    entry->isHeading = iTrue;
+    entry->posted = d->now;
+    if (!d->job->isFirstUpdate) {
+        entry->discovered = d->now;
+        sub_Time(&d->now, &d->perEntryAdjust);
+    }
+    entry->bookmarkId = d->job->bookmarkId;
+    iString *title = newRange_String(line);
+    set_String(&entry->title, title);
+    set_String(&entry->url, &d->job->url);
+    appendChar_String(&entry->url, '#');
+    append_String(&entry->url, collect_String(urlEncode_String(title)));
+    set_String(&entry->url, canonicalUrl_String(&entry->url));
+    delete_String(title);
+    pushBack_PtrArray(&d->job->results, entry);
+}
+
+static iBool addEntry_FeedParser_(void *context, const iRegExpMatch *m) {
+    if (*begin_RegExpMatch(m) == '#') {
+        addHeadingEntry_FeedParser_(context, m);
+    }
+    else {
+        addLinkEntry_FeedParser_(context, m);
+    }
+    return iTrue;
+}
+
 static iBool parseResult_FeedJob_(iFeedJob *d) {
     const enum iGmStatusCode statusCode = status_GmRequest(d->request);
     /* Returns true if the job is done and can be released. False means the job continues. */
@@ -222,75 +291,20 @@ static iBool parseResult_FeedJob_(iFeedJob *d) {
     /* TODO: Should tell the user if the request failed. */
     if (isSuccess_GmStatusCode(statusCode)) {
         iBeginCollect();
-        iTime now;
-        iTime perEntryAdjust;
-        initSeconds_Time(&perEntryAdjust, 1.0);
-        initCurrent_Time(&now);
-        iRegExp *linkPattern =
-            new_RegExp("^=>\\s*([^\\s]+)\\s+"
-                       "([0-9][0-9][0-9][0-9]-[0-1][0-9]-[0-3][0-9])"
-                       "([^0-9].*)",
-                       0);
+        iFeedParser parser = { .job = d };
+        initSeconds_Time(&parser.perEntryAdjust, 1.0);
+        initCurrent_Time(&parser.now);
+        /* Dated links, and optionally headings, in the order they appear. */
+        iRegExp *pattern = new_RegExp(
+            d->checkHeadings ? "^(?:" linkPattern_FeedParser_ "|" headingPattern_FeedParser_ ")"
+                             : "^" linkPattern_FeedParser_,
+            multiLine_RegExpOption);
         iString src;
         initBlock_String(&src, &lockResponse_GmRequest(d->request)->body);
         unlockResponse_GmRequest(d->request);
-        iRangecc srcLine = iNullRange;
-        while (nextSplit_Rangecc(range_String(&src), "\n", &srcLine)) {
-            iRangecc line = srcLine;
-            trimEnd_Rangecc(&line);
-            iRegExpMatch m;
-            init_RegExpMatch(&m);
-            if (matchRange_RegExp(linkPattern, line, &m)) {
-                const iRangecc url   = capturedRange_RegExpMatch(&m, 1);
-                const iRangecc date  = capturedRange_RegExpMatch(&m, 2);
-                const iRangecc title = capturedRange_RegExpMatch(&m, 3);
-                if (isUrlIgnored_FeedJob_(d, url)) {
-                    continue;
-                }
-                iFeedEntry *entry = new_FeedEntry();
-                entry->discovered = now;
-                sub_Time(&now, &perEntryAdjust);
-                entry->bookmarkId = d->bookmarkId;
-                setRange_String(&entry->url, url);
-                set_String(&entry->url, canonicalUrl_String(absoluteUrl_String(url_GmRequest(d->request), &entry->url)));
-                setRange_String(&entry->title, title);
-                trimTitle_(&entry->title);
-                int year, month, day;
-                sscanf(date.start, "%04d-%02d-%02d", &year, &month, &day);
-                init_Time(
-                    &entry->posted,
-                    &(iDate){
-                        .year = year, .month = month, .day = day, .hour = 12 /* noon UTC */ });
-                pushBack_PtrArray(&d->results, entry);
-            }
-            if (d->checkHeadings) {
-                init_RegExpMatch(&m);
-                if (startsWith_Rangecc(line, "#")) {
-                    while (*line.start == '#' && line.start < line.end) {
-                        line.start++;
-                    }
-                    trimStart_Rangecc(&line);
-                    iFeedEntry *entry = new_FeedEntry();
-                    entry->isHeading = iTrue;
-                    entry->posted = now;
-                    if (!d->isFirstUpdate) {
-                        entry->discovered = now;
-                        sub_Time(&now, &perEntryAdjust);
-                    }
-                    entry->bookmarkId = d->bookmarkId;
-                    iString *title = newRange_String(line);
-                    set_String(&entry->title, title);
-                    set_String(&entry->url, &d->url);
-                    appendChar_String(&entry->url, '#');
-                    append_String(&entry->url, collect_String(urlEncode_String(title)));
-                    set_String(&entry->url, canonicalUrl_String(&entry->url));
-                    delete_String(title);
-                    pushBack_PtrArray(&d->results, entry);
-                }
-            }
-        }
+        matchAllString_RegExp(pattern, &src, addEntry_FeedParser_, &parser);
         deinit_String(&src);
-        iRelease(linkPattern);
+        iRelease(pattern);
         iEndCollect();
     }
     return iTrue;
@@ -902,6 +916,18 @@ size_t numUnread_Feeds(void) {
     return count;
 }
 
+size_t memorySize_Feeds(void) {
+    iFeeds *d = &feeds_;
+    size_t size = 0;
+    lock_Mutex(d->mtx);
+    iConstForEach(Array, i, &d->entries.values) {
+        const iFeedEntry *entry = *(const iFeedEntry **) i.value;
+        size += sizeof(iFeedEntry) + size_String(&entry->url) + size_String(&entry->title);
+    }
+    unlock_Mutex(d->mtx);
+    return size;
+}
+
 const iString *entryListPage_Feeds(void) {
     iFeeds *d = &feeds_;
     iString *src = collectNew_String();
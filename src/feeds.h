@@ -63,3 +63,4 @@ const iPtrArray *   listMatchingEntries_Feeds(const char *urlPrefix);
 const iString *     entryListPage_Feeds (void);
 size_t              numSubscribed_Feeds (void);
 size_t              numUnread_Feeds     (void);
+size_t              memorySize_Feeds    (void); /* bytes */
@@ -74,6 +74,7 @@ void init_FontFile(iFontFile *d) {
     d->emAdvance = 0;
     d->ascent    = 0;
     d->descent   = 0;
+    d->kerning   = NULL;
     init_Block(&d->sourceData, 0);
 #if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
     iZap(d->stbInfo);
@@ -82,9 +83,40 @@ void init_FontFile(iFontFile *d) {
     d->hbBlob = NULL;
     d->hbFace = NULL;
     d->hbFont = NULL;
+    d->hasDefaultFeatures = iFalse;
 #endif
 }
 
+#if defined (LAGRANGE_ENABLE_HARFBUZZ)
+static iBool detectDefaultFeatures_FontFile_(const iFontFile *d) {
+    /* Features that HarfBuzz enables by default and that may affect plain ASCII. */
+    static const hb_tag_t defaultFeatures[] = {
+        HB_TAG('l','i','g','a'), HB_TAG('c','l','i','g'), HB_TAG('r','l','i','g'),
+        HB_TAG('c','a','l','t'), HB_TAG('r','c','l','t'), HB_TAG('k','e','r','n'),
+        HB_TAG('d','i','s','t'),
+    };
+    static const hb_tag_t tables[] = { HB_OT_TAG_GSUB, HB_OT_TAG_GPOS };
+    iForIndices(t, tables) {
+        hb_tag_t     tags[64];
+        unsigned int offset = 0;
+        unsigned int count;
+        do {
+            count = iElemCount(tags);
+            hb_ot_layout_table_get_feature_tags(d->hbFace, tables[t], offset, &count, tags);
+            for (unsigned int i = 0; i < count; i++) {
+                iForIndices(f, defaultFeatures) {
+                    if (tags[i] == defaultFeatures[f]) {
+                        return iTrue;
+                    }
+                }
+            }
+            offset += count;
+        } while (count == iElemCount(tags));
+    }
+    return iFalse;
+}
+#endif
+
 static void load_FontFile_(iFontFile *d, const iBlock *data) {
 #if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
     set_Block(&d->sourceData, data);
@@ -110,6 +142,7 @@ static void load_FontFile_(iFontFile *d, const iBlock *data) {
                                HB_MEMORY_MODE_READONLY, NULL, NULL);
     d->hbFace = hb_face_create(d->hbBlob, d->colIndex);
     d->hbFont = hb_font_create(d->hbFace);
+    d->hasDefaultFeatures = detectDefaultFeatures_FontFile_(d);
 #endif
 }
 
@@ -125,7 +158,11 @@ static iBool detectMonospace_FontFile_(const iFontFile *d) {
 #endif
 }
 
+static void delete_KernTable_(iKernTable *);
+
 static void unload_FontFile_(iFontFile *d) {
+    delete_KernTable_(d->kerning);
+    d->kerning = NULL;
 #if defined (LAGRANGE_ENABLE_HARFBUZZ)
     /* HarfBuzz objects. */
     hb_font_destroy(d->hbFont);
@@ -185,6 +222,98 @@ int glyphAdvance_FontFile(const iFontFile *d, uint32_t glyphIndex) {
 #endif
 }
 
+/* Looking up a pair in the font's kern/GPOS tables is slow, and the same pairs recur
+   constantly, so the adjustments are memoized in an open-addressed hash table. */
+struct Impl_KernTable {
+    uint32_t  mask;  /* capacity - 1 */
+    uint32_t  count;
+    uint32_t *keys;  /* glyph1 << 16 | glyph2 */
+    int16_t  *values;
+};
+
+#define emptyKey_KernTable_ 0xffffffffu
+
+static iKernTable *new_KernTable_(uint32_t capacity) {
+    iKernTable *d = iMalloc(KernTable);
+    d->mask   = capacity - 1;
+    d->count  = 0;
+    d->keys   = malloc(sizeof(uint32_t) * capacity);
+    d->values = malloc(sizeof(int16_t) * capacity);
+    memset(d->keys, 0xff, sizeof(uint32_t) * capacity);
+    return d;
+}
+
+static void delete_KernTable_(iKernTable *d) {
+    if (d) {
+        free(d->keys);
+        free(d->values);
+        free(d);
+    }
+}
+
+static uint32_t slot_KernTable_(const iKernTable *d, uint32_t key) {
+    uint32_t hash = key * 2654435761u;
+    for (uint32_t i = (hash ^ (hash >> 16)) & d->mask; ; i = (i + 1) & d->mask) {
+        if (d->keys[i] == key || d->keys[i] == emptyKey_KernTable_) {
+            return i;
+        }
+    }
+}
+
+static void insert_KernTable_(iKernTable *d, uint32_t key, int16_t value);
+
+static void grow_KernTable_(iKernTable *d) {
+    iKernTable *bigger = new_KernTable_(2 * (d->mask + 1));
+    for (uint32_t i = 0; i <= d->mask; i++) {
+        if (d->keys[i] != emptyKey_KernTable_) {
+            insert_KernTable_(bigger, d->keys[i], d->values[i]);
+        }
+    }
+    free(d->keys);
+    free(d->values);
+    *d = *bigger;
+    free(bigger);
+}
+
+static void insert_KernTable_(iKernTable *d, uint32_t key, int16_t value) {
+    if (2 * (d->count + 1) > d->mask + 1) {
+        grow_KernTable_(d);
+    }
+    const uint32_t i = slot_KernTable_(d, key);
+    if (d->keys[i] == emptyKey_KernTable_) {
+        d->keys[i] = key;
+        d->count++;
+    }
+    d->values[i] = value;
+}
+
+static size_t memorySize_KernTable_(const iKernTable *d) {
+    return d ? sizeof(*d) + (d->mask + 1) * (sizeof(uint32_t) + sizeof(int16_t)) : 0;
+}
+
+int glyphKernAdvance_FontFile(const iFontFile *d, uint32_t glyph1, uint32_t glyph2) {
+#if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
+    const uint32_t key = glyph1 << 16 | glyph2;
+    if (glyph1 > 0xffff || glyph2 > 0xffff || key == emptyKey_KernTable_) {
+        return stbtt_GetGlyphKernAdvance(&d->stbInfo, glyph1, glyph2);
+    }
+    iFontFile *mut = iConstCast(iFontFile *, d);
+    if (!mut->kerning) {
+        mut->kerning = new_KernTable_(256);
+    }
+    const uint32_t i = slot_KernTable_(mut->kerning, key);
+    if (mut->kerning->keys[i] == key) {
+        return mut->kerning->values[i];
+    }
+    const int kern = stbtt_GetGlyphKernAdvance(&d->stbInfo, glyph1, glyph2);
+    insert_KernTable_(mut->kerning, key, (int16_t) iClamp(kern, INT16_MIN, INT16_MAX));
+    return kern;
+#else
+    iUnused(d, glyph1, glyph2);
+    return 0;
+#endif
+}
+
 /*----------------------------------------------------------------------------------------------*/
 
 iDefineTypeConstruction(FontSpec)
@@ -630,7 +759,8 @@ void init_Fonts(const char *userDir) {
         iFontPack *pack = new_FontPack();
         setCStr_String(&pack->id, "default");
         setReadOnly_FontPack(pack, iTrue);
-        loadArchive_FontPack(pack, archive_Resources()); /* should never fail if we've made it this far */
+        loadArchive_FontPack(pack, lockArchive_Resources()); /* should never fail if we've made it this far */
+        unlockArchive_Resources();
         pushBack_PtrArray(&d->packs, pack);
 #if defined (iPlatformMsys) || defined (iPlatformWindows)
         /* The system UI font is used as the default font. */
@@ -671,7 +801,7 @@ void init_Fonts(const char *userDir) {
         pack->loadPath = newCStr_String("/System/Library/Fonts/");
         setCStr_String(&pack->id, "macos-system-fonts");
         iString ini;
-        initBlock_String(&ini, &blobMacosSystemFontsIni_Resources);
+        initBlock_String(&ini, load_Resources(&blobMacosSystemFontsIni_Resources));
         if (load_FontPack_(pack, &ini)) {
             pushBack_PtrArray(&d->packs, pack);
         }
@@ -811,6 +941,22 @@ const iPtrArray *listPacks_Fonts(void) {
     return &fonts_.packs;
 }
 
+size_t memorySize_Fonts(void) {
+    /* Files may share the same data, so each block is counted only once. */
+    size_t   size   = 0;
+    iPtrSet *unique = new_PtrSet();
+    iConstForEach(ObjectList, i, fonts_.files) {
+        const iFontFile *ff = i.object;
+        if (!contains_PtrSet(unique, ff->sourceData.i)) {
+            insert_PtrSet(unique, ff->sourceData.i);
+            size += size_Block(&ff->sourceData);
+        }
+        size += memorySize_KernTable_(ff->kerning);
+    }
+    delete_PtrSet(unique);
+    return size;
+}
+
 const iFontSpec *findSpec_Fonts(const char *fontId) {
     iFonts *d = &fonts_;
     iConstForEach(PtrArray, i, &d->specOrder) {
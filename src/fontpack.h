@@ -31,6 +31,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #if defined (LAGRANGE_ENABLE_HARFBUZZ)
 #   include <hb.h>
+#   include <hb-ot.h>
 #endif
 
 #define mimeType_FontPack "application/lagrange-fontpack+zip"
@@ -77,6 +78,7 @@ float   scale_FontSize  (enum iFontSize size);
 
 iDeclareClass(FontFile)
 iDeclareObjectConstruction(FontFile)
+iDeclareType(KernTable)
     
 struct Impl_FontFile {
     iObject         object; /* reference-counted */
@@ -91,9 +93,11 @@ struct Impl_FontFile {
     hb_blob_t *hbBlob;
     hb_face_t *hbFace;
     hb_font_t *hbFont;
+    iBool      hasDefaultFeatures; /* ligatures or kerning applied when shaping */
 #endif
     /* Metrics: */
     int ascent, descent, emAdvance;
+    iKernTable *kerning; /* memoized pair adjustments; allocated when needed */
 };
 
 #if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
@@ -104,6 +108,7 @@ iLocalDef uint32_t findGlyphIndex_FontFile(const iFontFile *d, iChar ch) {
 
 float       scaleForPixelHeight_FontFile(const iFontFile *, int pixelHeight);
 int         glyphAdvance_FontFile       (const iFontFile *, uint32_t glyphIndex);
+int         glyphKernAdvance_FontFile   (const iFontFile *, uint32_t glyph1, uint32_t glyph2);
 void        measureGlyph_FontFile       (const iFontFile *, uint32_t glyphIndex,
                                          float xScale, float yScale, float xShift,
                                          int *x0, int *y0, int *x1, int *y1);
@@ -186,6 +191,7 @@ const iFontSpec *   findSpec_Fonts              (const char *fontId);
 const iPtrArray *   listPacks_Fonts             (void);
 const iPtrArray *   listSpecs_Fonts             (iBool (*filterFunc)(const iFontSpec *));
 const iPtrArray *   listSpecsByPriority_Fonts   (void);
+size_t              memorySize_Fonts            (void); /* loaded font files */
 const iString *     infoPage_Fonts              (iRangecc query);
 void                install_Fonts               (const iString *fontId, const iBlock *data);
 void                installFontFile_Fonts       (const iString *fileName, const iBlock *data);
@@ -33,15 +33,16 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "bookmarks.h"
 #include "app.h"
 #include "defs.h"
+#include "trace.h"
 
 #include <the_Foundation/intset.h>
 #include <the_Foundation/path.h>
 #include <the_Foundation/ptrarray.h>
 #include <the_Foundation/regexp.h>
-#include <the_Foundation/stringarray.h>
 #include <the_Foundation/stringset.h>
 
 #include <ctype.h>
+#include <limits.h>
 
 iBool isDark_GmDocumentTheme(enum iGmDocumentTheme d) {
     if (d == gray_GmDocumentTheme || d == oceanic_GmDocumentTheme || d == sepia_GmDocumentTheme) {
@@ -73,8 +74,6 @@ void deinit_GmLink(iGmLink *d) {
     deinit_String(&d->url);
 }
 
-iDefineTypeConstruction(GmLink)
-
 /*----------------------------------------------------------------------------------------------*/
 
 iDeclareType(GmTheme)
@@ -85,6 +84,29 @@ struct Impl_GmTheme {
     int fonts[max_GmLineType];
 };
 
+/* Progress of an incomplete layout. Only a part of the document is laid out up front
+   (viewport first), and the rest is continued later where this left off. */
+iDeclareType(GmLayoutState)
+
+struct Impl_GmLayoutState {
+    iRangecc         contentLine; /* last line that was laid out */
+    iInt2            pos;
+    iBool            isFirstText;
+    iBool            addQuoteIcon;
+    iBool            isPreformat;
+    int              preFont;
+    uint16_t         preId;
+    iBool            enableIndents;
+    enum iGmLineType prevType;
+    enum iGmLineType prevNonBlankType;
+    iBool            followsBlank;
+    iString          firstContentLine; /* may be used as a title if one isn't specified */
+    iArray           oldPreMeta;       /* remember fold states */
+    size_t           numLines;         /* total in the source, for estimating the height */
+    size_t           numLinesDone;
+    const char *     countedUntil;
+};
+
 static uint32_t themeHash_(const iBlock *data) {
     /* This is equivalent to a regular CRC-32, but the initial value is zero and the result
        is not inverted. GmDocument originally used a broken implementation of the CRC-32
@@ -159,15 +181,19 @@ struct Impl_GmDocument {
     enum iSourceFormat viewFormat; /* what the user prefers to see */
     enum iSourceFormat format;
     iString   origSource; /* original (unnormalized) source */
-    iString   source;     /* normalized (possibly converted) source */
+    iString   source;     /* normalized (possibly converted) source; shares `origSource` if unchanged */
     iString   url;        /* for resolving relative links */
     iString   localHost;
     iInt2     size;
     int       contentWidth; /* some runs may extend past the requested width */
     int       outsideMargin;
     iArray    layout; /* contents of source, laid out in document space */
-    iStringArray auxText; /* generated text that appears on the page but is not part of the source */
-    iPtrArray links;
+    iArray    runBottoms; /* int; running maximum of run visual bottoms, for finding visible runs */
+    iPtrArray auxText; /* iBlock; arena of generated text that appears on the page but is not part of the source */
+    size_t    auxTextBlock; /* current block in `auxText` */
+    size_t    auxTextPos;   /* next free byte in the current block */
+    iPtrArray links; /* points to slots in `linkBlocks` */
+    iPtrArray linkBlocks; /* arena of iGmLink slots, kept over relayouts for reuse */
     iString   title; /* the first top-level title */
     iArray    headings;
     iArray    preMeta; /* metadata about preformatted blocks */
@@ -175,9 +201,14 @@ struct Impl_GmDocument {
     uint32_t  themeSeed;
     iChar     siteIcon;
     iMedia *  media;
+    iBlock *  hibernated; /* compressed `origSource` while hibernating, otherwise NULL */
     iStringSet *openURLs; /* currently open URLs for highlighting links */
+    iString   findQuery;   /* query whose matches are in `findMatches` */
+    iArray    findMatches; /* iRangecc; all case-insensitive matches in `source`, in order */
     int       warnings;
     iColor    palette[tmMax_ColorId]; /* copy of the color palette */
+    iGmLayoutState *layoutState; /* non-NULL while the layout is incomplete */
+    int       layoutMinY; /* lazy layout covers at least this much (bottom of the viewport) */
     struct {
         iBool enableCommandLinks : 1; /* `about:command?` only allowed on selected pages */
         iBool isSpartan : 1;
@@ -186,6 +217,7 @@ struct Impl_GmDocument {
         iBool isPaletteValid : 1;
         iBool isGopherMenu : 1;
         iBool isConvertedMarkdown : 1;
+        iBool isLazyLayout : 1;
     } flags;
 };
 
@@ -353,6 +385,68 @@ static iBool isAllowedLinkIcon_Char_(iChar icon) {
            (icon >= 0x1f191 && icon <= 0x1f19a) /* enclosed signs */;
 }
 
+enum iGmDocumentArenaSizes {
+    linkBlockSize_GmDocument_    = 256,  /* links per block */
+    auxTextBlockSize_GmDocument_ = 4096, /* bytes per block */
+};
+
+static iGmLink *newLink_GmDocument_(iGmDocument *d) {
+    /* Returns the next free slot. It becomes used when added to `links`. */
+    const size_t index = size_PtrArray(&d->links);
+    if (index / linkBlockSize_GmDocument_ == size_PtrArray(&d->linkBlocks)) {
+        iGmLink *block = malloc(sizeof(iGmLink) * linkBlockSize_GmDocument_);
+        for (size_t i = 0; i < linkBlockSize_GmDocument_; i++) {
+            init_GmLink(&block[i]);
+        }
+        pushBack_PtrArray(&d->linkBlocks, block);
+    }
+    iGmLink *link = (iGmLink *) at_PtrArray(&d->linkBlocks, index / linkBlockSize_GmDocument_) +
+                    index % linkBlockSize_GmDocument_;
+    /* The URL string keeps its buffer. */
+    link->urlRange   = iNullRange;
+    link->labelRange = iNullRange;
+    link->labelIcon  = iNullRange;
+    iZap(link->when);
+    link->flags = 0;
+    return link;
+}
+
+static void setUrl_GmLink_(iGmLink *d, const iString *baseUrl) {
+    setRange_String(&d->url, d->urlRange);
+    const iString *canon = canonicalUrl_String(absoluteUrl_String(baseUrl, &d->url));
+    if (canon != &d->url) {
+        /* Copied so the existing buffer gets reused. */
+        setRange_String(&d->url, range_String(canon));
+    }
+}
+
+static iRangecc addAuxText_GmDocument_(iGmDocument *d, iRangecc text) {
+    /* Generated text is copied to the arena, where it stays put until the next layout. */
+    const size_t len = size_Range(&text);
+    iBlock *block = d->auxTextBlock < size_PtrArray(&d->auxText)
+                        ? at_PtrArray(&d->auxText, d->auxTextBlock)
+                        : NULL;
+    if (block && d->auxTextPos + len > size_Block(block)) {
+        block = ++d->auxTextBlock < size_PtrArray(&d->auxText)
+                    ? at_PtrArray(&d->auxText, d->auxTextBlock)
+                    : NULL;
+        d->auxTextPos = 0;
+    }
+    if (!block) {
+        block = new_Block(iMax(auxTextBlockSize_GmDocument_, len));
+        pushBack_PtrArray(&d->auxText, block);
+        d->auxTextBlock = size_PtrArray(&d->auxText) - 1;
+        d->auxTextPos   = 0;
+    }
+    else if (len > size_Block(block)) {
+        resize_Block(block, len); /* nothing in this block is in use yet */
+    }
+    char *dst = (char *) data_Block(block) + d->auxTextPos;
+    memcpy(dst, text.start, len);
+    d->auxTextPos += len;
+    return (iRangecc){ dst, dst + len };
+}
+
 static iRangecc addLink_GmDocument_(iGmDocument *d, iRangecc line, iGmLinkId *linkId) {
     /* Returns the human-readable label of the link. */
     static iRegExp *pattern_;
@@ -368,21 +462,19 @@ static iRangecc addLink_GmDocument_(iGmDocument *d, iRangecc line, iGmLinkId *li
     iRegExpMatch m;
     init_RegExpMatch(&m);
     if (d->flags.isSpartan && matchRange_RegExp(spartanQueryPattern_, line, &m)) {
-        link = new_GmLink();
+        link = newLink_GmDocument_(d);
         link->urlRange = capturedRange_RegExpMatch(&m, 1);
         link->flags = query_GmLinkFlag;
         setScheme_GmLink_(link, spartan_GmLinkScheme);
-        setRange_String(&link->url, link->urlRange);
-        set_String(&link->url, canonicalUrl_String(absoluteUrl_String(&d->url, &link->url)));
+        setUrl_GmLink_(link, &d->url);
     }
     if (!link) {
         init_RegExpMatch(&m);
     }
     if (!link && matchRange_RegExp(pattern_, line, &m)) {
-        link = new_GmLink();
+        link = newLink_GmDocument_(d);
         link->urlRange = capturedRange_RegExpMatch(&m, 1);
-        setRange_String(&link->url, link->urlRange);
-        set_String(&link->url, canonicalUrl_String(absoluteUrl_String(&d->url, &link->url)));
+        setUrl_GmLink_(link, &d->url);
         if (d->flags.isNex) {
             link->flags |= inline_GmLinkFlag;
         }
@@ -392,8 +484,7 @@ static iRangecc addLink_GmDocument_(iGmDocument *d, iRangecc line, iGmLinkId *li
             (startsWithCase_String(&link->url, "about:command")
              /* this is a special internal page that allows submitting UI events */
              && !d->flags.enableCommandLinks)) {
-            delete_GmLink(link);
-            return line;
+            return line; /* the slot remains free */
         }
         /* Check the URL. */ {
             iUrl parts;
@@ -552,12 +643,32 @@ static iRangecc addLink_GmDocument_(iGmDocument *d, iRangecc line, iGmLinkId *li
 }
 
 static void clearLinks_GmDocument_(iGmDocument *d) {
-    iForEach(PtrArray, i, &d->links) {
-        delete_GmLink(i.ptr);
-    }
+    /* The slots are kept for the next layout. */
     clear_PtrArray(&d->links);
 }
 
+static void clearAuxText_GmDocument_(iGmDocument *d) {
+    d->auxTextBlock = 0;
+    d->auxTextPos   = 0;
+}
+
+static void releaseArenas_GmDocument_(iGmDocument *d) {
+    clearLinks_GmDocument_(d);
+    iForEach(PtrArray, i, &d->linkBlocks) {
+        iGmLink *block = i.ptr;
+        for (size_t j = 0; j < linkBlockSize_GmDocument_; j++) {
+            deinit_GmLink(&block[j]);
+        }
+        free(block);
+    }
+    clear_PtrArray(&d->linkBlocks);
+    iForEach(PtrArray, j, &d->auxText) {
+        delete_Block(j.ptr);
+    }
+    clear_PtrArray(&d->auxText);
+    clearAuxText_GmDocument_(d);
+}
+
 static iBool isGopher_GmDocument_(const iGmDocument *d) {
     const iRangecc scheme = urlScheme_String(&d->url);
     return (equalCase_Rangecc(scheme, "gopher") ||
@@ -595,13 +706,19 @@ static enum iGmDocumentTheme currentTheme_(void) {
     return docTheme_Prefs(prefs_App());
 }
 
+static void setVisualOnly_GmRun_(iGmRun *d, iRect visBounds) {
+    /* Not used for hit testing, but placed where it is drawn to keep the deltas small. */
+    d->bounds = (iRect){ visBounds.pos, zero_I2() };
+    setVisBounds_GmRun(d, visBounds);
+}
+
 static void alignDecoration_GmRun_(iGmRun *run, iBool isCentered) {
     const iRect visBounds = visualBounds_Text(run->font, run->text);
     const int   visWidth  = width_Rect(visBounds);
     int         xAdjust   = 0;
     if (!isCentered) {
         /* Keep the icon aligned to the left edge. */
-        const int alignWidth = width_Rect(run->visBounds) * 4 / 5;
+        const int alignWidth = width_Rect(visBounds_GmRun(run)) * 4 / 5;
         xAdjust -= left_Rect(visBounds);
         if (visWidth > alignWidth) {
             /* ...unless it's a wide icon, in which case move it to the left. */
@@ -614,10 +731,12 @@ static void alignDecoration_GmRun_(iGmRun *run, iBool isCentered) {
     }
     else {
         /* Centered. */
-        xAdjust += (width_Rect(run->visBounds) - visWidth) / 2;
+        xAdjust += (width_Rect(visBounds_GmRun(run)) - visWidth) / 2;
     }
-    run->visBounds.pos.x  += xAdjust;
-    run->visBounds.size.x -= xAdjust;
+    iRect runVis = visBounds_GmRun(run);
+    runVis.pos.x  += xAdjust;
+    runVis.size.x -= xAdjust;
+    setVisBounds_GmRun(run, runVis);
 }
 
 static void updateOpenURLs_GmDocument_(iGmDocument *d) {
@@ -661,7 +780,7 @@ static size_t commit_RunTypesetter_(iRunTypesetter *d, iGmDocument *doc) {
     /* Update the actual content width of the document. This may exceed the page width
        if there are unwrappable lines. */
     for (size_t i = 0; i < size_Array(&d->layout); i++) {
-        doc->contentWidth = iMax(value_Array(&d->layout, i, iGmRun).visBounds.size.x,
+        doc->contentWidth = iMax(visBounds_GmRun(constAt_Array(&d->layout, i)).size.x,
                                  doc->contentWidth);
     }
     pushBackN_Array(&doc->layout, constData_Array(&d->layout), size_Array(&d->layout));
@@ -670,6 +789,7 @@ static size_t commit_RunTypesetter_(iRunTypesetter *d, iGmDocument *doc) {
 }
 
 static const int maxLedeLines_ = 10;
+static const size_t lazyLayoutMinLines_ = 1000;
 
 static void applyAttributes_RunTypesetter_(iRunTypesetter *d, iTextAttrib attrib) {
     /* WARNING: This is duplicated in run_Font_(). Make sure they behave identically. */
@@ -717,8 +837,7 @@ static iBool typesetOneLine_RunTypesetter_(iWrapText *wrap, iRangecc wrapRange,
     iChangeFlags(d->run.flags, wide_GmRunFlag, (d->isPreformat && dims.x > d->layoutWidth));
     d->run.bounds.size.x    = iMax(wrap->maxWidth, dims.x) - origin; /* Extends to the right edge for selection. */
     d->run.bounds.size.y    = dims.y;
-    d->run.visBounds        = d->run.bounds;
-    d->run.visBounds.size.x = dims.x;
+    setVisBounds_GmRun(&d->run, (iRect){ d->run.bounds.pos, dims });
     d->run.isRTL            = attrib.isBaseRTL;
 //    printf("origin:%d isRTL:%d\n{%s}\n", origin, attrib.isBaseRTL, cstr_Rangecc(wrapRange));
     pushBack_Array(&d->layout, &d->run);
@@ -742,12 +861,112 @@ static iBool isHRule_(iRangecc line) {
     return n >= 3;
 }
 
-static void doLayout_GmDocument_(iGmDocument *d) {
+static size_t countLines_(iRangecc range) {
+    size_t n = 0;
+    for (const char *ch = range.start;
+         (ch = memchr(ch, '\n', range.end - ch)) != NULL; ch++) {
+        n++;
+    }
+    return n;
+}
+
+static void deleteLayoutState_GmDocument_(iGmDocument *d) {
+    if (d->layoutState) {
+        deinit_String(&d->layoutState->firstContentLine);
+        deinit_Array(&d->layoutState->oldPreMeta);
+        free(d->layoutState);
+        d->layoutState = NULL;
+    }
+}
+
+static void markWidePreformatted_GmDocument_(iGmDocument *d, size_t firstRun) {
+    /* Go over the preformatted blocks and mark them wide if at least one run is wide. */
+    for (size_t i = firstRun; i < size_Array(&d->layout); i++) {
+        iGmRun *run = at_Array(&d->layout, i);
+        if (preId_GmRun(run) && run->flags & wide_GmRunFlag) {
+            iGmPreMeta *meta = at_Array(&d->preMeta, preId_GmRun(run) - 1);
+            meta->runRange = findPreformattedRange_GmDocument(d, run);
+            for (const iGmRun *j = meta->runRange.start; j != meta->runRange.end; j++) {
+                iGmRun *jRun = iConstCast(iGmRun *, j);
+                jRun->flags |= wide_GmRunFlag;
+                iChangeFlags(jRun->flags, startOfLine_GmRunFlag, j == meta->runRange.start);
+                iChangeFlags(jRun->flags, endOfLine_GmRunFlag, j + 1 == meta->runRange.end);
+            }
+            /* Skip to the end of the block. */
+            i = meta->runRange.end - (const iGmRun *) constData_Array(&d->layout) - 1;
+        }
+    }
+}
+
+static void beginLayout_GmDocument_(iGmDocument *d) {
+    deleteLayoutState_GmDocument_(d);
+    if (d->hibernated) {
+        d->flags.isLayoutInvalidated = iTrue; /* will be laid out when woken up */
+        return;
+    }
+    const iPrefs *prefs    = prefs_App();
+    const iBool   isMono   = isForcedMonospace_GmDocument_(d);
+    const iBool   isGopher = isGopher_GmDocument_(d);
+    initTheme_GmDocument_(d);
+    d->flags.isLayoutInvalidated = iFalse;
+    iGmLayoutState *st = iMalloc(GmLayoutState);
+    initCopy_Array(&st->oldPreMeta, &d->preMeta);
+    clear_Array(&d->layout);
+    clear_Array(&d->runBottoms);
+    clearAuxText_GmDocument_(d);
+    clearLinks_GmDocument_(d);
+    clear_Array(&d->headings);
+    clear_Array(&d->preMeta);
+    clear_String(&d->title);
+    d->contentWidth = 0;
+    if (d->size.x <= 0 || isEmpty_String(&d->source)) {
+        deinit_Array(&st->oldPreMeta);
+        free(st);
+        return;
+    }
+    updateOpenURLs_GmDocument_(d);
+    const iRangecc content = range_String(&d->source);
+    d->layoutState       = st;
+    st->contentLine      = iNullRange;
+    st->pos              = zero_I2();
+    st->isFirstText      = prefs->bigFirstParagraph && !isMono && !isTerminal_Platform();
+    st->addQuoteIcon     = prefs->quoteIcon;
+    st->isPreformat      = iFalse;
+    st->preFont          = preformatted_FontId;
+    st->preId            = 0;
+    st->enableIndents    = iFalse;
+    st->prevType         = text_GmLineType;
+    st->prevNonBlankType = undefined_GmLineType;
+    st->followsBlank     = iFalse;
+    init_String(&st->firstContentLine);
+    st->numLines         = countLines_(content) + 1;
+    st->numLinesDone     = 0;
+    st->countedUntil     = content.start;
+    if (isGopher && !prefs->geminiStyledGopher) {
+        st->isFirstText = iFalse;
+    }
+    if (d->format == plainText_SourceFormat) {
+        st->isPreformat = iTrue;
+        st->isFirstText = iFalse;
+    }
+    d->warnings &= ~missingGlyphs_GmDocumentWarning;
+}
+
+static iBool continueLayout_GmDocument_(iGmDocument *d, int untilY, const char *untilLoc,
+                                        double seconds) {
+    /* Lays out lines until the layout reaches `untilY` and `untilLoc`, or until `seconds`
+       have passed (if positive). Returns True if the existing runs were reallocated. */
+    iTrace("continueLayout_GmDocument");
     static iRegExp *ansiPattern_;
+    iGmLayoutState *st = d->layoutState;
+    if (!st) {
+        return iFalse;
+    }
     if (!ansiPattern_) {
         ansiPattern_ = makeAnsiEscapePattern_Text(iTrue /* with ESC */);
     }
-
+    iTime startTime;
+    initCurrent_Time(&startTime);
     const iPrefs *prefs             = prefs_App();
     const iBool   isMono            = isForcedMonospace_GmDocument_(d);
     const iBool   isGopher          = isGopher_GmDocument_(d);
@@ -756,8 +975,6 @@ static void doLayout_GmDocument_(iGmDocument *d) {
     const iBool   isExtremelyNarrow = d->size.x <= 60 * gap_Text * aspect_UI;
     const iBool   isFullWidthImages = (d->outsideMargin < 5 * gap_UI * aspect_UI);
 
-    initTheme_GmDocument_(d);
-    d->flags.isLayoutInvalidated = iFalse;
     /* TODO: Collect these parameters into a GmTheme. */
     float indents[max_GmLineType] = { 5, 10, 5, isNarrow ? 5 : 10, 0, 0, 5, 5 };
     if (isExtremelyNarrow) {
@@ -791,45 +1008,38 @@ static void doLayout_GmDocument_(iGmDocument *d) {
     static const char *pointingFinger  = "\U0001f449";
     static const char *uploadArrow     = upload_Icon;
     static const char *image           = photo_Icon;
-    clear_Array(&d->layout);
-    clear_StringArray(&d->auxText);
-    clearLinks_GmDocument_(d);
-    clear_Array(&d->headings);
-    const iArray *oldPreMeta = collect_Array(copy_Array(&d->preMeta)); /* remember fold states */
-    clear_Array(&d->preMeta);
-    clear_String(&d->title);
-    d->contentWidth = 0;
-    if (d->size.x <= 0 || isEmpty_String(&d->source)) {
-        return;
-    }
-    updateOpenURLs_GmDocument_(d);
     const iRangecc   content       = range_String(&d->source);
-    iRangecc         contentLine   = iNullRange;
-    iInt2            pos           = zero_I2();
-    iBool            isFirstText   = prefs->bigFirstParagraph && !isMono && !isTerminal_Platform();
-    iBool            addQuoteIcon  = prefs->quoteIcon;
-    iBool            isPreformat   = iFalse;
-    int              preFont       = preformatted_FontId;
-    uint16_t         preId         = 0;
-    iBool            enableIndents = iFalse;
+    iRangecc         contentLine   = st->contentLine;
+    iInt2            pos           = st->pos;
+    iBool            isFirstText   = st->isFirstText;
+    iBool            addQuoteIcon  = st->addQuoteIcon;
+    iBool            isPreformat   = st->isPreformat;
+    int              preFont       = st->preFont;
+    uint16_t         preId         = st->preId;
+    iBool            enableIndents = st->enableIndents;
     const iBool      isNormalized  = shouldBeNormalized_GmDocument_(d);
     const iBool      isJustified   = prefs->justifyParagraph;
-    enum iGmLineType prevType      = text_GmLineType;
-    enum iGmLineType prevNonBlankType = undefined_GmLineType;
-    iBool            followsBlank  = iFalse;
-    iString          firstContentLine; /* may be used as a title if one isn't specified */
-    init_String(&firstContentLine);
-    if (isGopher && !prefs->geminiStyledGopher) {
-        isFirstText = iFalse;
-    }
-    if (d->format == plainText_SourceFormat) {
-        isPreformat = iTrue;
-        isFirstText = iFalse;
-    }
-    d->warnings &= ~missingGlyphs_GmDocumentWarning;
+    enum iGmLineType prevType      = st->prevType;
+    enum iGmLineType prevNonBlankType = st->prevNonBlankType;
+    iBool            followsBlank  = st->followsBlank;
+    const iArray *   oldPreMeta    = &st->oldPreMeta;
+    const size_t     firstNewRun   = size_Array(&d->layout);
+    const void *     oldRuns       = constData_Array(&d->layout);
+    iBool            isPaused      = iFalse;
     checkMissing_Text(); /* clear the flag */
     setAnsiFlags_Text(d->theme.ansiEscapes);
-    while (nextSplit_Rangecc(content, "\n", &contentLine)) {
+    for (;;) {
+        /* Layout can be paused between lines, but not inside preformatted blocks. */
+        if (!isPreformat || d->format == plainText_SourceFormat) {
+            if ((pos.y >= untilY && (!untilLoc || contentLine.end >= untilLoc)) ||
+                (seconds > 0 && elapsedSeconds_Time(&startTime) >= seconds)) {
+                isPaused = iTrue;
+                break;
+            }
+        }
+        if (!nextSplit_Rangecc(content, "\n", &contentLine)) {
+            break;
+        }
         iRangecc line = contentLine; /* `line` will be trimmed; modifying would confuse `nextSplit_Rangecc` */
         if (*line.end == '\r') {
             line.end--; /* trim CR always */
@@ -861,9 +1071,10 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                     iGmRun hrule = run;
                     const int leftIndent = (isVeryNarrow ? 0 : 5) * gap_Text;
                     const int rightIndent = leftIndent + (isJustified ? -1 : 0) * gap_Text;
-                    hrule.visBounds.pos  = add_I2(pos, init_I2(leftIndent, gap_Text * aspect_UI));
-                    hrule.visBounds.size = init_I2(d->size.x - leftIndent - rightIndent, 0);
-                    hrule.bounds         = zero_Rect(); /* just visual */
+                    setVisualOnly_GmRun_(
+                        &hrule,
+                        (iRect){ add_I2(pos, init_I2(leftIndent, gap_Text * aspect_UI)),
+                                 init_I2(d->size.x - leftIndent - rightIndent, 0) });
                     hrule.text           = iNullRange;
                     hrule.flags          = ruler_GmRunFlag | decoration_GmRunFlag;
                     pushBack_Array(&d->layout, &hrule);
@@ -942,15 +1153,15 @@ static void doLayout_GmDocument_(iGmDocument *d) {
             if (type == preformatted_GmLineType) {
                 /* Empty lines in a preformatted blocks should functionally be part of the block. */
                 run.bounds = (iRect){ pos, init_I2(1, lineHeight_Text(run.font)) };
-                run.visBounds = run.bounds;
+                setVisBounds_GmRun(&run, run.bounds);
                 run.text = line;
                 pushBack_Array(&d->layout, &run);
             }
             else if (type == quote_GmLineType && !prefs->quoteIcon) {
                 /* For quote indicators we still need to produce a run. */
-                run.visBounds.pos  = addX_I2(pos, indents[type] * gap_Text);
-                run.visBounds.size = init_I2(lineHeight_Text(run.font), lineHeight_Text(run.font));
-                run.bounds         = zero_Rect(); /* just visual */
+                setVisualOnly_GmRun_(&run,
+                                     (iRect){ addX_I2(pos, indents[type] * gap_Text),
+                                              init1_I2(lineHeight_Text(run.font)) });
                 run.text           = iNullRange;
                 run.flags          = ruler_GmRunFlag | decoration_GmRunFlag;
                 pushBack_Array(&d->layout, &run);
@@ -1008,8 +1219,8 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                                              : meta->altText;
                 iInt2 size = measureWrapRange_Text(altText.font, d->size.x - 2 * margin.x,
                                                    altText.text).bounds.size;
-                altText.bounds = altText.visBounds = init_Rect(pos.x, pos.y, d->size.x,
-                                                               size.y + 2 * margin.y);
+                altText.bounds = init_Rect(pos.x, pos.y, d->size.x, size.y + 2 * margin.y);
+                setVisBounds_GmRun(&altText, altText.bounds);
                 altText.mediaType = max_MediaType; /* preformatted */
                 altText.mediaId = preId;
                 pushBack_Array(&d->layout, &altText);
@@ -1027,22 +1238,22 @@ static void doLayout_GmDocument_(iGmDocument *d) {
             replaceRegExp_String(&d->title, ansiPattern_, "", NULL, NULL);
         }
         else if (type != preformatted_GmLineType && type != heading1_GmLineType &&
-                 isEmpty_String(&firstContentLine) && size_Range(&line) >= 3) {
-            setRange_String(&firstContentLine, line);
-            replaceRegExp_String(&firstContentLine, ansiPattern_, "", NULL, NULL);
+                 isEmpty_String(&st->firstContentLine) && size_Range(&line) >= 3) {
+            setRange_String(&st->firstContentLine, line);
+            replaceRegExp_String(&st->firstContentLine, ansiPattern_, "", NULL, NULL);
         }
         /* List bullet. */
         if (type == bullet_GmLineType) {
             /* TODO: Literata bullet is broken? */
             iGmRun bulRun = run;
             bulRun.color = tmQuote_ColorId;
-            bulRun.visBounds.pos = addX_I2(
-                pos, (indents[text_GmLineType] - (isTerminal_Platform() ? 0.0f : 0.55f)) * gap_Text);
-            bulRun.visBounds.size =
-                init_I2((indents[bullet_GmLineType] - indents[text_GmLineType]) * gap_Text,
-                        lineHeight_Text(bulRun.font));
-            //            bulRun.visBounds.pos.x -= 4 * gap_Text - width_Rect(bulRun.visBounds) / 2;
-            bulRun.bounds = zero_Rect(); /* just visual */
+            setVisualOnly_GmRun_(
+                &bulRun,
+                (iRect){ addX_I2(pos,
+                                 (indents[text_GmLineType] -
+                                  (isTerminal_Platform() ? 0.0f : 0.55f)) * gap_Text),
+                         init_I2((indents[bullet_GmLineType] - indents[text_GmLineType]) * gap_Text,
+                                 lineHeight_Text(bulRun.font)) });
             bulRun.text   = range_CStr(bullet);
             bulRun.flags |= decoration_GmRunFlag;
             alignDecoration_GmRun_(&bulRun, iTrue);
@@ -1056,14 +1267,14 @@ static void doLayout_GmDocument_(iGmDocument *d) {
             quoteRun.text   = range_CStr(quote);
             quoteRun.color  = tmQuoteIcon_ColorId;
             iRect vis       = visualBounds_Text(quoteRun.font, quoteRun.text);
-            quoteRun.visBounds.size = measure_Text(quoteRun.font, quote).bounds.size;
-            quoteRun.visBounds.pos =
-                add_I2(pos,
-                       init_I2((indents[quote_GmLineType] - 5 * aspect_UI) * gap_Text,
-                               !isTerminal_Platform()
-                                   ? (lineHeight_Text(quote_FontId) / 2 - bottom_Rect(vis))
-                                   : 0));
-            quoteRun.bounds = zero_Rect(); /* just visual */
+            setVisualOnly_GmRun_(
+                &quoteRun,
+                (iRect){ add_I2(pos,
+                                init_I2((indents[quote_GmLineType] - 5 * aspect_UI) * gap_Text,
+                                        !isTerminal_Platform()
+                                            ? (lineHeight_Text(quote_FontId) / 2 - bottom_Rect(vis))
+                                            : 0)),
+                         measure_Text(quoteRun.font, quote).bounds.size });
             quoteRun.flags |= decoration_GmRunFlag;
             if (isTerminal_Platform()) {
                 quoteRun.font = paragraph_FontId;
@@ -1076,9 +1287,8 @@ static void doLayout_GmDocument_(iGmDocument *d) {
         /* Link icon. */
         if (type == link_GmLineType) {
             iGmRun icon = run;
-            icon.visBounds.pos  = pos;
-            icon.visBounds.size = init_I2(indent * gap_Text, lineHeight_Text(run.font));
-            icon.bounds         = zero_Rect(); /* just visual */
+            setVisualOnly_GmRun_(
+                &icon, (iRect){ pos, init_I2(indent * gap_Text, lineHeight_Text(run.font)) });
             iGmLink *link = at_PtrArray(&d->links, run.linkId - 1);
             const enum iGmLinkScheme scheme = scheme_GmLinkFlag(link->flags);
             icon.text           = range_CStr(link->flags & query_GmLinkFlag    ? (d->flags.isSpartan ? upload_Icon : magnifyingGlass)
@@ -1099,10 +1309,12 @@ static void doLayout_GmDocument_(iGmDocument *d) {
             /* Check actual height to align with the paragraph text. The icon glyph
                may come from a different font. */ {
                 const int glyphHeight = measureRange_Text(icon.font, icon.text).bounds.size.y;
-                if (glyphHeight > icon.visBounds.size.y) {
-                    const int delta = glyphHeight - icon.visBounds.size.y;
-                    icon.visBounds.size.y += delta;
-                    icon.visBounds.pos.y -= delta / 2;
+                iRect     iconVis     = visBounds_GmRun(&icon);
+                if (glyphHeight > iconVis.size.y) {
+                    const int delta = glyphHeight - iconVis.size.y;
+                    iconVis.size.y += delta;
+                    iconVis.pos.y -= delta / 2;
+                    setVisBounds_GmRun(&icon, iconVis);
                 }
             }
             /* Custom link icon is shown on local Gemini links only. */
@@ -1120,8 +1332,9 @@ static void doLayout_GmDocument_(iGmDocument *d) {
             else {
                 /* Nex directory link "icons" are actually the => arrows that appear in
                    the source text. */
-                icon.visBounds.size.x = indent * gap_Text; // measureRange_Text(icon.font, icon.text).bounds.size;
-                icon.bounds = icon.visBounds;
+                icon.bounds = visBounds_GmRun(&icon);
+                icon.bounds.size.x = indent * gap_Text; // measureRange_Text(icon.font, icon.text).bounds.size;
+                setVisBounds_GmRun(&icon, icon.bounds);
                 //icon.flags &= ~decoration_GmRunFlag;
                 //icon.linkId = run.linkId;
             }
@@ -1219,18 +1432,18 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                         iForEach(Array, pr, &rts.layout) {
                             iGmRun *prun = pr.value;
                             const int offset = rts.rightMargin - rts.indent;
-                            prun->bounds.pos.x    += offset;
-                            prun->visBounds.pos.x += offset;
+                            prun->bounds.pos.x += offset; /* visual bounds are relative */
                         }
                         if (type == bullet_GmLineType || type == link_GmLineType ||
                             (type == quote_GmLineType && prefs->quoteIcon)) {
                             iGmRun *decor = back_Array(&d->layout);
                             iAssert(decor->flags & decoration_GmRunFlag);
-                            decor->visBounds.pos.x = d->size.x - width_Rect(decor->visBounds) -
-                                                     decor->visBounds.pos.x +
-                                                     gap_Text * (type == bullet_GmLineType  ? 1.5f
-                                                                 : type == quote_GmLineType ? 0.0f
-                                                                                            : 1.0f);
+                            iRect decorVis = visBounds_GmRun(decor);
+                            decorVis.pos.x = d->size.x - width_Rect(decorVis) - decorVis.pos.x +
+                                             gap_Text * (type == bullet_GmLineType  ? 1.5f
+                                                         : type == quote_GmLineType ? 0.0f
+                                                                                    : 1.0f);
+                            setVisBounds_GmRun(decor, decorVis);
                         }
                     }
                     numRunsAdded = commit_RunTypesetter_(&rts, d);
@@ -1258,9 +1471,9 @@ static void doLayout_GmDocument_(iGmDocument *d) {
             if (!isEmpty_Range(&link->labelRange)) {
                 const iGmRun *lastRun = constBack_Array(&d->layout);
                 iGmRun label      = *lastRun;
-                label.bounds.pos  = topRight_Rect(lastRun->visBounds);
+                label.bounds.pos  = topRight_Rect(visBounds_GmRun(lastRun));
                 label.bounds.size = measureRange_Text(run.font, link->labelRange).bounds.size;
-                label.visBounds   = label.bounds;
+                setVisBounds_GmRun(&label, label.bounds);
                 label.text        = link->labelRange;
                 label.lineType    = text_GmLineType;
                 label.linkId      = 0;
@@ -1311,19 +1524,19 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                         run.bounds.size.y += d->outsideMargin * 2 * aspect;
                         run.bounds.pos.x  -= d->outsideMargin;
                     }
-                    run.visBounds = run.bounds;
+                    iRect imageVis = run.bounds;
                     /// XXX: Don't use window pixel ratio, use the UI scaling factor on Window.s
                     const iInt2 maxSize = mulf_I2(
                         imgSize,
                         gap_UI / 2 * prefs_App()->zoomPercent / 100.0f);
-                    if (width_Rect(run.visBounds) > maxSize.x) {
+                    if (width_Rect(imageVis) > maxSize.x) {
                         /* Don't scale the image up too much. */
-                        run.visBounds.size.y =
-                            run.visBounds.size.y * maxSize.x / width_Rect(run.visBounds);
-                        run.visBounds.size.x = maxSize.x;
-                        run.visBounds.pos.x  = run.bounds.size.x / 2 - width_Rect(run.visBounds) / 2;
-                        run.bounds.size.y    = run.visBounds.size.y;
+                        imageVis.size.y = imageVis.size.y * maxSize.x / width_Rect(imageVis);
+                        imageVis.size.x = maxSize.x;
+                        imageVis.pos.x  = run.bounds.size.x / 2 - width_Rect(imageVis) / 2;
+                        run.bounds.size.y = imageVis.size.y;
                     }
+                    setVisBounds_GmRun(&run, imageVis);
                     pushBack_Array(&d->layout, &run);
                     pos.y += run.bounds.size.y + margin / 2;
                     /* Image metadata caption */
@@ -1333,9 +1546,6 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                         run.flags = decoration_GmRunFlag | caption_GmRunFlag;
                         run.mediaId = 0;
                         run.mediaType = 0;
-                        run.visBounds.pos.y = pos.y;
-                        run.visBounds.size.y = lineHeight_Text(run.font);
-                        run.bounds = zero_Rect();
                         iString caption;
                         init_String(&caption);
                         const iBool inMegabytes = info.numBytes >= 1000000;
@@ -1346,14 +1556,16 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                                       imgSize.y,
                                       info.numBytes / (inMegabytes ? 1.0e6f : 1.0e3f),
                                       inMegabytes ? cstr_Lang("mb") : cstr_Lang("kb"));
-                        pushBack_StringArray(&d->auxText, &caption);
-                        run.text = range_String(&caption);
+                        run.text = addAuxText_GmDocument_(d, range_String(&caption));
                         /* Center it. */
-                        run.visBounds.size.x = measureRange_Text(run.font, range_String(&caption)).bounds.size.x;
-                        run.visBounds.pos.x = d->size.x / 2 - run.visBounds.size.x / 2;
+                        iRect captionVis;
+                        captionVis.size = init_I2(measureRange_Text(run.font, run.text).bounds.size.x,
+                                                  lineHeight_Text(run.font));
+                        captionVis.pos  = init_I2(d->size.x / 2 - captionVis.size.x / 2, pos.y);
+                        setVisualOnly_GmRun_(&run, captionVis);
                         deinit_String(&caption);
                         pushBack_Array(&d->layout, &run);
-                        pos.y += run.visBounds.size.y + margin;
+                        pos.y += captionVis.size.y + margin;
                     }
                     break;
                 }
@@ -1361,7 +1573,7 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                     run.bounds.pos    = pos;
                     run.bounds.size.x = d->size.x;
                     run.bounds.size.y = lineHeight_Text(uiContent_FontId) + 3 * gap_UI;
-                    run.visBounds     = run.bounds;
+                    setVisBounds_GmRun(&run, run.bounds);
                     pushBack_Array(&d->layout, &run);
                     break;
                 }
@@ -1369,7 +1581,7 @@ static void doLayout_GmDocument_(iGmDocument *d) {
                     run.bounds.pos    = pos;
                     run.bounds.size.x = d->size.x;
                     run.bounds.size.y = 2 * lineHeight_Text(uiContent_FontId) + 4 * gap_UI;
-                    run.visBounds     = run.bounds;
+                    setVisBounds_GmRun(&run, run.bounds);
                     pushBack_Array(&d->layout, &run);
                     break;
                 }
@@ -1384,32 +1596,42 @@ static void doLayout_GmDocument_(iGmDocument *d) {
         prevNonBlankType = type;
         followsBlank = iFalse;
     }
-    d->size.y = pos.y;
-    d->contentWidth += indents[text_GmLineType] * gap_Text; /* indent not included in run widths */
+    const iBool isReallocated = firstNewRun > 0 && oldRuns != constData_Array(&d->layout);
     if (checkMissing_Text()) {
         d->warnings |= missingGlyphs_GmDocumentWarning;
     }
-    /* Go over the preformatted blocks and mark them wide if at least one run is wide. */ {
-        iForEach(Array, i, &d->layout) {
-            iGmRun *run = i.value;
-            if (preId_GmRun(run) && run->flags & wide_GmRunFlag) {
-                iGmPreMeta *meta = at_Array(&d->preMeta, preId_GmRun(run) - 1);
-                meta->runRange = findPreformattedRange_GmDocument(d, run);
-                for (const iGmRun *j = meta->runRange.start; j != meta->runRange.end; j++) {
-                    iGmRun *jRun = iConstCast(iGmRun *, j);
-                    jRun->flags |= wide_GmRunFlag;
-                    iChangeFlags(jRun->flags, startOfLine_GmRunFlag, j == meta->runRange.start);
-                    iChangeFlags(jRun->flags, endOfLine_GmRunFlag, j + 1 == meta->runRange.end);
-                }
-                /* Skip to the end of the block. */
-                i.pos = meta->runRange.end - (const iGmRun *) constData_Array(&d->layout) - 1;
-            }
-        }
-    }
+    /* Earlier blocks need their run ranges updated if the runs were moved. */
+    markWidePreformatted_GmDocument_(d, isReallocated ? 0 : firstNewRun);
     setAnsiFlags_Text(allowAll_AnsiFlag);
+    if (isPaused) {
+        st->contentLine      = contentLine;
+        st->pos              = pos;
+        st->isFirstText      = isFirstText;
+        st->addQuoteIcon     = addQuoteIcon;
+        st->isPreformat      = isPreformat;
+        st->preFont          = preFont;
+        st->preId            = preId;
+        st->enableIndents    = enableIndents;
+        st->prevType         = prevType;
+        st->prevNonBlankType = prevNonBlankType;
+        st->followsBlank     = followsBlank;
+        /* Estimate the height of the rest of the document based on the lines so far. */
+        if (contentLine.end > st->countedUntil) {
+            st->numLinesDone += countLines_((iRangecc){ st->countedUntil, contentLine.end });
+            st->countedUntil = contentLine.end;
+        }
+        d->size.y = pos.y;
+        if (st->numLinesDone > 0) {
+            d->size.y += (int) ((float) pos.y / st->numLinesDone *
+                                (st->numLines - st->numLinesDone));
+        }
+        return isReallocated;
+    }
+    d->size.y = pos.y;
+    d->contentWidth += indents[text_GmLineType] * gap_Text; /* indent not included in run widths */
     /* If a title wasn't found, use the first content line but truncate it if it's long. */
     if (isEmpty_String(&d->title)) {
-        set_String(&d->title, &firstContentLine);
+        set_String(&d->title, &st->firstContentLine);
         if (length_String(&d->title) > 40) {
             truncate_String(&d->title, 40);
             /* Find a word boundary. */
@@ -1419,7 +1641,7 @@ static void doLayout_GmDocument_(iGmDocument *d) {
         }
         trim_String(&d->title);
     }
-    deinit_String(&firstContentLine);
+    deleteLayoutState_GmDocument_(d);
 #if  0
     printf("[GmDocument] layout size: %zu runs (%zu bytes), layout width: %d, content width: %d\n",
            size_Array(&d->layout),
@@ -1427,6 +1649,19 @@ static void doLayout_GmDocument_(iGmDocument *d) {
            d->size.x,
            d->contentWidth);
 #endif
+    return isReallocated;
+}
+
+static void doLayout_GmDocument_(iGmDocument *d) {
+    iTrace("doLayout_GmDocument");
+    beginLayout_GmDocument_(d);
+    if (d->layoutState) {
+        /* Long documents are laid out lazily: only the part that is needed for the viewport
+           is done now, and the rest is continued later. */
+        const iBool isLazy =
+            d->flags.isLazyLayout && d->layoutState->numLines >= lazyLayoutMinLines_;
+        continueLayout_GmDocument_(d, isLazy ? d->layoutMinY : INT_MAX, NULL, 0.0);
+    }
 }
 
 void init_GmDocument(iGmDocument *d) {
@@ -1440,34 +1675,50 @@ void init_GmDocument(iGmDocument *d) {
     d->outsideMargin = 0;
     d->size = zero_I2();
     init_Array(&d->layout, sizeof(iGmRun));
-    init_StringArray(&d->auxText);
+    init_Array(&d->runBottoms, sizeof(int));
+    init_PtrArray(&d->auxText);
+    d->auxTextBlock = 0;
+    d->auxTextPos = 0;
     init_PtrArray(&d->links);
+    init_PtrArray(&d->linkBlocks);
     init_String(&d->title);
     init_Array(&d->headings, sizeof(iGmHeading));
     init_Array(&d->preMeta, sizeof(iGmPreMeta));
     d->themeSeed = 0;
     d->siteIcon = 0;
     d->media = new_Media();
+    d->hibernated = NULL;
     d->openURLs = NULL;
+    init_String(&d->findQuery);
+    init_Array(&d->findMatches, sizeof(iRangecc));
     d->warnings = 0;
     iZap(d->palette);
+    d->layoutState = NULL;
+    d->layoutMinY = 0;
     d->flags.enableCommandLinks = iFalse;
     d->flags.isSpartan = iFalse;
     d->flags.isNex = iFalse;
     d->flags.isLayoutInvalidated = iFalse;
     d->flags.isPaletteValid = iFalse;
     d->flags.isConvertedMarkdown = iFalse;
+    d->flags.isLazyLayout = iFalse;
 }
 
 void deinit_GmDocument(iGmDocument *d) {
+    deleteLayoutState_GmDocument_(d);
+    deinit_Array(&d->findMatches);
+    deinit_String(&d->findQuery);
     iReleasePtr(&d->openURLs);
+    delete_Block(d->hibernated);
     delete_Media(d->media);
     deinit_String(&d->title);
-    clearLinks_GmDocument_(d);
+    releaseArenas_GmDocument_(d);
+    deinit_PtrArray(&d->linkBlocks);
     deinit_PtrArray(&d->links);
     deinit_Array(&d->preMeta);
     deinit_Array(&d->headings);
-    deinit_StringArray(&d->auxText);
+    deinit_PtrArray(&d->auxText);
+    deinit_Array(&d->runBottoms);
     deinit_Array(&d->layout);
     deinit_String(&d->localHost);
     deinit_String(&d->url);
@@ -2196,6 +2447,37 @@ void invalidateLayout_GmDocument(iGmDocument *d) {
     d->flags.isLayoutInvalidated = iTrue;
 }
 
+void setLazyLayout_GmDocument(iGmDocument *d, iBool lazy) {
+    d->flags.isLazyLayout = lazy;
+}
+
+iBool isLayoutComplete_GmDocument(const iGmDocument *d) {
+    return d->layoutState == NULL;
+}
+
+iBool continueLayout_GmDocument(iGmDocument *d, double seconds) {
+    return continueLayout_GmDocument_(d, INT_MAX, NULL, seconds);
+}
+
+iBool layoutUntil_GmDocument(iGmDocument *d, int y) {
+    d->layoutMinY = y; /* a redone layout will cover the same area */
+    if (d->layoutState && d->layoutState->pos.y < y) {
+        return continueLayout_GmDocument_(d, y, NULL, 0.0);
+    }
+    return iFalse;
+}
+
+iBool layoutUntilLoc_GmDocument(iGmDocument *d, const char *loc) {
+    if (d->layoutState && loc) {
+        return continueLayout_GmDocument_(d, 0, loc, 0.0);
+    }
+    return iFalse;
+}
+
+iBool finishLayout_GmDocument(iGmDocument *d) {
+    return continueLayout_GmDocument_(d, INT_MAX, NULL, 0.0);
+}
+
 static void markLinkRunsVisited_GmDocument_(iGmDocument *d, const iIntSet *linkIds) {
     iForEach(Array, r, &d->layout) {
         iGmRun *run = r.value;
@@ -2239,8 +2521,74 @@ iLocalDef iBool isNormalizableSpace_(char ch) {
     return ch == ' ' || ch == '\t';
 }
 
+/* Edits to the source are collected lazily: spans of the input that are kept as-is are only
+   copied to a new string once an actual change is made. If there are no changes, the source
+   string (and its storage) remains untouched. */
+iDeclareType(SourceEdit)
+
+struct Impl_SourceEdit {
+    iString *output; /* NULL until the first change */
+    iRangecc kept;   /* input that follows `output` unchanged */
+};
+
+static void init_SourceEdit_(iSourceEdit *d, const iString *input) {
+    d->output = NULL;
+    d->kept   = (iRangecc){ constBegin_String(input), constBegin_String(input) };
+}
+
+static void flush_SourceEdit_(iSourceEdit *d) {
+    if (!d->output) {
+        d->output = new_String();
+    }
+    appendRange_String(d->output, d->kept);
+    d->kept = iNullRange;
+}
+
+static void keep_SourceEdit_(iSourceEdit *d, const char *start, size_t len) {
+    if (start != d->kept.end) {
+        flush_SourceEdit_(d); /* something was skipped */
+        d->kept = (iRangecc){ start, start };
+    }
+    d->kept.end += len;
+}
+
+static void insert_SourceEdit_(iSourceEdit *d, const char *data, size_t len) {
+    flush_SourceEdit_(d);
+    appendData_Block(&d->output->chars, data, len);
+}
+
+static void popBack_SourceEdit_(iSourceEdit *d) {
+    if (!isEmpty_Range(&d->kept)) {
+        d->kept.end--;
+    }
+    else {
+        popBack_Block(&d->output->chars);
+    }
+}
+
+static void keepNewline_SourceEdit_(iSourceEdit *d, const char *lineEnd, const char *inputEnd) {
+    /* Every line ends in a newline, even if the input doesn't. */
+    if (lineEnd < inputEnd) {
+        keep_SourceEdit_(d, lineEnd, 1);
+    }
+    else {
+        insert_SourceEdit_(d, "\n", 1);
+    }
+}
+
+static void apply_SourceEdit_(iSourceEdit *d, iString *input) {
+    if (!d->output && d->kept.start == constBegin_String(input) &&
+        d->kept.end == constEnd_String(input)) {
+        return; /* no changes */
+    }
+    flush_SourceEdit_(d);
+    set_String(input, d->output);
+    delete_String(d->output);
+}
+
 static void normalize_GmDocument(iGmDocument *d) {
-    iString *normalized = new_String();
+    iSourceEdit edit;
+    init_SourceEdit_(&edit, &d->source);
     iRangecc src = range_String(&d->source);
     /* Check for a BOM. In UTF-8, the BOM can just be skipped if present. */ {
         iChar ch = 0;
@@ -2254,7 +2602,6 @@ static void normalize_GmDocument(iGmDocument *d) {
     if (d->format == plainText_SourceFormat) {
         isPreformat = iTrue; /* Cannot be turned off. */
     }
-    iBool wasNormalized = iFalse;
     iRegExp *ansiCursorFwdPattern = new_RegExp("^\x1b\\[([0-9]+)C", 0);
     while (nextSplit_Rangecc(src, "\n", &line)) {
         if (isPreformat) {
@@ -2267,22 +2614,18 @@ static void normalize_GmDocument(iGmDocument *d) {
                         int num = strtoul(capturedRange_RegExpMatch(&m, 1).start, NULL, 10);
                         if (num > 0 && num < 200 /* arbitrary sanity limit */) {
                             for (int i = 0; i < num; i++) {
-                                appendData_Block(&normalized->chars, " ", 1);
+                                insert_SourceEdit_(&edit, " ", 1);
                             }
                         }
                         ch = end_RegExpMatch(&m) - 1;
-                        wasNormalized = iTrue;
                         continue;
                     }
                 }
                 if (*ch != '\v') {
-                    appendCStrN_String(normalized, ch, 1);
-                }
-                else {
-                    wasNormalized = iTrue;
+                    keep_SourceEdit_(&edit, ch, 1);
                 }
             }
-            appendCStr_String(normalized, "\n");
+            keepNewline_SourceEdit_(&edit, line.end, src.end);
             if (d->format == gemini_SourceFormat &&
                 lineType_GmDocument_(d, line) == preformatted_GmLineType) {
                 isPreformat = iFalse;
@@ -2291,16 +2634,15 @@ static void normalize_GmDocument(iGmDocument *d) {
         }
         if (lineType_GmDocument_(d, line) == preformatted_GmLineType) {
             isPreformat = iTrue;
-            appendRange_String(normalized, line);
-            appendCStr_String(normalized, "\n");
+            keep_SourceEdit_(&edit, line.start, size_Range(&line));
+            keepNewline_SourceEdit_(&edit, line.end, src.end);
             continue;
         }
         iBool isPrevSpace = iFalse;
         int spaceCount = 0;
         for (const char *ch = line.start; ch != line.end; ch++) {
-            char c = *ch;
+            const char c = *ch;
             if (c == '\v') {
-                wasNormalized = iTrue;
                 continue;
             }
             if (isNormalizableSpace_(c)) {
@@ -2308,33 +2650,28 @@ static void normalize_GmDocument(iGmDocument *d) {
                     if (++spaceCount == 8) {
                         /* There are several consecutive space characters. The author likely
                            really wants to have some space here, so normalize to a tab stop. */
-                        popBack_Block(&normalized->chars);
-                        pushBack_Block(&normalized->chars, '\t');
+                        popBack_SourceEdit_(&edit);
+                        insert_SourceEdit_(&edit, "\t", 1);
                     }
-                    wasNormalized = iTrue;
                     continue; /* skip repeated spaces */
                 }
+                isPrevSpace = iTrue;
                 if (c != ' ') {
-                    c = ' ';
-                    wasNormalized = iTrue;
+                    insert_SourceEdit_(&edit, " ", 1);
+                    continue;
                 }
-                isPrevSpace = iTrue;
             }
             else {
                 isPrevSpace = iFalse;
                 spaceCount = 0;
             }
-            appendCStrN_String(normalized, &c, 1);
+            keep_SourceEdit_(&edit, ch, 1);
         }
-        appendCStr_String(normalized, "\n");
+        keepNewline_SourceEdit_(&edit, line.end, src.end);
     }
-    iUnused(wasNormalized);
     iRelease(ansiCursorFwdPattern);
-//    printf("wasNormalized: %d\n", wasNormalized);
-//    fflush(stdout);
-    set_String(&d->source, collect_String(normalized));
+    apply_SourceEdit_(&edit, &d->source);
     //normalize_String(&d->source); /* NFC */
-//    printf("orig:%zu norm:%zu\n", size_String(&d->origSource), size_String(&d->source));
 }
 
 void setUrl_GmDocument(iGmDocument *d, const iString *url) {
@@ -2517,19 +2854,25 @@ static void convertMarkdownToGemtext_GmDocument_(iGmDocument *d) {
 }
 
 static void import_GmDocument_(iGmDocument *d) {
+    deleteLayoutState_GmDocument_(d); /* refers to the old source */
+    clear_String(&d->findQuery);
+    clear_Array(&d->findMatches);
     d->format = d->origFormat;
     d->flags.isConvertedMarkdown = iFalse;
-    set_String(&d->source, &d->origSource);
-    replace_String(&d->source, "\r\n", "\n");
-    /* Remove any null characters. */ {
-        const char *ch = constBegin_String(&d->source);
-        for (size_t pos = 0; pos < size_String(&d->source); pos++, ch++) {
-            if (*ch == 0) {
-                remove_Block(&d->source.chars, pos, 1);
-                pos--;
-                ch = constBegin_String(&d->source) + pos;
+    set_String(&d->source, &d->origSource); /* shared until edited */
+    /* Convert CRLF line endings and remove any null characters. */ {
+        iSourceEdit edit;
+        init_SourceEdit_(&edit, &d->source);
+        const char *end  = constEnd_String(&d->source);
+        const char *span = constBegin_String(&d->source);
+        for (const char *ch = span; ch != end; ch++) {
+            if (*ch == 0 || (*ch == '\r' && ch + 1 != end && ch[1] == '\n')) {
+                keep_SourceEdit_(&edit, span, ch - span);
+                span = ch + 1;
             }
         }
+        keep_SourceEdit_(&edit, span, end - span);
+        apply_SourceEdit_(&edit, &d->source);
     }
     /* Detect use of ANSI escapes. */ {
         iRegExp *ansiEsc = new_RegExp("\x1b[[()]([0-9;AB]*?)[ABCDEFGHJKSTfimn]", 0);
@@ -2566,14 +2909,18 @@ void setSource_GmDocument(iGmDocument *d, const iString *source, int width, int
                           enum iGmDocumentUpdate updateType) {
     /* TODO: This API has been set up to allow partial/progressive updating of the content.
        Currently the entire source is replaced every time, though. */
-//    printf("[GmDocument] source update (%zu bytes), width:%d, final:%d\n",
-//           size_String(source), width, updateType == final_GmDocumentUpdate);
+    iTrace("setSource_GmDocument");
+    iTraceCounter("sourceBytes", (int64_t) size_String(source));
     if (size_String(source) == size_String(&d->origSource)) {
         iAssert(equal_String(source, &d->origSource));
-//        printf("[GmDocument] source is unchanged!\n");
         updateWidth_GmDocument(d, width, canvasWidth);
         return; /* Nothing to do. */
     }
+    if (d->hibernated) {
+        /* The hibernated source is replaced. */
+        delete_Block(d->hibernated);
+        d->hibernated = NULL;
+    }
     /* Normalize and convert to Gemtext if needed. */
     set_String(&d->origSource, source);
     import_GmDocument_(d);
@@ -2587,6 +2934,51 @@ void foldPre_GmDocument(iGmDocument *d, uint16_t preId) {
     }
 }
 
+iBool hibernate_GmDocument(iGmDocument *d) {
+    /* Media are not kept in their original form, so they could not be restored. */
+    if (d->hibernated || isEmpty_String(&d->origSource) || !isEmpty_Media(d->media)) {
+        return iFalse;
+    }
+    d->hibernated = compress_Block(&d->origSource.chars);
+    if (isEmpty_Block(d->hibernated)) {
+        delete_Block(d->hibernated);
+        d->hibernated = NULL;
+        return iFalse;
+    }
+    clear_String(&d->origSource);
+    clear_String(&d->source);
+    /* Everything derived from the source is released. The title, site icon, and palette
+       remain for tabs and menus. */
+    deleteLayoutState_GmDocument_(d);
+    clear_String(&d->findQuery);
+    clear_Array(&d->findMatches);
+    deinit_Array(&d->layout);
+    init_Array(&d->layout, sizeof(iGmRun));
+    clear_Array(&d->runBottoms);
+    releaseArenas_GmDocument_(d);
+    clear_Array(&d->headings);
+    iForEach(Array, i, &d->preMeta) {
+        /* Only the fold states are needed for the next layout. */
+        iGmPreMeta *meta = i.value;
+        meta->bounds = meta->altText = meta->contents = iNullRange;
+    }
+    d->flags.isLayoutInvalidated = iTrue;
+    return iTrue;
+}
+
+void wake_GmDocument(iGmDocument *d) {
+    if (!d->hibernated) {
+        return;
+    }
+    iBlock *source = decompress_Block(d->hibernated);
+    delete_Block(d->hibernated);
+    d->hibernated = NULL;
+    setBlock_String(&d->origSource, source);
+    delete_Block(source);
+    import_GmDocument_(d);
+    doLayout_GmDocument_(d);
+}
+
 void updateVisitedLinks_GmDocument(iGmDocument *d) {
     iIntSet linkIds;
     init_IntSet(&linkIds);
@@ -2615,23 +3007,40 @@ const iGmPreMeta *preMeta_GmDocument(const iGmDocument *d, uint16_t preId) {
     return NULL;
 }
 
+static size_t firstRunEndingBelow_GmDocument_(const iGmDocument *d, int y) {
+    /* Runs are only appended to the layout, so the lookup table is extended as needed.
+       Because it has the running maximum, the first run reaching `y` is found with a
+       binary search without touching the runs themselves. */
+    iArray *bottoms = iConstCast(iArray *, &d->runBottoms);
+    int     maxBottom = isEmpty_Array(bottoms) ? INT_MIN : *(const int *) constBack_Array(bottoms);
+    for (size_t i = size_Array(bottoms); i < size_Array(&d->layout); i++) {
+        const iGmRun *run = constAt_Array(&d->layout, i);
+        maxBottom = iMax(maxBottom, bottom_Rect(visBounds_GmRun(run)));
+        pushBack_Array(bottoms, &maxBottom);
+    }
+    size_t lo = 0, hi = size_Array(bottoms);
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (value_Array(bottoms, mid, int) < y) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 void render_GmDocument(const iGmDocument *d, iRangei visRangeY, iGmDocumentRenderFunc render,
                        void *context) {
-    iBool isInside = iFalse;
+    const size_t first = firstRunEndingBelow_GmDocument_(d, visRangeY.start);
     setAnsiFlags_Text(d->theme.ansiEscapes);
-    /* TODO: Check lookup table for quick starting position. */
-    iConstForEach(Array, i, &d->layout) {
-        const iGmRun *run = i.value;
-        if (isInside) {
-            if (top_Rect(run->visBounds) > visRangeY.end) {
-                break;
-            }
-            render(context, run);
-        }
-        else if (bottom_Rect(run->visBounds) >= visRangeY.start) {
-            isInside = iTrue;
-            render(context, run);
+    for (size_t i = first; i < size_Array(&d->layout); i++) {
+        const iGmRun *run = constAt_Array(&d->layout, i);
+        if (i > first && top_Rect(visBounds_GmRun(run)) > visRangeY.end) {
+            break;
         }
+        render(context, run);
     }
     setAnsiFlags_Text(allowAll_AnsiFlag);
 }
@@ -2648,11 +3057,12 @@ const iGmRun *renderProgressive_GmDocument(const iGmDocument *d, const iGmRun *f
                                            size_t maxCount,
                                            iRangei visRangeY, iGmDocumentRenderFunc render,
                                            void *context) {
+    iTrace("renderProgressive_GmDocument");
     setAnsiFlags_Text(d->theme.ansiEscapes);
     const iGmRun *run = first;
     while (isValidRun_GmDocument_(d, run)) {
-        if ((dir < 0 && bottom_Rect(run->visBounds) <= visRangeY.start) ||
-            (dir > 0 && top_Rect(run->visBounds) >= visRangeY.end)) {
+        if ((dir < 0 && bottom_Rect(visBounds_GmRun(run)) <= visRangeY.start) ||
+            (dir > 0 && top_Rect(visBounds_GmRun(run)) >= visRangeY.end)) {
             break;
         }
         if (maxCount-- == 0) {
@@ -2686,11 +3096,32 @@ iGmRunRange runRange_GmDocument(const iGmDocument *d) {
 }
 
 size_t memorySize_GmDocument(const iGmDocument *d) {
-    return size_String(&d->origSource) +
-           size_String(&d->source) +
-           size_Array(&d->layout) * sizeof(iGmRun) +
-           size_Array(&d->links)  * sizeof(iGmLink) +
-           memorySize_Media(d->media);
+    size_t size = sizeof(iGmDocument) +
+                  size_String(&d->origSource) +
+                  (constBegin_String(&d->source) != constBegin_String(&d->origSource)
+                       ? size_String(&d->source)
+                       : 0) + /* may be shared */
+                  size_String(&d->url) +
+                  size_String(&d->title) +
+                  size_Array(&d->layout)   * sizeof(iGmRun) +
+                  size_Array(&d->runBottoms) * sizeof(int) +
+                  size_Array(&d->headings) * sizeof(iGmHeading) +
+                  size_Array(&d->preMeta)  * sizeof(iGmPreMeta) +
+                  memorySize_Media(d->media) +
+                  (d->hibernated ? size_Block(d->hibernated) : 0);
+    size += size_PtrArray(&d->linkBlocks) * linkBlockSize_GmDocument_ * sizeof(iGmLink);
+    iConstForEach(PtrArray, i, &d->links) {
+        const iGmLink *link = i.ptr;
+        size += size_String(&link->url);
+    }
+    iConstForEach(PtrArray, j, &d->auxText) {
+        size += size_Block(j.ptr);
+    }
+    return size;
+}
+
+iBool isHibernating_GmDocument(const iGmDocument *d) {
+    return d->hibernated != NULL;
 }
 
 void setWarning_GmDocument(iGmDocument *d, int warning, iBool set) {
@@ -2701,28 +3132,132 @@ int warnings_GmDocument(const iGmDocument *d) {
     return d->warnings;
 }
 
+static const char *findByte_(const char *pos, const char *end, int ch) {
+    const char *found = memchr(pos, ch, end - pos);
+    return found ? found : end;
+}
+
+static const char *matchLower_(const char *pos, const char *end, const iChar *needle, size_t len) {
+    /* Returns the end of the match, or NULL if there is no match at `pos`. */
+    for (size_t i = 0; i < len; i++) {
+        iChar ch = 0;
+        const int n = (pos < end ? decodeBytes_MultibyteChar(pos, end, &ch) : 0);
+        if (n <= 0 || lower_Char(ch) != needle[i]) {
+            return NULL;
+        }
+        pos += n;
+    }
+    return pos;
+}
+
+static const iArray *findMatches_GmDocument_(const iGmDocument *d, const iString *text) {
+    /* All matches of the query are found at once and cached, so stepping through them is
+       just a binary search. Characters are compared lowercased like `iCaseInsensitive`. */
+    iGmDocument *m = iConstCast(iGmDocument *, d);
+    if (equal_String(&m->findQuery, text)) {
+        return &m->findMatches;
+    }
+    set_String(&m->findQuery, text);
+    clear_Array(&m->findMatches);
+    if (isEmpty_String(text)) {
+        return &m->findMatches;
+    }
+    iArray needle;
+    init_Array(&needle, sizeof(iChar));
+    iConstForEach(String, i, text) {
+        const iChar ch = lower_Char(i.value);
+        pushBack_Array(&needle, &ch);
+    }
+    const iChar *ndl   = constData_Array(&needle);
+    const size_t len   = size_Array(&needle);
+    const char  *pos   = constBegin_String(&d->source);
+    const char  *end   = constEnd_String(&d->source);
+    const iChar  first = ndl[0];
+    if (first < 0x80 && first != 'i' && first != 'k') {
+        /* Jump between candidates with memchr (vectorized in libc) looking for both cases
+           of the first byte. U+0130 and U+212A lowercase to 'i' and 'k', so those need
+           the full scan below. */
+        const int   lo     = (int) first;
+        const int   up     = toupper(lo);
+        const char *nextLo = findByte_(pos, end, lo);
+        const char *nextUp = (up != lo ? findByte_(pos, end, up) : end);
+        for (;;) {
+            if (nextLo < pos) nextLo = findByte_(pos, end, lo);
+            if (nextUp < pos && up != lo) nextUp = findByte_(pos, end, up);
+            const char *cand = iMin(nextLo, nextUp);
+            if (cand >= end) {
+                break;
+            }
+            const char *matchEnd = matchLower_(cand, end, ndl, len);
+            if (matchEnd) {
+                pushBack_Array(&m->findMatches, &(iRangecc){ cand, matchEnd });
+                pos = matchEnd;
+            }
+            else {
+                pos = cand + 1;
+            }
+        }
+    }
+    else {
+        while (pos < end) {
+            const char *matchEnd = matchLower_(pos, end, ndl, len);
+            if (matchEnd) {
+                pushBack_Array(&m->findMatches, &(iRangecc){ pos, matchEnd });
+                pos = matchEnd;
+                continue;
+            }
+            iChar ch;
+            pos += iMax(1, decodeBytes_MultibyteChar(pos, end, &ch));
+        }
+    }
+    deinit_Array(&needle);
+    return &m->findMatches;
+}
+
+static size_t findMatchAfter_(const iArray *matches, const char *loc) {
+    /* Index of the first match starting at or after `loc`. */
+    size_t lo = 0, hi = size_Array(matches);
+    while (lo < hi) {
+        const size_t mid = (lo + hi) / 2;
+        if (((const iRangecc *) constAt_Array(matches, mid))->start < loc) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
 iRangecc findText_GmDocument(const iGmDocument *d, const iString *text, const char *start) {
-    const char * src      = constBegin_String(&d->source);
-    const size_t startPos = (start ? start - src : 0);
-    const size_t pos =
-        indexOfCStrFromSc_String(&d->source, cstr_String(text), startPos, &iCaseInsensitive);
-    if (pos == iInvalidPos) {
+    const iArray *matches = findMatches_GmDocument_(d, text);
+    const size_t  index   = findMatchAfter_(matches, start ? start : constBegin_String(&d->source));
+    if (index == size_Array(matches)) {
         return iNullRange;
     }
-    return (iRangecc){ src + pos, src + pos + size_String(text) };
+    return constValue_Array(matches, index, iRangecc);
 }
 
 iRangecc findTextBefore_GmDocument(const iGmDocument *d, const iString *text, const char *before) {
-    iRangecc found = iNullRange;
-    const char *start = constBegin_String(&d->source);
-    if (!before) before = constEnd_String(&d->source);
-    while (start < before) {
-        iRangecc range = findText_GmDocument(d, text, start);
-        if (range.start == NULL || range.start >= before) break;
-        found = range;
-        start = range.end;
+    const iArray *matches = findMatches_GmDocument_(d, text);
+    const size_t  index   = findMatchAfter_(matches, before ? before : constEnd_String(&d->source));
+    if (index == 0) {
+        return iNullRange;
     }
-    return found;
+    return constValue_Array(matches, index - 1, iRangecc);
+}
+
+size_t numMatches_GmDocument(const iGmDocument *d, const iString *text) {
+    return size_Array(findMatches_GmDocument_(d, text));
+}
+
+size_t matchOrdinal_GmDocument(const iGmDocument *d, const iString *text, const char *loc) {
+    const iArray *matches = findMatches_GmDocument_(d, text);
+    const size_t  index   = findMatchAfter_(matches, loc);
+    if (index < size_Array(matches) && constValue_Array(matches, index, iRangecc).start == loc) {
+        return index;
+    }
+    return iInvalidPos;
 }
 
 iGmRunRange findPreformattedRange_GmDocument(const iGmDocument *d, const iGmRun *run) {
@@ -2943,13 +3478,25 @@ void runBaseAttributes_GmDocument(const iGmDocument *d, const iGmRun *run, int *
     }
 }
 
+static int16_t delta16_(int delta) {
+    iAssert(delta >= INT16_MIN && delta <= INT16_MAX);
+    return (int16_t) iClamp(delta, INT16_MIN, INT16_MAX);
+}
+
+void setVisBounds_GmRun(iGmRun *d, iRect visBounds) {
+    d->visDelta.x      = delta16_(visBounds.pos.x - d->bounds.pos.x);
+    d->visDelta.y      = delta16_(visBounds.pos.y - d->bounds.pos.y);
+    d->visDelta.width  = delta16_(visBounds.size.x - d->bounds.size.x);
+    d->visDelta.height = delta16_(visBounds.size.y - d->bounds.size.y);
+}
+
 iBool isJustified_GmRun(const iGmRun *d) {
     return prefs_App()->justifyParagraph &&
            (d->flags & (notJustified_GmRunFlag | endOfLine_GmRunFlag)) == 0;
 }
 
 int drawBoundWidth_GmRun(const iGmRun *d) {
-    return (d->isRTL ? -1 : 1) * width_Rect(isJustified_GmRun(d) ? d->bounds : d->visBounds);
+    return (d->isRTL ? -1 : 1) * width_Rect(isJustified_GmRun(d) ? d->bounds : visBounds_GmRun(d));
 }
 
 iRangecc findLoc_GmRun(const iGmRun *d, iInt2 pos) {
@@ -126,7 +126,9 @@ enum iGmRunFlags {
 struct Impl_GmRun {
     iRangecc  text;
     iRect     bounds;    /* used for hit testing, may extend to edges */
-    iRect     visBounds; /* actual visual bounds */
+    struct {
+        int16_t x, y, width, height;
+    } visDelta;          /* actual visual bounds, relative to `bounds` (see visBounds_GmRun) */
     struct {
         uint32_t linkId    : 16; /* GmLinkId; zero for non-links */
         uint32_t flags     : 8; /* GmRunFlags */
@@ -161,6 +163,13 @@ iLocalDef uint32_t preId_GmRun(const iGmRun *d) {
     return d->mediaType == max_MediaType ? d->mediaId : 0;
 }
 
+iLocalDef iRect visBounds_GmRun(const iGmRun *d) {
+    return (iRect){ init_I2(d->bounds.pos.x + d->visDelta.x, d->bounds.pos.y + d->visDelta.y),
+                    init_I2(d->bounds.size.x + d->visDelta.width,
+                            d->bounds.size.y + d->visDelta.height) };
+}
+
+void        setVisBounds_GmRun      (iGmRun *, iRect visBounds); /* set `bounds` first */
 iBool       isJustified_GmRun       (const iGmRun *);
 int         drawBoundWidth_GmRun    (const iGmRun *);
 iRangecc    findLoc_GmRun           (const iGmRun *, iInt2 pos);
@@ -207,6 +216,12 @@ void    setWidth_GmDocument     (iGmDocument *, int width, int canvasWidth);
 iBool   updateWidth_GmDocument  (iGmDocument *, int width, int canvasWidth);
 void    redoLayout_GmDocument   (iGmDocument *);
 void    invalidateLayout_GmDocument(iGmDocument *); /* will have to be redone later */
+void    setLazyLayout_GmDocument(iGmDocument *, iBool lazy); /* long documents laid out on demand */
+iBool   isLayoutComplete_GmDocument(const iGmDocument *);
+iBool   continueLayout_GmDocument(iGmDocument *, double seconds); /* returns True if runs were reallocated */
+iBool   layoutUntil_GmDocument  (iGmDocument *, int y); /* returns True if runs were reallocated */
+iBool   layoutUntilLoc_GmDocument(iGmDocument *, const char *loc); /* returns True if runs were reallocated */
+iBool   finishLayout_GmDocument (iGmDocument *); /* returns True if runs were reallocated */
 int     contentWidth_GmDocument (const iGmDocument *); /* may exceed the layout width; unwrappable lines */
 iBool   updateOpenURLs_GmDocument(iGmDocument *);
 void    setUrl_GmDocument       (iGmDocument *, const iString *url);
@@ -214,6 +229,8 @@ void    setSource_GmDocument    (iGmDocument *, const iString *source, int width
                                  enum iGmDocumentUpdate updateType);
 void    setWarning_GmDocument   (iGmDocument *, int warning, iBool set);
 void    foldPre_GmDocument      (iGmDocument *, uint16_t preId);
+iBool   hibernate_GmDocument    (iGmDocument *); /* compress source, release layout */
+void    wake_GmDocument         (iGmDocument *); /* restore source and redo layout */
 
 void    updateVisitedLinks_GmDocument   (iGmDocument *); /* check all links for visited status */
 void    invalidatePalette_GmDocument    (iGmDocument *);
@@ -237,10 +254,13 @@ const iArray *  headings_GmDocument         (const iGmDocument *); /* array of G
 const iString * source_GmDocument           (const iGmDocument *);
 iGmRunRange     runRange_GmDocument         (const iGmDocument *);
 size_t          memorySize_GmDocument       (const iGmDocument *); /* bytes */
+iBool           isHibernating_GmDocument    (const iGmDocument *);
 int             warnings_GmDocument         (const iGmDocument *);
 
 iRangecc        findText_GmDocument                 (const iGmDocument *, const iString *text, const char *start);
 iRangecc        findTextBefore_GmDocument           (const iGmDocument *, const iString *text, const char *before);
+size_t          numMatches_GmDocument               (const iGmDocument *, const iString *text);
+size_t          matchOrdinal_GmDocument             (const iGmDocument *, const iString *text, const char *loc); /* iInvalidPos if not a match */
 iGmRunRange     findPreformattedRange_GmDocument    (const iGmDocument *, const iGmRun *run);
 
 int             ansiEscapes_GmDocument              (const iGmDocument *);
@@ -32,6 +32,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "ui/text.h"
 #include "resources.h"
 #include "sitespec.h"
+#include "trace.h"
 #include "defs.h"
 
 #include <errno.h>
@@ -103,6 +104,18 @@ iGmResponse *copy_GmResponse(const iGmResponse *d) {
     return copied;
 }
 
+void deflateBody_GmResponse(iGmResponse *d) {
+    iBlock *deflated = compress_Block(&d->body);
+    set_Block(&d->body, deflated);
+    delete_Block(deflated);
+}
+
+void inflateBody_GmResponse(iGmResponse *d) {
+    iBlock *inflated = decompress_Block(&d->body);
+    set_Block(&d->body, inflated);
+    delete_Block(inflated);
+}
+
 void serialize_GmResponse(const iGmResponse *d, iStream *outs) {
     write32_Stream(outs, d->statusCode);
     serialize_String(&d->meta, outs);
@@ -190,6 +203,11 @@ iDefineObjectConstructionArgs(GmRequest, (iGmCerts *certs), certs)
 iDefineAudienceGetter(GmRequest, updated)
 iDefineAudienceGetter(GmRequest, finished)
 
+static void notifyFinished_GmRequest_(iGmRequest *d) {
+    iTraceAsyncEnd("GmRequest", d->id);
+    iNotifyAudience(d, finished, GmRequestFinished);
+}
+
 static uint16_t port_GmRequest_(iGmRequest *d) {
     return urlPort_String(&d->url);
 }
@@ -279,6 +297,7 @@ static int processIncomingData_GmRequest_(iGmRequest *d, const iBlock *data) {
 }
 
 static void readIncoming_GmRequest_(iGmRequest *d, iTlsRequest *req) {
+    iTrace("readIncoming_GmRequest");
     lock_Mutex(d->mtx);
     iGmResponse *resp = d->resp;
     if (d->state == finished_GmRequestState || d->state == failure_GmRequestState) {
@@ -301,7 +320,7 @@ static void readIncoming_GmRequest_(iGmRequest *d, iTlsRequest *req) {
         }
     }
     if (notifyDone) {
-        iNotifyAudience(d, finished, GmRequestFinished);
+        notifyFinished_GmRequest_(d);
     }
 }
 
@@ -362,11 +381,11 @@ static void requestFinished_GmRequest_(iGmRequest *d, iTlsRequest *req) {
     if (d->isRespFiltered && d->state == finished_GmRequestState) {
         applyFilter_GmRequest_(d);
     }
-    iNotifyAudience(d, finished, GmRequestFinished);
+    notifyFinished_GmRequest_(d);
 }
 
 static const iBlock *aboutPageSource_(iRangecc path, iRangecc query) {
-    const struct { const char *name; const iBlock *data; } staticPages[] = {
+    const struct { const char *name; iBlock *data; } staticPages[] = {
         { "about",          &blobAbout_Resources },
         { "lagrange",       &blobLagrange_Resources },
         { "help",           &blobHelp_Resources },
@@ -378,12 +397,15 @@ static const iBlock *aboutPageSource_(iRangecc path, iRangecc query) {
     };
     iForIndices(i, staticPages) {
         if (equalCase_Rangecc(path, staticPages[i].name)) {
-            return staticPages[i].data;
+            return load_Resources(staticPages[i].data);
         }
     }
     if (equalCase_Rangecc(path, "debug")) {
         return utf8_String(debugInfo_App());
     }
+    if (equalCase_Rangecc(path, "memory")) {
+        return utf8_String(memoryInfo_App());
+    }
     if (equalCase_Rangecc(path, "fonts")) {
         return utf8_String(infoPage_Fonts(query));
     }
@@ -460,7 +482,7 @@ static void plainSocketDisconnected_GmRequest_(iGmRequest *d, iSocket *socket) {
     }
     unlock_Mutex(d->mtx);
     if (notify) {
-        iNotifyAudience(d, finished, GmRequestFinished);
+        notifyFinished_GmRequest_(d);
     }
 }
 
@@ -476,7 +498,7 @@ static void plainSocketError_GmRequest_(iGmRequest *d, iSocket *socket, int erro
     format_String(&d->resp->meta, "%s (errno %d)", msg, error);
     clear_Block(&d->resp->body);
     unlock_Mutex(d->mtx);
-    iNotifyAudience(d, finished, GmRequestFinished);
+    notifyFinished_GmRequest_(d);
 }
 
 static void gopherRead_GmRequest_(iGmRequest *d, iSocket *socket) {
@@ -511,7 +533,7 @@ static void beginGopherConnection_GmRequest_(iGmRequest *d, const iString *host,
         resp->statusCode = input_GmStatusCode;
         setCStr_String(&resp->meta, "Enter query:");
         d->state = finished_GmRequestState;
-        iNotifyAudience(d, finished, GmRequestFinished);
+        notifyFinished_GmRequest_(d);
     }
 }
 
@@ -571,7 +593,7 @@ static void guppyRead_GmRequest_(iGmRequest *d, iDatagram *datagram) {
         iNotifyAudience(d, updated, GmRequestUpdated);
     }
     if (notifyDone) {
-        iNotifyAudience(d, finished, GmRequestFinished);
+        notifyFinished_GmRequest_(d);
     }
 }
 
@@ -583,7 +605,7 @@ static void guppyTimeout_GmRequest_(iGmRequest *d) {
     setCStr_String(&d->resp->meta, strerror(ETIMEDOUT));
     clear_Block(&d->resp->body);
     unlock_Mutex(d->mtx);
-    iNotifyAudience(d, finished, GmRequestFinished);
+    notifyFinished_GmRequest_(d);
 }
 
 static void guppyError_GmRequest_(iGmRequest *d) {
@@ -677,7 +699,7 @@ static void spartanRead_GmRequest_(iGmRequest *d, iSocket *socket) {
         iNotifyAudience(d, updated, GmRequestUpdated);
     }
     if (notifyDone) {
-        iNotifyAudience(d, finished, GmRequestFinished);
+        notifyFinished_GmRequest_(d);
     }
 }
 
@@ -861,7 +883,7 @@ static void aboutRequest_GmRequest_(iGmRequest *d) {
         resp->statusCode = invalidLocalResource_GmStatusCode;
     }
     d->state = finished_GmRequestState;
-    iNotifyAudience(d, finished, GmRequestFinished);
+    notifyFinished_GmRequest_(d);
 }
 
 void dataRequest_GmRequest_(iGmRequest *d) {
@@ -895,7 +917,7 @@ void dataRequest_GmRequest_(iGmRequest *d) {
     d->state = receivingBody_GmRequestState;
     iNotifyAudience(d, updated, GmRequestUpdated);
     d->state = finished_GmRequestState;
-    iNotifyAudience(d, finished, GmRequestFinished);
+    notifyFinished_GmRequest_(d);
 }
 
 static void composeTitanRequest_GmRequest_(iGmRequest *d) {
@@ -1157,7 +1179,7 @@ static void fileRequest_GmRequest_(iGmRequest *d) {
         /* TODO: Use a background thread, the hook may take some time to run. */
         applyFilter_GmRequest_(d);
     }
-    iNotifyAudience(d, finished, GmRequestFinished);
+    notifyFinished_GmRequest_(d);
 }
 
 /*----------------------------------------------------------------------------------------------*/
@@ -1168,6 +1190,7 @@ void submit_GmRequest(iGmRequest *d) {
         return;
     }
     set_Atomic(&d->allowUpdate, iTrue);
+    iTraceAsyncBegin("GmRequest", d->id);
     iGmResponse *resp = d->resp;
     clear_GmResponse(resp);
 #if !defined (NDEBUG) && !defined (iPlatformTerminal)
@@ -1221,7 +1244,7 @@ void submit_GmRequest(iGmRequest *d) {
         /* This scheme is unrecognized so cannot submit the request. */
         resp->statusCode = unsupportedProtocol_GmStatusCode;
         d->state = finished_GmRequestState;
-        iNotifyAudience(d, finished, GmRequestFinished);
+        notifyFinished_GmRequest_(d);
         return;
     }
     /* Submitting a Gemini-compatible request. */
@@ -57,6 +57,8 @@ iDeclareTypeConstruction(GmResponse)
 iDeclareTypeSerialization(GmResponse)
 
 iGmResponse *       copy_GmResponse             (const iGmResponse *);
+void                deflateBody_GmResponse      (iGmResponse *);
+void                inflateBody_GmResponse      (iGmResponse *);
 
 /*----------------------------------------------------------------------------------------------*/
 
@@ -191,7 +191,10 @@ void serializeWithContent_History(const iHistory *d, iStream *outs, iBool withCo
         writeU16_Stream(outs, item->flags);
         if (withContent && item->cachedResponse) {
             write8_Stream(outs, 1);
-            serialize_GmResponse(item->cachedResponse, outs);
+            iGmResponse *resp = copy_GmResponse(item->cachedResponse);
+            inflateBody_GmResponse(resp);
+            serialize_GmResponse(resp, outs);
+            delete_GmResponse(resp);
         }
         else {
             write8_Stream(outs, 0);
@@ -218,6 +221,7 @@ void deserialize_History(iHistory *d, iStream *ins) {
         if (read8_Stream(ins)) {
             item.cachedResponse = new_GmResponse();
             deserialize_GmResponse(item.cachedResponse, ins);
+            deflateBody_GmResponse(item.cachedResponse);
         }
         if (version_Stream(ins) >= recentUrlSetIdentity_FileVersion) {
             deserialize_Block(&item.setIdentity, ins);
@@ -435,7 +439,9 @@ void setCachedResponse_History(iHistory *d, const iGmResponse *response) {
         delete_GmResponse(item->cachedResponse);
         item->cachedResponse = NULL;
         if (category_GmStatusCode(response->statusCode) == categorySuccess_GmStatusCode) {
+            /* Most cached content is text, which compresses well. */
             item->cachedResponse = copy_GmResponse(response);
+            deflateBody_GmResponse(item->cachedResponse);
         }
     }
     unlock_Mutex(d->mtx);
@@ -485,6 +491,22 @@ size_t memorySize_History(const iHistory *d) {
     return bytes;
 }
 
+size_t prunableMemorySize_History(const iHistory *d) {
+    size_t bytes = 0;
+    lock_Mutex(d->mtx);
+    iConstForEach(Array, i, &d->recent) {
+        const iRecentUrl *url = i.value;
+        if (d->recentPos == size_Array(&d->recent) - index_ArrayConstIterator(&i) - 1) {
+            continue; /* The current page is not pruned. */
+        }
+        if (url->cachedDoc) {
+            bytes += memorySize_GmDocument(url->cachedDoc);
+        }
+    }
+    unlock_Mutex(d->mtx);
+    return bytes;
+}
+
 void clearCache_History(iHistory *d) {
     lock_Mutex(d->mtx);
     iForEach(Array, i, &d->recent) {
@@ -596,15 +618,16 @@ const iStringArray *searchContents_History(const iHistory *d, const iRegExp *pat
             if (indexOfCStrSc_String(&resp->meta, "text/", &iCaseInsensitive) == iInvalidPos) {
                 continue;
             }
+            iBlock *body = decompress_Block(&resp->body);
             iRegExpMatch m;
             init_RegExpMatch(&m);
-            if (matchRange_RegExp(pattern, range_Block(&resp->body), &m)) {
+            if (matchRange_RegExp(pattern, range_Block(body), &m)) {
                 iString entry;
                 init_String(&entry);
                 iRangei cap = m.range;
                 const int prefix = iMin(10, cap.start);
                 cap.start   = cap.start - prefix;
-                cap.end     = iMin(cap.end + 30, (int) size_Block(&resp->body));
+                cap.end     = iMin(cap.end + 30, (int) size_Block(body));
                 const size_t maxLen = 60;
                 if (size_Range(&cap) > maxLen) {
                     cap.end = cap.start + maxLen;
@@ -628,6 +651,7 @@ const iStringArray *searchContents_History(const iHistory *d, const iRegExp *pat
                 }
                 deinit_String(&entry);
             }
+            delete_Block(body);
         }
     }
     deinit_StringSet(&inserted);
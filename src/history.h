@@ -37,7 +37,7 @@ iDeclareTypeConstruction(RecentUrl)
 struct Impl_RecentUrl {
     iString      url;
     float        normScrollY;    /* normalized to document height */
-    iGmResponse *cachedResponse; /* kept in memory for quicker back navigation */
+    iGmResponse *cachedResponse; /* kept in memory for quicker back navigation; body is deflated */
     iGmDocument *cachedDoc;      /* cached copy of the presentation: layout and media (not serialized) */
     iBlock       setIdentity;    /* fingerprint of identity that was pinned*/
     uint16_t     flags;
@@ -97,6 +97,7 @@ const iGmResponse *
             cachedResponse_History      (const iHistory *);
 size_t      cacheSize_History           (const iHistory *);
 size_t      memorySize_History          (const iHistory *);
+size_t      prunableMemorySize_History  (const iHistory *); /* see pruneLeastImportantMemory */
 
 iString *   debugInfo_History           (const iHistory *);
 iMemInfo    memoryUsage_History         (const iHistory *);
@@ -0,0 +1,183 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "imagecache.h"
+#include "ui/paint.h" /* size_SDLTexture */
+
+#include <the_Foundation/ptrarray.h>
+#include <string.h>
+
+iDeclareType(CachedImage)
+
+struct Impl_CachedImage {
+    iImageCacheKey key;
+    SDL_Texture   *texture;
+    iInt2          imageSize; /* original size, before any scaling */
+    size_t         texBytes;
+    int            refCount;
+};
+
+static iBool isEqual_ImageCacheKey_(const iImageCacheKey *a, const iImageCacheKey *b) {
+    return a->render == b->render && a->numBytes == b->numBytes &&
+           isEqual_I2(a->maxSize, b->maxSize) && !memcmp(a->sha256, b->sha256, sizeof(a->sha256));
+}
+
+/*----------------------------------------------------------------------------------------------*/
+
+iDeclareType(ImageCache)
+
+struct Impl_ImageCache {
+    iPtrArray entries;   /* least recently used first */
+    size_t    unusedSize; /* bytes in entries that have no references */
+};
+
+static iImageCache cache_;
+
+#if defined (iPlatformMobile)
+#   define maxUnusedSize_ImageCache     (16 * 1000000) /* bytes */
+#else
+#   define maxUnusedSize_ImageCache     (64 * 1000000) /* bytes */
+#endif
+
+static void remove_ImageCache_(iImageCache *d, size_t pos, iBool destroyTexture) {
+    iCachedImage *entry;
+    take_PtrArray(&d->entries, pos, (void **) &entry);
+    if (entry->refCount == 0) {
+        d->unusedSize -= entry->texBytes;
+    }
+    if (destroyTexture) {
+        SDL_DestroyTexture(entry->texture);
+    }
+    free(entry);
+}
+
+static void prune_ImageCache_(iImageCache *d) {
+    for (size_t i = 0; i < size_PtrArray(&d->entries) && d->unusedSize > maxUnusedSize_ImageCache; ) {
+        const iCachedImage *entry = constAt_PtrArray(&d->entries, i);
+        if (entry->refCount == 0) {
+            remove_ImageCache_(d, i, iTrue);
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+static size_t indexOfTexture_ImageCache_(const iImageCache *d, const SDL_Texture *texture) {
+    iConstForEach(PtrArray, i, &d->entries) {
+        const iCachedImage *entry = i.ptr;
+        if (entry->texture == texture) {
+            return index_PtrArrayConstIterator(&i);
+        }
+    }
+    return iInvalidPos;
+}
+
+void init_ImageCache(void) {
+    iImageCache *d = &cache_;
+    init_PtrArray(&d->entries);
+    d->unusedSize = 0;
+}
+
+void deinit_ImageCache(void) {
+    iImageCache *d = &cache_;
+    /* Documents have been destroyed by now. */
+    while (!isEmpty_PtrArray(&d->entries)) {
+        remove_ImageCache_(d, 0, iTrue);
+    }
+    deinit_PtrArray(&d->entries);
+}
+
+SDL_Texture *acquire_ImageCache(const iImageCacheKey *key, iInt2 *imageSize_out) {
+    iImageCache *d = &cache_;
+    iForEach(PtrArray, i, &d->entries) {
+        iCachedImage *entry = i.ptr;
+        if (isEqual_ImageCacheKey_(&entry->key, key)) {
+            if (entry->refCount++ == 0) {
+                d->unusedSize -= entry->texBytes;
+            }
+            /* Move to the most recently used end. */
+            take_PtrArray(&d->entries, index_PtrArrayIterator(&i), (void **) &entry);
+            pushBack_PtrArray(&d->entries, entry);
+            *imageSize_out = entry->imageSize;
+            return entry->texture;
+        }
+    }
+    return NULL;
+}
+
+void add_ImageCache(const iImageCacheKey *key, SDL_Texture *texture, iInt2 imageSize) {
+    iImageCache *d = &cache_;
+    iAssert(texture);
+    iAssert(indexOfTexture_ImageCache_(d, texture) == iInvalidPos);
+    iCachedImage *entry = iMalloc(CachedImage);
+    const iInt2 texSize = size_SDLTexture(texture);
+    entry->key       = *key;
+    entry->texture   = texture;
+    entry->imageSize = imageSize;
+    entry->texBytes  = 4 * texSize.x * texSize.y; /* RGBA */
+    entry->refCount  = 1; /* held by the caller */
+    pushBack_PtrArray(&d->entries, entry);
+}
+
+void release_ImageCache(SDL_Texture *texture) {
+    iImageCache *d = &cache_;
+    if (!texture) {
+        return;
+    }
+    const size_t pos = indexOfTexture_ImageCache_(d, texture);
+    if (pos == iInvalidPos) {
+        SDL_DestroyTexture(texture); /* not shared */
+        return;
+    }
+    iCachedImage *entry = at_PtrArray(&d->entries, pos);
+    iAssert(entry->refCount > 0);
+    if (--entry->refCount == 0) {
+        d->unusedSize += entry->texBytes;
+        prune_ImageCache_(d);
+    }
+}
+
+void clear_ImageCache(void) {
+    iImageCache *d = &cache_;
+    for (size_t i = size_PtrArray(&d->entries); i-- > 0; ) {
+        const iCachedImage *entry = constAt_PtrArray(&d->entries, i);
+        if (entry->refCount == 0) {
+            remove_ImageCache_(d, i, iTrue);
+        }
+    }
+}
+
+void removeRenderer_ImageCache(SDL_Renderer *render) {
+    iImageCache *d = &cache_;
+    for (size_t i = size_PtrArray(&d->entries); i-- > 0; ) {
+        const iCachedImage *entry = constAt_PtrArray(&d->entries, i);
+        if (entry->key.render == render) {
+            /* Textures still in use will be destroyed with the renderer. */
+            remove_ImageCache_(d, i, entry->refCount == 0);
+        }
+    }
+}
+
+size_t memorySize_ImageCache(void) {
+    return cache_.unusedSize;
+}
@@ -0,0 +1,52 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#pragma once
+
+#include "defs.h"
+#include <the_Foundation/vec2.h>
+#include <SDL_render.h>
+
+/* Process-wide cache of decoded image textures, shared by all documents and history
+   entries. Images are identified by the renderer, the content (SHA-256 digest and size of the
+   encoded data), and the maximum texture size. A texture is reference counted while
+   documents use it; unused textures are kept until the byte budget is exceeded, least
+   recently used first. Main thread only. */
+
+iDeclareType(ImageCacheKey)
+
+struct Impl_ImageCacheKey {
+    SDL_Renderer *render;
+    uint8_t       sha256[32];
+    size_t        numBytes; /* encoded data */
+    iInt2         maxSize;  /* texture is scaled down to fit */
+};
+
+void            init_ImageCache             (void);
+void            deinit_ImageCache           (void);
+
+SDL_Texture *   acquire_ImageCache          (const iImageCacheKey *, iInt2 *imageSize_out);
+void            add_ImageCache              (const iImageCacheKey *, SDL_Texture *, iInt2 imageSize);
+void            release_ImageCache          (SDL_Texture *);
+void            clear_ImageCache            (void); /* destroys unused textures */
+void            removeRenderer_ImageCache   (SDL_Renderer *); /* renderer is about to be destroyed */
+size_t          memorySize_ImageCache       (void); /* bytes in unused textures */
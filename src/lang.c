@@ -54,7 +54,8 @@ enum iPluralType {
 };
 
 struct Impl_Lang {
-    iSortedArray *messages;
+    iSortedArray *messages; /* point to the contents of `blob` */
+    iBlock *blob;
     enum iPluralType pluralType;
     iString langCode;
 };
@@ -144,6 +145,12 @@ static void load_Lang_(iLang *d, const char *id) {
     else {
         d->pluralType = notEqualToOne_PluralType;
     }
+    /* Only the current language is kept in memory. */
+    if (d->blob && d->blob != data) {
+        release_Resources(d->blob);
+    }
+    d->blob = iConstCast(iBlock *, data);
+    load_Resources(d->blob);
     iMsgStr msg;
     for (const char *ptr = constBegin_Block(data); ptr != constEnd_Block(data); ptr++) {
         msg.id.start = ptr;
@@ -173,6 +180,7 @@ void init_Lang(void) {
     iLang *d = &lang_;
     init_String(&d->langCode);
     d->messages = new_SortedArray(sizeof(iMsgStr), cmp_MsgStr_);
+    d->blob = NULL;
     setCurrent_Lang("en");
 }
 
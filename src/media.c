@@ -28,6 +28,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "ui/paint.h" /* size_SDLTexture */
 #include "audio/player.h"
 #include "app.h"
+#include "imagecache.h"
+#include "trace.h"
 #include "stb_image.h"
 #include "stb_image_resize2.h"
 #include "jpegxl.h" // LAGRANGE_ENABLE_JXL
@@ -102,7 +104,7 @@ void init_GmImage(iGmImage *d, const iBlock *data) {
 
 void deinit_GmImage(iGmImage *d) {
     deinit_Block(&d->partialData);
-    SDL_DestroyTexture(d->texture);
+    release_ImageCache(d->texture);
     deinit_GmMediaProps_(&d->props);
 }
 
@@ -151,11 +153,41 @@ static void applyImageStyle_(enum iImageStyle style, iInt2 size, uint8_t *imgDat
     }
 }
 
+static iInt2 maxImageSize_Media_(const iWindow *window) {
+    /* Images are resized down to min(maximum texture size, display size). */
+    SDL_Rect dispRect;
+    SDL_GetDisplayBounds(SDL_GetWindowDisplayIndex(window->win), &dispRect);
+    const iInt2 dispSize = coord_Window(window, dispRect.w, dispRect.h);
+    const iInt2 maxTex   = maxTextureSize_Window(window);
+    return isEqual_I2(maxTex, zero_I2()) ? dispSize : min_I2(maxTex, dispSize);
+}
+
 static iBool makeImageTexture_Media_(iMedia *media, iGmImage *d, iBool isPartial) {
+    iTrace("makeImageTexture_Media");
     iBlock *data     = &d->partialData;
     d->numBytes      = size_Block(data);
     uint8_t *imgData = NULL;
     iBool isNew      = iFalse;
+    iWindow *window  = get_Window();
+    const iInt2 maxSize = maxImageSize_Media_(window);
+    /* Complete images may already be decoded in another document. Styled images depend on
+       the current theme colors, so those are not shared. */
+    const iBool isShared = !isPartial && prefs_App()->imageStyle == original_ImageStyle;
+    iImageCacheKey key = { .render = renderer_Window(window),
+                           .numBytes = size_Block(data),
+                           .maxSize = maxSize };
+    if (isShared) {
+        sha256_Block(data, key.sha256);
+        iInt2 imageSize;
+        SDL_Texture *cached = acquire_ImageCache(&key, &imageSize);
+        if (cached) {
+            release_ImageCache(d->texture);
+            d->texture = cached;
+            d->size    = imageSize;
+            clear_Block(data);
+            return iTrue;
+        }
+    }
     if (!isPartial && equalMediaType_String(&d->props.mime, "image/webp")) {
 #if defined (LAGRANGE_ENABLE_WEBP)
         imgData = WebPDecodeRGBA(constData_Block(data), size_Block(data), &d->size.x, &d->size.y);
@@ -175,20 +207,15 @@ static iBool makeImageTexture_Media_(iMedia *media, iGmImage *d, iBool isPartial
         }
     }
     if (!imgData) {
-        d->size    = zero_I2();
+        d->size = zero_I2();
+        release_ImageCache(d->texture);
         d->texture = NULL;
     }
     else {
         applyImageStyle_(prefs_App()->imageStyle, d->size, imgData);
         /* TODO: Save some memory by checking if the alpha channel is actually in use. */
-        iWindow *window  = get_Window();
-        iInt2    texSize = d->size;
-        /* Resize down to min(maximum texture size, window size). */ {
-            SDL_Rect dispRect;
-            SDL_GetDisplayBounds(SDL_GetWindowDisplayIndex(window->win), &dispRect);
-            const iInt2 maxSize = min_I2(isEqual_I2(maxTextureSize_Window(window), zero_I2()) ?
-                                         texSize : maxTextureSize_Window(window),
-                                         coord_Window(window, dispRect.w, dispRect.h));
+        iInt2 texSize = d->size;
+        /* Resize down to fit `maxSize`. */ {
             iInt2 scaled = d->size;
             if (scaled.x > maxSize.x) {
                 scaled.y = scaled.y * maxSize.x / scaled.x;
@@ -217,9 +244,13 @@ static iBool makeImageTexture_Media_(iMedia *media, iGmImage *d, iBool isPartial
         /* TODO: In multiwindow case, all windows must have the same shared renderer?
            Or at least a shared context. */
         SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "1"); /* linear scaling */
+        release_ImageCache(d->texture); /* previous partial image */
         d->texture = SDL_CreateTextureFromSurface(renderer_Window(window), surface);
         SDL_FreeSurface(surface);
         free(imgData);
+        if (isShared && d->texture) {
+            add_ImageCache(&key, d->texture, d->size);
+        }
         isNew = iTrue;
     }
     if (!isPartial) {
@@ -361,7 +392,16 @@ void clear_Media(iMedia *d) {
 #endif
 }
 
-size_t memorySize_Media(const iMedia *d) {
+iBool isEmpty_Media(const iMedia *d) {
+    iForIndices(type, d->items) {
+        if (!isEmpty_PtrArray(&d->items[type])) {
+            return iFalse;
+        }
+    }
+    return iTrue;
+}
+
+size_t textureMemorySize_Media(const iMedia *d) {
     size_t memSize = 0;
     iConstForEach(PtrArray, i, &d->items[image_MediaType]) {
         const iGmImage *img = i.ptr;
@@ -369,7 +409,15 @@ size_t memorySize_Media(const iMedia *d) {
             const iInt2 texSize = size_SDLTexture(img->texture);
             memSize += 4 * texSize.x * texSize.y; /* RGBA */
         }
-        else {
+    }
+    return memSize;
+}
+
+size_t memorySize_Media(const iMedia *d) {
+    size_t memSize = textureMemorySize_Media(d);
+    iConstForEach(PtrArray, i, &d->items[image_MediaType]) {
+        const iGmImage *img = i.ptr;
+        if (!img->texture) {
             memSize += size_Block(&img->partialData);
         }
     }
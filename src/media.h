@@ -71,7 +71,9 @@ void            clear_Media             (iMedia *);
 iBool           setUrl_Media            (iMedia *, uint16_t linkId, enum iMediaType mediaType, const iString *url);
 iBool           setData_Media           (iMedia *, uint16_t linkId, const iString *mime, const iBlock *data, int flags);
 
+iBool           isEmpty_Media           (const iMedia *);
 size_t          memorySize_Media        (const iMedia *);
+size_t          textureMemorySize_Media (const iMedia *); /* included in `memorySize_Media` */
 iMediaId        findMediaForLink_Media  (const iMedia *, uint16_t linkId, enum iMediaType mediaType);
 
 iMediaId        id_Media        (const iMedia *, uint16_t linkId, enum iMediaType type);
@@ -22,6 +22,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "periodic.h"
 #include "ui/widget.h"
+#include "ui/profiler.h"
 #include "ui/window.h"
 #include "app.h"
 
@@ -133,6 +134,7 @@ iBool dispatchCommands_Periodic(iPeriodic *d) {
             setCurrent_Window(root->window);
             setCurrent_Root(root);
             dispatchEvent_Widget(pc->context, (const SDL_Event *) &ev);
+            iCountFrame(periodics);
             wasPosted = iTrue;
         }
     }
@@ -104,6 +104,7 @@ enum iPrefsBool {
     warnCertSecurity_PrefsBool,
     decodeUserVisibleURLs_PrefsBool,
     allowSchemeChangingRedirect_PrefsBool,
+    prefetchLinks_PrefsBool,
 
     /* Style */
     monospaceGemini_PrefsBool,
@@ -189,6 +190,7 @@ struct Impl_Prefs {
             iBool warnTlsSecurity;
             iBool decodeUserVisibleURLs;
             iBool allowSchemeChangingRedirect;
+            iBool prefetchLinks; /* speculatively fetch hovered and "next page" links */
 
             /* Style */
             iBool monospaceGemini;
@@ -23,6 +23,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "resources.h"
 
 #include <the_Foundation/archive.h>
+#include <the_Foundation/mutex.h>
 #include <the_Foundation/version.h>
 
 #if defined (iPlatformAndroidMobile)
@@ -30,6 +31,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #endif
 
 static iArchive *archive_;
+static iMutex   *loadMutex_; /* archive reads are not thread-safe */
 
 iBlock blobAbout_Resources;
 iBlock blobHelp_Resources;
@@ -76,6 +78,7 @@ iBlock blobCacertPem_Resources;
 static struct {
     iBlock *data;
     const char *archivePath;
+    iBool isLoaded;
 } entries_[] = {
     { &blobAbout_Resources, "about/about.gmi" },
     { &blobLagrange_Resources, "about/lagrange.gmi" },
@@ -153,12 +156,12 @@ iBool init_Resources(const char *path) {
         iVersion resVer;
         init_Version(&resVer, range_Block(dataCStr_Archive(archive_, "VERSION")));
         if (!cmp_Version(&resVer, &appVer)) {
+            /* Contents are decompressed only when needed (see `load_Resources`). */
             iForIndices(i, entries_) {
-                const iBlock *data = dataCStr_Archive(archive_, entries_[i].archivePath);
-                if (data) {
-                    initCopy_Block(entries_[i].data, data);
-                }
+                init_Block(entries_[i].data, 0);
+                entries_[i].isLoaded = iFalse;
             }
+            loadMutex_ = new_Mutex();
             return iTrue;
         }
         fprintf(stderr, "[Resources] %s: version mismatch (%s != " LAGRANGE_APP_VERSION ")\n",
@@ -172,9 +175,66 @@ void deinit_Resources(void) {
     iForIndices(i, entries_) {
         deinit_Block(entries_[i].data);
     }
+    delete_Mutex(loadMutex_);
     iRelease(archive_);
 }
 
-const iArchive *archive_Resources(void) {
+const iArchive *lockArchive_Resources(void) {
+    lock_Mutex(loadMutex_);
     return archive_;
 }
+
+void unlockArchive_Resources(void) {
+    unlock_Mutex(loadMutex_);
+}
+
+static size_t findEntry_Resources_(const iBlock *blob) {
+    iForIndices(i, entries_) {
+        if (entries_[i].data == blob) {
+            return i;
+        }
+    }
+    return iInvalidPos;
+}
+
+const iBlock *load_Resources(iBlock *blob) {
+    const size_t index = findEntry_Resources_(blob);
+    if (index != iInvalidPos) {
+        lock_Mutex(loadMutex_);
+        if (!entries_[index].isLoaded) {
+            const iBlock *data = dataCStr_Archive(archive_, entries_[index].archivePath);
+            if (data) {
+                set_Block(blob, data); /* shares the data */
+            }
+            /* The archive's cached copy is the same data, so it takes no extra memory. */
+            entries_[index].isLoaded = iTrue;
+        }
+        unlock_Mutex(loadMutex_);
+    }
+    return blob;
+}
+
+void release_Resources(iBlock *blob) {
+    const size_t index = findEntry_Resources_(blob);
+    if (index != iInvalidPos) {
+        lock_Mutex(loadMutex_);
+        if (entries_[index].isLoaded) {
+            clear_Block(blob);
+            releaseDataCStr_Archive(archive_, entries_[index].archivePath);
+            entries_[index].isLoaded = iFalse;
+        }
+        unlock_Mutex(loadMutex_);
+    }
+}
+
+size_t size_Resources(const iBlock *blob) {
+    const size_t index = findEntry_Resources_(blob);
+    if (index != iInvalidPos) {
+        lock_Mutex(loadMutex_);
+        const iArchiveEntry *entry = entryCStr_Archive(archive_, entries_[index].archivePath);
+        const size_t size = entry ? entry->size : 0;
+        unlock_Mutex(loadMutex_);
+        return size;
+    }
+    return 0;
+}
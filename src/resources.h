@@ -29,7 +29,15 @@ iDeclareType(Archive)
 iBool               init_Resources      (const char *path);
 void                deinit_Resources    (void);
 
-const iArchive *    archive_Resources   (void);
+/* Archive reads are serialized, so the archive must be locked while it is used directly. */
+const iArchive *    lockArchive_Resources   (void);
+void                unlockArchive_Resources (void);
+
+/* The blobs below are empty until loaded. The archive contents are decompressed on first
+   use, and a blob remains loaded until released. */
+const iBlock *      load_Resources      (iBlock *blob);
+void                release_Resources   (iBlock *blob);
+size_t              size_Resources      (const iBlock *blob); /* does not load the blob */
 
 extern iBlock blobAbout_Resources;
 extern iBlock blobHelp_Resources;
@@ -0,0 +1,230 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+#include "responsecache.h"
+#include "app.h"
+#include "gmcerts.h"
+#include "gmutil.h"
+#include "prefs.h"
+#include "ui/window.h"
+
+#include <the_Foundation/ptrarray.h>
+
+iDeclareType(CachedResponse)
+
+struct Impl_CachedResponse {
+    iString      url;
+    iTime        added;
+    iGmResponse *resp; /* body deflated */
+};
+
+static size_t size_CachedResponse_(const iCachedResponse *d) {
+    return sizeof(*d) + size_String(&d->url) + size_String(&d->resp->meta) +
+           size_Block(&d->resp->body);
+}
+
+static void delete_CachedResponse_(iCachedResponse *d) {
+    deinit_String(&d->url);
+    delete_GmResponse(d->resp);
+    free(d);
+}
+
+/*----------------------------------------------------------------------------------------------*/
+
+iDeclareType(ResponseCache)
+
+struct Impl_ResponseCache {
+    iPtrArray   entries;    /* least recently used first */
+    size_t      totalSize;
+    iString     pendingUrl; /* next prefetch */
+    iGmRequest *prefetch;   /* at most one at a time */
+};
+
+static iResponseCache cache_;
+
+#define maxEntries_ResponseCache    32
+#define maxSize_ResponseCache       (4 * 1000000) /* bytes, deflated */
+#define maxAge_ResponseCache        (5 * 60)      /* seconds */
+
+static void remove_ResponseCache_(iResponseCache *d, size_t pos) {
+    iCachedResponse *entry;
+    take_PtrArray(&d->entries, pos, (void **) &entry);
+    d->totalSize -= size_CachedResponse_(entry);
+    delete_CachedResponse_(entry);
+}
+
+static void prune_ResponseCache_(iResponseCache *d) {
+    for (size_t i = 0; i < size_PtrArray(&d->entries); ) {
+        const iCachedResponse *entry = constAt_PtrArray(&d->entries, i);
+        if (elapsedSeconds_Time(&entry->added) > maxAge_ResponseCache) {
+            remove_ResponseCache_(d, i);
+        }
+        else {
+            i++;
+        }
+    }
+    while (!isEmpty_PtrArray(&d->entries) && (size_PtrArray(&d->entries) > maxEntries_ResponseCache ||
+                                              d->totalSize > maxSize_ResponseCache)) {
+        remove_ResponseCache_(d, 0);
+    }
+}
+
+static size_t indexOf_ResponseCache_(const iResponseCache *d, const iString *url) {
+    iConstForEach(PtrArray, i, &d->entries) {
+        const iCachedResponse *entry = i.ptr;
+        if (equal_String(&entry->url, url)) {
+            return index_PtrArrayConstIterator(&i);
+        }
+    }
+    return iInvalidPos;
+}
+
+void init_ResponseCache(void) {
+    iResponseCache *d = &cache_;
+    init_PtrArray(&d->entries);
+    d->totalSize = 0;
+    init_String(&d->pendingUrl);
+    d->prefetch = NULL;
+}
+
+void deinit_ResponseCache(void) {
+    iResponseCache *d = &cache_;
+    cancelPrefetch_ResponseCache();
+    while (!isEmpty_PtrArray(&d->entries)) {
+        remove_ResponseCache_(d, 0);
+    }
+    deinit_String(&d->pendingUrl);
+    deinit_PtrArray(&d->entries);
+}
+
+iBool isCacheable_ResponseCache(const iString *url) {
+    iUrl parts;
+    init_Url(&parts, url);
+    /* Query responses are answers to one-off input, and pages requested with a client
+       certificate are personal. */
+    return equalCase_Rangecc(parts.scheme, "gemini") && isEmpty_Range(&parts.query) &&
+           !identityForUrl_GmCerts(certs_App(), url);
+}
+
+void add_ResponseCache(const iString *url, const iGmResponse *resp) {
+    iResponseCache *d = &cache_;
+    if (category_GmStatusCode(resp->statusCode) != categorySuccess_GmStatusCode ||
+        !startsWithCase_String(&resp->meta, "text/") || !isCacheable_ResponseCache(url)) {
+        return;
+    }
+    url = urlFragmentStripped_String(url);
+    const size_t pos = indexOf_ResponseCache_(d, url);
+    if (pos != iInvalidPos) {
+        remove_ResponseCache_(d, pos);
+    }
+    iCachedResponse *entry = iMalloc(CachedResponse);
+    initCopy_String(&entry->url, url);
+    initCurrent_Time(&entry->added);
+    entry->resp = copy_GmResponse(resp);
+    deflateBody_GmResponse(entry->resp);
+    d->totalSize += size_CachedResponse_(entry);
+    pushBack_PtrArray(&d->entries, entry);
+    prune_ResponseCache_(d);
+}
+
+const iGmResponse *find_ResponseCache(const iString *url) {
+    iResponseCache *d = &cache_;
+    if (!isCacheable_ResponseCache(url)) {
+        return NULL;
+    }
+    prune_ResponseCache_(d);
+    const size_t pos = indexOf_ResponseCache_(d, urlFragmentStripped_String(url));
+    if (pos == iInvalidPos) {
+        return NULL;
+    }
+    /* Move to the most recently used end. */
+    iCachedResponse *entry;
+    take_PtrArray(&d->entries, pos, (void **) &entry);
+    pushBack_PtrArray(&d->entries, entry);
+    return entry->resp;
+}
+
+/*----------------------------------------------------------------------------------------------*/
+
+static void prefetchFinished_ResponseCache_(iAnyObject *obj, iGmRequest *req) {
+    iUnused(obj);
+    postCommandf_App("responsecache.prefetched reqid:%u", id_GmRequest(req));
+}
+
+static void startPrefetch_ResponseCache_(iResponseCache *d) {
+    /* Prefetches have the lowest priority: they wait until no document is loading. */
+    if (d->prefetch || isEmpty_String(&d->pendingUrl) || !get_MainWindow() ||
+        isAnyDocumentRequestOngoing_MainWindow(get_MainWindow())) {
+        return;
+    }
+    d->prefetch = new_GmRequest(certs_App());
+    setUrl_GmRequest(d->prefetch, &d->pendingUrl);
+    clear_String(&d->pendingUrl);
+    iConnect(GmRequest, d->prefetch, finished, d, prefetchFinished_ResponseCache_);
+    submit_GmRequest(d->prefetch);
+}
+
+size_t memorySize_ResponseCache(void) {
+    return cache_.totalSize;
+}
+
+void prefetch_ResponseCache(const iString *url) {
+    iResponseCache *d = &cache_;
+    if (!prefs_App()->prefetchLinks || !url || !isCacheable_ResponseCache(url)) {
+        return;
+    }
+    url = urlFragmentStripped_String(url);
+    prune_ResponseCache_(d);
+    if (indexOf_ResponseCache_(d, url) != iInvalidPos ||
+        (d->prefetch && equal_String(url_GmRequest(d->prefetch), url))) {
+        return; /* already have it */
+    }
+    /* Only the latest wish is remembered; e.g., hovering over many links in a row. */
+    set_String(&d->pendingUrl, url);
+    startPrefetch_ResponseCache_(d);
+}
+
+void resumePrefetch_ResponseCache(void) {
+    startPrefetch_ResponseCache_(&cache_);
+}
+
+void cancelPrefetch_ResponseCache(void) {
+    iResponseCache *d = &cache_;
+    clear_String(&d->pendingUrl);
+    if (d->prefetch) {
+        iDisconnect(GmRequest, d->prefetch, finished, d, prefetchFinished_ResponseCache_);
+        cancel_GmRequest(d->prefetch);
+        iReleasePtr(&d->prefetch);
+    }
+}
+
+void prefetchFinished_ResponseCache(uint32_t requestId) {
+    iResponseCache *d = &cache_;
+    if (!d->prefetch || id_GmRequest(d->prefetch) != requestId) {
+        return; /* cancelled */
+    }
+    add_ResponseCache(url_GmRequest(d->prefetch), lockResponse_GmRequest(d->prefetch));
+    unlockResponse_GmRequest(d->prefetch);
+    iReleasePtr(&d->prefetch);
+    startPrefetch_ResponseCache_(d);
+}
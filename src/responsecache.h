@@ -0,0 +1,43 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+#pragma once
+
+#include "gmrequest.h"
+
+/* Shared, in-memory cache of recently received responses. Unlike the per-tab History, this
+   is keyed by URL only, so any tab can use a response that another tab (or a prefetch)
+   already received. Cached response bodies are deflated. Main thread only. */
+
+void                init_ResponseCache          (void);
+void                deinit_ResponseCache        (void);
+
+iBool               isCacheable_ResponseCache   (const iString *url);
+void                add_ResponseCache           (const iString *url, const iGmResponse *resp);
+const iGmResponse * find_ResponseCache          (const iString *url); /* body deflated */
+size_t              memorySize_ResponseCache    (void); /* bytes */
+
+void                prefetch_ResponseCache      (const iString *url);
+void                resumePrefetch_ResponseCache(void); /* call when document requests finish */
+void                cancelPrefetch_ResponseCache(void);
+void                prefetchFinished_ResponseCache(uint32_t requestId); /* "responsecache.prefetched" */
@@ -0,0 +1,176 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+#include "trace.h"
+
+#include <the_Foundation/array.h>
+#include <the_Foundation/file.h>
+#include <the_Foundation/mutex.h>
+#include <the_Foundation/time.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+iDeclareType(TraceEvent)
+
+struct Impl_TraceEvent {
+    const char *name;
+    char        phase; /* X: complete, b/e: async begin/end, C: counter */
+    int         tid;
+    int64_t     ts;
+    int64_t     value; /* duration, async ID, or counter value */
+};
+
+iDeclareType(TraceLog)
+
+struct Impl_TraceLog {
+    iMutex *mtx;
+    iFile * file;
+    int64_t startTime;
+    int     numThreads;
+    size_t  numWritten;
+    iArray  events; /* buffered until flushed to the file */
+};
+
+static iTraceLog trace_;
+static _Thread_local int threadId_; /* zero until first traced event on the thread */
+
+iBool isTraceEnabled_ = iFalse;
+
+#define flushThreshold_TraceLog    8192
+
+static int64_t now_Trace_(void) {
+    const iTime now = now_Time();
+    return (int64_t) now.ts.tv_sec * 1000000 + now.ts.tv_nsec / 1000;
+}
+
+static void flush_TraceLog_(iTraceLog *d) {
+    iString *out = new_String();
+    iConstForEach(Array, i, &d->events) {
+        const iTraceEvent *ev = i.value;
+        appendFormat_String(out,
+                            "%s{\"name\":\"%s\",\"ph\":\"%c\",\"pid\":1,\"tid\":%d,\"ts\":%lld",
+                            d->numWritten++ ? ",\n" : "",
+                            ev->name,
+                            ev->phase,
+                            ev->tid,
+                            (long long) (ev->ts - d->startTime));
+        switch (ev->phase) {
+            case 'X':
+                appendFormat_String(out, ",\"dur\":%lld}", (long long) ev->value);
+                break;
+            case 'b':
+            case 'e':
+                appendFormat_String(out, ",\"cat\":\"async\",\"id\":%lld}", (long long) ev->value);
+                break;
+            case 'C':
+                appendFormat_String(out, ",\"args\":{\"value\":%lld}}", (long long) ev->value);
+                break;
+        }
+    }
+    clear_Array(&d->events);
+    write_File(d->file, utf8_String(out));
+    delete_String(out);
+}
+
+static void add_TraceLog_(iTraceLog *d, const char *name, char phase, int64_t ts,
+                          int64_t value) {
+    lock_Mutex(d->mtx);
+    if (!isTraceEnabled_) {
+        /* Tracing was stopped after the caller checked the flag. */
+        unlock_Mutex(d->mtx);
+        return;
+    }
+    if (!threadId_) {
+        threadId_ = ++d->numThreads;
+    }
+    pushBack_Array(&d->events, &(iTraceEvent){ name, phase, threadId_, ts, value });
+    if (size_Array(&d->events) >= flushThreshold_TraceLog) {
+        flush_TraceLog_(d);
+    }
+    unlock_Mutex(d->mtx);
+}
+
+void init_Trace(const char *path) {
+    iTraceLog *d = &trace_;
+    if (!path) {
+        path = getenv("LAGRANGE_TRACE");
+    }
+    if (!path || !*path || isTraceEnabled_) {
+        return;
+    }
+    d->file = newCStr_File(path);
+    if (!open_File(d->file, writeOnly_FileMode | text_FileMode)) {
+        fprintf(stderr, "[Trace] failed to open %s for writing\n", path);
+        iReleasePtr(&d->file);
+        return;
+    }
+    if (!d->mtx) {
+        d->mtx = new_Mutex();
+    }
+    d->startTime  = now_Trace_();
+    d->numThreads = 0;
+    d->numWritten = 0;
+    init_Array(&d->events, sizeof(iTraceEvent));
+    writeData_File(d->file, "{\"traceEvents\":[\n", 17);
+    isTraceEnabled_ = iTrue;
+}
+
+void deinit_Trace(void) {
+    iTraceLog *d = &trace_;
+    if (!isTraceEnabled_) {
+        return;
+    }
+    /* Other threads may be tracing concurrently. Once the flag is cleared, no new events are
+       added, and ones waiting for the lock are dropped. */
+    isTraceEnabled_ = iFalse;
+    lock_Mutex(d->mtx);
+    flush_TraceLog_(d);
+    writeData_File(d->file, "\n]}\n", 4);
+    iReleasePtr(&d->file);
+    deinit_Array(&d->events);
+    unlock_Mutex(d->mtx);
+    /* The mutex is not deleted: a thread may have seen the flag still set and not yet
+       locked it. It is reused if tracing is started again. */
+}
+
+iTraceScope begin_TraceScope(const char *name) {
+    return (iTraceScope){ name, isTraceEnabled_ ? now_Trace_() : 0 };
+}
+
+void end_TraceScope(iTraceScope *d) {
+    if (d->start && isTraceEnabled_) {
+        add_TraceLog_(&trace_, d->name, 'X', d->start, now_Trace_() - d->start);
+    }
+}
+
+void beginAsync_Trace(const char *name, uint32_t id) {
+    add_TraceLog_(&trace_, name, 'b', now_Trace_(), id);
+}
+
+void endAsync_Trace(const char *name, uint32_t id) {
+    add_TraceLog_(&trace_, name, 'e', now_Trace_(), id);
+}
+
+void counter_Trace(const char *name, int64_t value) {
+    add_TraceLog_(&trace_, name, 'C', now_Trace_(), value);
+}
@@ -0,0 +1,86 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+
+#pragma once
+
+/* Performance tracing in the Chrome trace event format. The output can be viewed with
+   chrome://tracing or ui.perfetto.dev. Tracing is compiled in with the ENABLE_TRACE build
+   option, and turned on at runtime with `--trace FILE` or the LAGRANGE_TRACE environment
+   variable. When not compiled in, the macros below expand to empty statements.
+
+   Event names must be string literals (or otherwise remain valid until the trace ends). */
+
+#include "defs.h"
+
+#if defined (LAGRANGE_ENABLE_TRACE)
+
+iDeclareType(TraceScope)
+
+struct Impl_TraceScope {
+    const char *name;
+    int64_t     start; /* microseconds; zero if tracing is off */
+};
+
+void        init_Trace          (const char *path); /* NULL: check LAGRANGE_TRACE */
+void        deinit_Trace        (void);
+
+iTraceScope begin_TraceScope    (const char *name);
+void        end_TraceScope      (iTraceScope *);
+void        beginAsync_Trace    (const char *name, uint32_t id);
+void        endAsync_Trace      (const char *name, uint32_t id);
+void        counter_Trace       (const char *name, int64_t value);
+
+extern iBool isTraceEnabled_;
+
+iLocalDef iBool isEnabled_Trace(void) {
+    return isTraceEnabled_;
+}
+
+#define iTraceConcat_(a, b)         a##b
+#define iTraceVar_(line)            iTraceConcat_(traceScope_, line)
+
+/* Times the rest of the enclosing block. */
+#define iTrace(name)                iTraceScope iTraceVar_(__LINE__) \
+                                        __attribute__((cleanup(end_TraceScope))) = \
+                                        begin_TraceScope(name)
+#define iTraceAsyncBegin(name, id)  do { \
+                                        if (isTraceEnabled_) beginAsync_Trace(name, id); \
+                                    } while (0)
+#define iTraceAsyncEnd(name, id)    do { \
+                                        if (isTraceEnabled_) endAsync_Trace(name, id); \
+                                    } while (0)
+#define iTraceCounter(name, value)  do { \
+                                        if (isTraceEnabled_) counter_Trace(name, value); \
+                                    } while (0)
+
+#else
+
+iLocalDef void init_Trace(const char *path) { iUnused(path); }
+iLocalDef void deinit_Trace(void) {}
+
+#define iTrace(name)                do {} while (0)
+#define iTraceAsyncBegin(name, id)  do {} while (0)
+#define iTraceAsyncEnd(name, id)    do {} while (0)
+#define iTraceCounter(name, value)  do {} while (0)
+
+#endif
@@ -33,9 +33,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "gmutil.h"
 #include "media.h"
 #include "paint.h"
+#include "profiler.h"
+#include "responsecache.h"
 #include "root.h"
+#include "texturepool.h"
 #include "mediaui.h"
 #include "touch.h"
+#include "trace.h"
 #include "util.h"
 
 #if defined (iPlatformAppleDesktop)
@@ -67,6 +71,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 struct Impl_DrawBufs {
     int          flags;
     SDL_Texture *sideIconBuf;
+    iInt2        sideIconSize; /* used part of `sideIconBuf` */
     iTextBuf    *timestampBuf;
     uint32_t     lastRenderTime;
 };
@@ -74,15 +79,14 @@ struct Impl_DrawBufs {
 static void init_DrawBufs(iDrawBufs *d) {
     d->flags = 0;
     d->sideIconBuf = NULL;
+    d->sideIconSize = zero_I2();
     d->timestampBuf = NULL;
     d->lastRenderTime = 0;
 }
 
 static void deinit_DrawBufs(iDrawBufs *d) {
     delete_TextBuf(d->timestampBuf);
-    if (d->sideIconBuf) {
-        SDL_DestroyTexture(d->sideIconBuf);
-    }
+    release_TexturePool(d->sideIconBuf);
 }
 
 iDefineTypeConstruction(DrawBufs)
@@ -105,6 +109,7 @@ iDefineTypeConstruction(DocumentView)
 void init_DocumentView(iDocumentView *d) {
     d->owner         = NULL;
     d->doc           = new_GmDocument();
+    setLazyLayout_GmDocument(d->doc, iTrue);
     d->invalidRuns   = new_PtrSet();
     d->drawBufs      = new_DrawBufs();
     d->pageMargin    = 5;
@@ -417,7 +422,7 @@ void updateHover_DocumentView(iDocumentView *d, iInt2 mouse) {
             if (precedingRun && precedingRun->flags & decoration_GmRunFlag &&
                 precedingRun->flags & startOfLine_GmRunFlag &&
                 precedingRun->linkId == run->linkId) {
-                linkBounds = union_Rect(linkBounds, precedingRun->visBounds);
+                linkBounds = union_Rect(linkBounds, visBounds_GmRun(precedingRun));
             }
             /* Click targets are slightly expanded so there are no gaps between links. */
             if (contains_Rect(expanded_Rect(linkBounds, init1_I2(gap_Text / 2)), hoverPos)) {
@@ -432,6 +437,12 @@ void updateHover_DocumentView(iDocumentView *d, iInt2 mouse) {
         }
         if (d->hoverLink) {
             invalidateLink_DocumentView(d, d->hoverLink->linkId);
+            if (scheme_GmLinkFlag(linkFlags_GmDocument(d->doc, d->hoverLink->linkId)) ==
+                    gemini_GmLinkScheme &&
+                !isMediaLink_GmDocument(d->doc, d->hoverLink->linkId)) {
+                /* The user is likely to click on it. */
+                prefetch_ResponseCache(linkUrl_GmDocument(d->doc, d->hoverLink->linkId));
+            }
         }
         updateHoverLinkInfo_DocumentView(d);
         refresh_Widget(w);
@@ -511,6 +522,15 @@ int updateScrollMax_DocumentView(iDocumentView *d) {
 }
 
 void updateVisible_DocumentView(iDocumentView *d) {
+    /* A lazy layout must cover the visible area and the buffers prerendered around it. */ {
+        const iRangei vis = visibleRange_DocumentView(d);
+        if (layoutUntil_GmDocument(d->doc, vis.end + (int) numBuffers_VisBuf * size_Range(&vis))) {
+            documentRunsMoved_DocumentWidget(d->owner);
+        }
+        if (!isLayoutComplete_GmDocument(d->doc)) {
+            addTicker_App(continueLayout_DocumentWidget, d->owner);
+        }
+    }
     const int scrollMax = updateScrollMax_DocumentView(d);
     aboutToScrollView_DocumentWidget(d->owner, scrollMax); /* TODO: A widget may have many views. */
     unhover_DocumentView_(d);
@@ -628,7 +648,20 @@ void scrollTo_DocumentView(iDocumentView *d, int documentY, iBool centered) {
     updateVisible_DocumentView(d);
 }
 
+void finishLayout_DocumentView(iDocumentView *d) {
+    if (finishLayout_GmDocument(d->doc)) {
+        documentRunsMoved_DocumentWidget(d->owner);
+    }
+}
+
+void layoutUntilLoc_DocumentView(iDocumentView *d, const char *loc) {
+    if (layoutUntilLoc_GmDocument(d->doc, loc)) {
+        documentRunsMoved_DocumentWidget(d->owner);
+    }
+}
+
 void scrollToHeading_DocumentView(iDocumentView *d, const char *heading) {
+    finishLayout_DocumentView(d); /* all headings are needed */
     /* Try an exact match first and then try finding a prefix. */
     for (int pass = 0; pass < 2; pass++) {
         iConstForEach(Array, h, headings_GmDocument(d->doc)) {
@@ -765,7 +798,7 @@ size_t visibleLinkOrdinal_DocumentView(const iDocumentView *d, iGmLinkId linkId)
     const int ordinalPad = !isTerminal_Platform() ? -lineHeight_Text(paragraph_FontId) / 10 : 0;
     iConstForEach(PtrArray, i, &d->visibleLinks) {
         const iGmRun *run = i.ptr;
-        if (top_Rect(run->visBounds) >= visRange.start + ordinalPad) {
+        if (top_Rect(visBounds_GmRun(run)) >= visRange.start + ordinalPad) {
             if (run->flags & decoration_GmRunFlag && run->linkId) {
                 if (run->linkId == linkId) return ord;
                 ord++;
@@ -788,17 +821,20 @@ iBool updateDocumentWidthRetainingScrollPosition_DocumentView(iDocumentView *d,
     if (!keepCenter && run) {
         /* Keep the first visible run visible at the same position. */
         /* TODO: First *fully* visible run? */
-        voffset = visibleRange_DocumentView(d).start - top_Rect(run->visBounds);
+        voffset = visibleRange_DocumentView(d).start - top_Rect(visBounds_GmRun(run));
     }
     run = NULL;
     setWidth_GmDocument(d->doc, newWidth, width_Widget(d->owner));
     setWidth_Banner(d->banner, newWidth);
     documentRunsInvalidated_DocumentWidget(d->owner);
+    if (runLoc) {
+        layoutUntilLoc_GmDocument(d->doc, runLoc); /* runs were already invalidated */
+    }
     if (runLoc && !keepCenter) {
         run = findRunAtLoc_GmDocument(d->doc, runLoc);
         if (run) {
             scrollTo_DocumentView(
-                d, top_Rect(run->visBounds) + lineHeight_Text(paragraph_FontId) + voffset, iFalse);
+                d, top_Rect(visBounds_GmRun(run)) + lineHeight_Text(paragraph_FontId) + voffset, iFalse);
         }
     }
     else if (runLoc && keepCenter) {
@@ -894,7 +930,7 @@ static void fillRange_DrawContext_(iDrawContext *d, const iGmRun *run, enum iCol
             (contains_Range(&url, mark.end) || url.end == mark.end)) {
             fillRect_Paint(
                 &d->paint,
-                moved_Rect(run->visBounds, addY_I2(d->viewPos, viewPos_DocumentView(d->view))),
+                moved_Rect(visBounds_GmRun(run), addY_I2(d->viewPos, viewPos_DocumentView(d->view))),
                 color);
         }
     }
@@ -922,9 +958,10 @@ static void drawRun_DrawContext_(void *context, const iGmRun *run) {
     if (run->mediaType == image_MediaType) {
         iMedia      *media = media_GmDocument(d->view->doc);
         SDL_Texture *tex   = imageTexture_Media(media, mediaId_GmRun(run));
-        const iRect  dst   = moved_Rect(run->visBounds, origin);
+        const iRect  dst   = moved_Rect(visBounds_GmRun(run), origin);
         if (tex) {
             fillRect_Paint(&d->paint, dst, tmBackground_ColorId); /* in case the image has alpha */
+            iCountFrame(renderCopies);
             SDL_RenderCopy(d->paint.dst->render, tex, NULL,
                         &(SDL_Rect){ dst.pos.x, dst.pos.y, dst.size.x, dst.size.y });
             return;
@@ -951,10 +988,10 @@ static void drawRun_DrawContext_(void *context, const iGmRun *run) {
                                  run->linkId == d->view->hoverLink->linkId);
     iBool isHover = (isPartOfHover && ~run->flags & decoration_GmRunFlag);
     /* Visible (scrolled) position of the run. */
-    const iInt2 visPos = addX_I2(add_I2(run->visBounds.pos, origin),
+    const iInt2 visPos = addX_I2(add_I2(visBounds_GmRun(run).pos, origin),
                                  /* Preformatted runs can be scrolled. */
                                  runOffset_DocumentView_(d->view, run));
-    const iRect visRect = { visPos, run->visBounds.size };
+    const iRect visRect = { visPos, visBounds_GmRun(run).size };
     /* Fill the background. */ {
         iBool isMobileHover = deviceType_App() != desktop_AppDeviceType &&
                               (isPartOfHover || contains_PtrSet(d->view->invalidRuns, run)) &&
@@ -977,7 +1014,7 @@ static void drawRun_DrawContext_(void *context, const iGmRun *run) {
             else {
                 wideRect =
                     (iRect){ init_I2(origin.x - pad, visPos.y),
-                             init_I2(d->docBounds.size.x + 2 * pad, height_Rect(run->visBounds)) };
+                             init_I2(d->docBounds.size.x + 2 * pad, height_Rect(visBounds_GmRun(run))) };
                 adjustEdges_Rect(&wideRect,
                                  run->flags & startOfLine_GmRunFlag ? -pad * 3 / 4 : 0, 0,
                                  run->flags & endOfLine_GmRunFlag ? pad * 3 / 4 : 0, 0);
@@ -1042,11 +1079,11 @@ static void drawRun_DrawContext_(void *context, const iGmRun *run) {
     }
     if (run->flags & altText_GmRunFlag) {
         const iInt2 margin = preRunMargin_GmDocument(doc, preId_GmRun(run));
-        fillRect_Paint(&d->paint, (iRect){ visPos, run->visBounds.size }, tmBackgroundAltText_ColorId);
-        drawRect_Paint(&d->paint, (iRect){ visPos, run->visBounds.size }, tmFrameAltText_ColorId);
+        fillRect_Paint(&d->paint, (iRect){ visPos, visBounds_GmRun(run).size }, tmBackgroundAltText_ColorId);
+        drawRect_Paint(&d->paint, (iRect){ visPos, visBounds_GmRun(run).size }, tmFrameAltText_ColorId);
         drawWrapRange_Text(run->font,
                            add_I2(visPos, margin),
-                           run->visBounds.size.x - 2 * margin.x,
+                           visBounds_GmRun(run).size.x - 2 * margin.x,
                            run->color,
                            run->text);
     }
@@ -1081,18 +1118,18 @@ static void drawRun_DrawContext_(void *context, const iGmRun *run) {
             }
         }
         if (run->flags & ruler_GmRunFlag) {
-            if (height_Rect(run->visBounds) > 0) {
+            if (height_Rect(visBounds_GmRun(run)) > 0) {
                 /* This is used for block quotes. */
                 drawVLine_Paint(&d->paint,
                                 addX_I2(visPos,
                                         !run->isRTL
                                             ? -gap_Text * 5 / 2
-                                            : (width_Rect(run->visBounds) + gap_Text * 5 / 2)),
-                                height_Rect(run->visBounds),
+                                            : (width_Rect(visBounds_GmRun(run)) + gap_Text * 5 / 2)),
+                                height_Rect(visBounds_GmRun(run)),
                                 tmQuoteIcon_ColorId);
             }
             else {
-                drawHLine_Paint(&d->paint, visPos, width_Rect(run->visBounds), tmQuoteIcon_ColorId);
+                drawHLine_Paint(&d->paint, visPos, width_Rect(visBounds_GmRun(run)), tmQuoteIcon_ColorId);
             }
         }
         /* Base attributes. */ {
@@ -1148,7 +1185,7 @@ static void drawRun_DrawContext_(void *context, const iGmRun *run) {
         const int metaFont = paragraph_FontId;
         /* TODO: Show status of an ongoing media request. */
         const int flags = linkFlags;
-        const iRect linkRect = moved_Rect(run->visBounds, origin);
+        const iRect linkRect = moved_Rect(visBounds_GmRun(run), origin);
         iMediaRequest *mr = NULL;
         /* Show metadata about inline content. */
         if (flags & content_GmLinkFlag && run->flags & endOfLine_GmRunFlag) {
@@ -1215,7 +1252,7 @@ static void drawRun_DrawContext_(void *context, const iGmRun *run) {
     /* Debug. */
     if (0) {
         drawRect_Paint(&d->paint, (iRect){ visPos, run->bounds.size }, green_ColorId);
-        drawRect_Paint(&d->paint, (iRect){ visPos, run->visBounds.size },
+        drawRect_Paint(&d->paint, (iRect){ visPos, visBounds_GmRun(run).size },
                        run->linkId ? orange_ColorId : red_ColorId);
     }
 }
@@ -1250,10 +1287,8 @@ static void updateSideIconBuf_DocumentView_(const iDocumentView *d) {
     }
     iDrawBufs *dbuf = d->drawBufs;
     dbuf->flags &= ~updateSideBuf_DrawBufsFlag;
-    if (dbuf->sideIconBuf) {
-        SDL_DestroyTexture(dbuf->sideIconBuf);
-        dbuf->sideIconBuf = NULL;
-    }
+    release_TexturePool(dbuf->sideIconBuf);
+    dbuf->sideIconBuf = NULL;
     //    const iGmRun *banner = siteBanner_GmDocument(d->doc);
     if (isEmpty_Banner(d->banner)) {
         return;
@@ -1278,10 +1313,8 @@ static void updateSideIconBuf_DocumentView_(const iDocumentView *d) {
         }
     }
     SDL_Renderer *render = renderer_Window(get_Window());
-    dbuf->sideIconBuf = SDL_CreateTexture(render,
-                                          SDL_PIXELFORMAT_RGBA4444,
-                                          SDL_TEXTUREACCESS_STATIC | SDL_TEXTUREACCESS_TARGET,
-                                          bufSize.x, bufSize.y);
+    dbuf->sideIconBuf  = acquire_TexturePool(render, SDL_PIXELFORMAT_RGBA4444, bufSize);
+    dbuf->sideIconSize = bufSize;
     iPaint p;
     init_Paint(&p);
     beginTarget_Paint(&p, dbuf->sideIconBuf);
@@ -1334,7 +1367,7 @@ static void drawSideElements_DocumentView_(const iDocumentView *d, int horizOffs
     setClip_Paint(&p, boundsWithoutVisualOffset_Widget(w));
     /* Side icon and current heading. */
     if (prefs_App()->sideIcon && opacity > 0 && dbuf->sideIconBuf) {
-        const iInt2 texSize = size_SDLTexture(dbuf->sideIconBuf);
+        const iInt2 texSize = dbuf->sideIconSize;
         if (avail > texSize.x) {
             const int minBannerSize = lineHeight_Text(banner_FontId) * 2;
             iInt2 pos = addY_I2(add_I2(topLeft_Rect(bounds), init_I2(margin, 0)),
@@ -1343,8 +1376,9 @@ static void drawSideElements_DocumentView_(const iDocumentView *d, int horizOffs
                                          ? (gap_Text + lineHeight_Text(heading3_FontId)) / 2
                                          : 0));
             SDL_SetTextureAlphaMod(dbuf->sideIconBuf, 255 * opacity);
+            iCountFrame(renderCopies);
             SDL_RenderCopy(renderer_Window(get_Window()),
-                           dbuf->sideIconBuf, NULL,
+                           dbuf->sideIconBuf, &(SDL_Rect){ 0, 0, texSize.x, texSize.y },
                            &(SDL_Rect){ pos.x + horizOffset, pos.y, texSize.x, texSize.y });
         }
     }
@@ -1394,6 +1428,7 @@ static void extend_GmRunRange_(iGmRunRange *runs) {
 }
 
 static iBool render_DocumentView_(const iDocumentView *d, iDrawContext *ctx, iBool prerenderExtra) {
+    iTrace("render_DocumentView");
     iBool       didDraw = iFalse;
     const iRect bounds  = bounds_Widget(constAs_Widget(d->owner));
     const iRect ctxWidgetBounds =
@@ -1454,7 +1489,7 @@ static iBool render_DocumentView_(const iDocumentView *d, iDrawContext *ctx, iBo
                                                                               ctx);
                         if (ctx->runsDrawn.start) {
                             /* Something was actually drawn, so update the valid range. */
-                            const int newTop = top_Rect(ctx->runsDrawn.start->visBounds);
+                            const int newTop = top_Rect(visBounds_GmRun(ctx->runsDrawn.start));
                             if (newTop != buf->validRange.start) {
                                 didDraw = iTrue;
                                 // printf("render: valid:%d->%d run:%p->%p\n",
@@ -1512,7 +1547,7 @@ static iBool render_DocumentView_(const iDocumentView *d, iDrawContext *ctx, iBo
                                                                 ctx);
                             if (next && meta->runsDrawn.start != next) {
                                 meta->runsDrawn.start = next;
-                                buf->validRange.start = bottom_Rect(next->visBounds);
+                                buf->validRange.start = bottom_Rect(visBounds_GmRun(next));
                                 didDraw = iTrue;
                             }
                             else {
@@ -1531,7 +1566,7 @@ static iBool render_DocumentView_(const iDocumentView *d, iDrawContext *ctx, iBo
                                                                 ctx);
                             if (next && meta->runsDrawn.end != next) {
                                 meta->runsDrawn.end = next;
-                                buf->validRange.end = top_Rect(next->visBounds);
+                                buf->validRange.end = top_Rect(visBounds_GmRun(next));
                                 didDraw = iTrue;
                             }
                             else {
@@ -1547,14 +1582,14 @@ static iBool render_DocumentView_(const iDocumentView *d, iDrawContext *ctx, iBo
                 /* Clear full-width backgrounds first in case there are any dynamic elements. */ {
                     iConstForEach(PtrSet, r, d->invalidRuns) {
                         const iGmRun *run = *r.value;
-                        if (isOverlapping_Rangei(bufRange, ySpan_Rect(run->visBounds))) {
+                        if (isOverlapping_Rangei(bufRange, ySpan_Rect(visBounds_GmRun(run)))) {
                             beginTarget_Paint(p, buf->texture);
                             fillRect_Paint(p,
-                                           moved_Rect(run->visBounds, init_I2(0, -buf->origin)),/*
+                                           moved_Rect(visBounds_GmRun(run), init_I2(0, -buf->origin)),/*
                                            init_Rect(0,
-                                                     run->visBounds.pos.y - buf->origin,
+                                                     visBounds_GmRun(run).pos.y - buf->origin,
                                                      visBuf->texSize.x,
-                                                     run->visBounds.size.y),*/
+                                                     visBounds_GmRun(run).size.y),*/
                                            tmBackground_ColorId);
                         }
                     }
@@ -1562,13 +1597,16 @@ static iBool render_DocumentView_(const iDocumentView *d, iDrawContext *ctx, iBo
                 setAnsiFlags_Text(ansiEscapes_GmDocument(d->doc));
                 iConstForEach(PtrSet, r, d->invalidRuns) {
                     const iGmRun *run = *r.value;
-                    if (isOverlapping_Rangei(bufRange, ySpan_Rect(run->visBounds))) {
+                    if (isOverlapping_Rangei(bufRange, ySpan_Rect(visBounds_GmRun(run)))) {
                         beginTarget_Paint(p, buf->texture);
                         drawRun_DrawContext_(ctx, run);
                     }
                 }
                 setAnsiFlags_Text(allowAll_AnsiFlag);
             }
+            if (p->setTarget) {
+                iCountFrame(visBufRedraws);
+            }
             endTarget_Paint(p);
             if (prerenderExtra && didDraw) {
                 /* Just a run at a time. */
@@ -1586,6 +1624,15 @@ uint32_t lastRenderTime_DocumentView(const iDocumentView *d) {
     return d->drawBufs->lastRenderTime;
 }
 
+size_t textureMemorySize_DocumentView(const iDocumentView *d) {
+    size_t size = memorySize_VisBuf(d->visBuf);
+    if (d->drawBufs->sideIconBuf) {
+        const iInt2 texSize = d->drawBufs->sideIconSize;
+        size += 4 * texSize.x * texSize.y;
+    }
+    return size;
+}
+
 void prerender_DocumentView(iAny *context) {
     //iAssert(isInstance_Object(context, &Class_DocumentWidget));
     iDocumentView *d = context;
@@ -1786,6 +1833,9 @@ void draw_DocumentView(const iDocumentView *d, int horizOffset) {
 }
 
 void resetScrollPosition_DocumentView(iDocumentView *d, float normScrollY) {
+    if (normScrollY > 0) {
+        finishLayout_DocumentView(d); /* estimated page height is not accurate enough */
+    }
     resetScroll_DocumentView(d);
     init_Anim(&d->scrollY.pos, normScrollY * pageHeight_DocumentView(d));
     updateVisible_DocumentView(d);
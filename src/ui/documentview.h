@@ -91,6 +91,8 @@ void    updateDrawBufs_DocumentView     (iDocumentView *, int drawBufsFlags);
 iBool   updateWidth_DocumentView        (iDocumentView *);
 iBool   updateDocumentWidthRetainingScrollPosition_DocumentView (iDocumentView *, iBool keepCenter);
 int     updateScrollMax_DocumentView    (iDocumentView *);
+void    finishLayout_DocumentView       (iDocumentView *);
+void    layoutUntilLoc_DocumentView     (iDocumentView *, const char *loc);
 void    clampScroll_DocumentView        (iDocumentView *);
 void    immediateScroll_DocumentView    (iDocumentView *, int offset);
 void    smoothScroll_DocumentView       (iDocumentView *, int offset, int duration);
@@ -117,5 +119,6 @@ const iGmRun *lastVisibleLink_DocumentView(const iDocumentView *);
 size_t  visibleLinkOrdinal_DocumentView (const iDocumentView *, iGmLinkId linkId);
 
 uint32_t lastRenderTime_DocumentView    (const iDocumentView *);
+size_t  textureMemorySize_DocumentView  (const iDocumentView *); /* bytes */
 void    prerender_DocumentView          (iAny *); /* ticker */
 void    draw_DocumentView               (const iDocumentView *, int horizOffset);
@@ -47,6 +47,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "media.h"
 #include "paint.h"
 #include "periodic.h"
+#include "responsecache.h"
 #include "root.h"
 #include "mediaui.h"
 #include "scrollwidget.h"
@@ -299,6 +300,8 @@ struct Impl_DocumentWidget {
     iGempub *      sourceGempub; /* NULL unless the page is Gempub content */
     iBanner *      banner;
     float          initNormScrollY;
+    iTime          lastVisibleTime;
+    iBlock *       hibernatedContent; /* compressed `sourceContent` while hibernating */
 
     /* Rendering: */
     iDocumentView *view;
@@ -336,6 +339,7 @@ static int docEnum_ = 0;
 static void animateMedia_DocumentWidget_            (iDocumentWidget *d);
 static void updateSideIconBuf_DocumentWidget_       (const iDocumentWidget *d);
 static iBool requestMedia_DocumentWidget_           (iDocumentWidget *d, iGmLinkId linkId, iBool enableFilters);
+static void prefetchNextPage_DocumentWidget_        (const iDocumentWidget *d);
 
 iRangecc selectionMark_DocumentWidget(const iDocumentWidget *d) {
     /* Normalize so start < end. */
@@ -502,6 +506,15 @@ void documentRunsInvalidated_DocumentWidget(iDocumentWidget *d) {
     documentRunsInvalidated_DocumentView(d->view);
 }
 
+void documentRunsMoved_DocumentWidget(iDocumentWidget *d) {
+    /* Selection and find marks point to the source, so they remain valid. */
+    d->contextLink   = NULL;
+    d->grabbedPlayer = NULL;
+    d->view->animWideRunId = 0;
+    documentRunsInvalidated_DocumentView(d->view);
+    invalidate_DocumentView(d->view);
+}
+
 static void enableActions_DocumentWidget_(iDocumentWidget *d, iBool enable) {
     /* Actions are invisible child widgets of the DocumentWidget. */
     iForEach(ObjectList, i, children_Widget(d)) {
@@ -903,6 +916,12 @@ static void allocView_DocumentWidget_(iDocumentWidget *d) {
     d->view->foundMark  = &d->foundMark;
 }
 
+static void discardHibernatedContent_DocumentWidget_(iDocumentWidget *d) {
+    /* The source is being replaced, so the compressed copy is no longer needed. */
+    delete_Block(d->hibernatedContent);
+    d->hibernatedContent = NULL;
+}
+
 static void releaseViewDocument_DocumentWidget_(iDocumentWidget *d) {
     if (d->flags & swipeAborted_DocumentWidgetFlag) {
         resetSwipeAnimation_DocumentWidget_(d);
@@ -918,6 +937,7 @@ static void releaseViewDocument_DocumentWidget_(iDocumentWidget *d) {
     }
     iRelease(d->view->doc);
     d->view->doc = NULL;
+    discardHibernatedContent_DocumentWidget_(d);
     iChangeFlags(d->flags, viewWasSwipedAway_DocumentWidgetFlag, iFalse);
 }
 
@@ -1610,6 +1630,49 @@ static void updateDocument_DocumentWidget_(iDocumentWidget *d,
     }
 }
 
+static iBool hibernate_DocumentWidget_(iDocumentWidget *d) {
+    /* Background tabs that have not been looked at in a while release their layout.
+       Only a compressed copy of the source is kept. */
+    static const int hibernateAfterSeconds_ = 10 * 60;
+    const iWidget *w = constAs_Widget(d);
+    if (isHibernating_DocumentWidget(d) || isVisible_Widget(w) ||
+        elapsedSeconds_Time(&d->lastVisibleTime) < hibernateAfterSeconds_) {
+        return iFalse;
+    }
+    if (d->state != ready_RequestState || d->request || !isEmpty_ObjectList(d->media) ||
+        d->sourceGempub || d->translation || d->flags & viewSource_DocumentWidgetFlag ||
+        numActivePlayers_Media(constMedia_GmDocument(d->view->doc))) {
+        return iFalse;
+    }
+    const float normScrollY = normScrollPos_DocumentView(d->view);
+    if (!hibernate_GmDocument(d->view->doc)) {
+        return iFalse;
+    }
+    d->hibernatedContent = compress_Block(&d->sourceContent);
+    clear_Block(&d->sourceContent);
+    d->initNormScrollY = normScrollY;
+    documentRunsInvalidated_DocumentWidget(d);
+    updateVisible_DocumentView(d->view);
+    dealloc_VisBuf(d->view->visBuf);
+    return iTrue;
+}
+
+static void wake_DocumentWidget_(iDocumentWidget *d) {
+    initCurrent_Time(&d->lastVisibleTime);
+    if (!isHibernating_DocumentWidget(d)) {
+        return;
+    }
+    iBlock *content = decompress_Block(d->hibernatedContent);
+    set_Block(&d->sourceContent, content);
+    delete_Block(content);
+    delete_Block(d->hibernatedContent);
+    d->hibernatedContent = NULL;
+    wake_GmDocument(d->view->doc);
+    updateOpenURLs_GmDocument(d->view->doc);
+    documentWasChanged_DocumentWidget_(d);
+    resetScrollPosition_DocumentView(d->view, d->initNormScrollY);
+}
+
 static iBool fetch_DocumentWidget_(iDocumentWidget *d) {
     /* We may be instructed to wait before fetching to avoid congestion. */
     if (d->flags & waitForIdle_DocumentWidgetFlag) {
@@ -1789,8 +1852,12 @@ static void updateWidthAndRedoLayout_DocumentWidget_(iDocumentWidget *d) {
 }
 
 static void updateFromCachedResponse_DocumentWidget_(iDocumentWidget *d, float normScrollY,
-                                                     const iGmResponse *resp, iGmDocument *cachedDoc) {
+                                                     const iGmResponse *cachedResp,
+                                                     iGmDocument *cachedDoc) {
 //    iAssert(width_Widget(d) > 0); /* must be laid out by now */
+    /* History keeps the response body deflated. */
+    iGmResponse *resp = copy_GmResponse(cachedResp);
+    inflateBody_GmResponse(resp);
     setLinkNumberMode_DocumentWidget_(d, iFalse);
     clear_ObjectList(d->media);
     delete_Gempub(d->sourceGempub);
@@ -1801,6 +1868,7 @@ static void updateFromCachedResponse_DocumentWidget_(iDocumentWidget *d, float n
     releaseViewDocument_DocumentWidget_(d);
     invalidate_DocumentView(d->view);
     d->view->doc = new_GmDocument();
+    setLazyLayout_GmDocument(d->view->doc, iTrue);
     d->state = fetching_RequestState;
     d->flags &= ~pendingRedirect_DocumentWidgetFlag;
     d->flags |= fromCache_DocumentWidgetFlag;
@@ -1820,6 +1888,7 @@ static void updateFromCachedResponse_DocumentWidget_(iDocumentWidget *d, float n
         updateBanner_DocumentWidget_(d);
         addBannerWarnings_DocumentWidget_(d);
     }
+    delete_GmResponse(resp);
     d->state = ready_RequestState;
     postProcessRequestContent_DocumentWidget_(d, iTrue);
     resetScrollPosition_DocumentView(d->view, d->initNormScrollY);
@@ -1830,11 +1899,29 @@ static void updateFromCachedResponse_DocumentWidget_(iDocumentWidget *d, float n
         as_Widget(d)->root, "document.changed doc:%p url:%s", d, cstr_String(d->mod.url));
 }
 
+static iBool updateFromResponseCache_DocumentWidget_(iDocumentWidget *d) {
+    const iGmResponse *cached = find_ResponseCache(d->mod.url);
+    if (!cached) {
+        return iFalse;
+    }
+    iGmResponse *resp = copy_GmResponse(cached); /* body deflated */
+    updateFromCachedResponse_DocumentWidget_(d, 0.0f, resp, NULL);
+    /* Navigating back here should not need a fetch, either. */
+    set_Block(&resp->body, &d->sourceContent);
+    setCachedResponse_History(d->mod.history, resp);
+    setCachedDocument_History(d->mod.history, d->view->doc);
+    delete_GmResponse(resp);
+    return iTrue;
+}
+
 static iBool updateFromHistory_DocumentWidget_(iDocumentWidget *d, iBool useCachedDoc) {
     const iRecentUrl *recent = constMostRecentUrl_History(d->mod.history);
     setIdentity_DocumentWidget(d, recent ? &recent->setIdentity : NULL);
     if (recent && recent->cachedResponse && equalCase_String(&recent->url, d->mod.url)) {
         iGmDocument *cachedDoc = (useCachedDoc ? recent->cachedDoc : NULL);
+        if (cachedDoc) {
+            wake_GmDocument(cachedDoc); /* may be shared with a hibernating tab */
+        }
         updateFromCachedResponse_DocumentWidget_(
             d, recent->normScrollY, recent->cachedResponse, cachedDoc);
         if (!cachedDoc) {
@@ -1962,6 +2049,35 @@ void refreshWhileScrolling_DocumentWidget(iAny *ptr) {
     }
 }
 
+void continueLayout_DocumentWidget(iAny *ptr) {
+    iAssert(isInstance_Object(ptr, &Class_DocumentWidget));
+    static const double sliceSeconds_ = 0.004;
+    iDocumentWidget *d = ptr;
+    if (flags_Widget(ptr) & destroyPending_WidgetFlag || !d->view->doc ||
+        isLayoutComplete_GmDocument(d->view->doc)) {
+        return;
+    }
+    if (continueLayout_GmDocument(d->view->doc, sliceSeconds_)) {
+        documentRunsMoved_DocumentWidget(d);
+        updateVisible_DocumentView(d->view);
+    }
+    else {
+        /* The rest of the page is below the visible area; only the scroll bar changes. */
+        aboutToScrollView_DocumentWidget(d, updateScrollMax_DocumentView(d->view));
+    }
+    refresh_Widget(d);
+    if (!isLayoutComplete_GmDocument(d->view->doc)) {
+        addTicker_App(continueLayout_DocumentWidget, d);
+        return;
+    }
+    /* Things that need the entire document. */
+    updateWindowTitle_DocumentWidget_(d);
+    if (d->state == ready_RequestState) {
+        prefetchNextPage_DocumentWidget_(d);
+    }
+    postCommandf_Root(as_Widget(d)->root, "document.layout.finished doc:%p", d);
+}
+
 void scrollBegan_DocumentWidget(iAnyObject *any, int offset, uint32_t duration) {
     iDocumentWidget *d = any;
     /* Get rid of link numbers when scrolling. */
@@ -2817,6 +2933,54 @@ static iBool tryWaitingFetch_DocumentWidget_(iDocumentWidget *d) {
     return iFalse;
 }
 
+static iBool isNextPageLabel_(iRangecc label) {
+    trim_Rangecc(&label);
+    static const char *prefixes[] = { "next", "older" };
+    iForIndices(i, prefixes) {
+        const size_t len = strlen(prefixes[i]);
+        if (startsWithCase_Rangecc(label, prefixes[i]) &&
+            (size_Range(&label) == len || !isalpha((unsigned char) label.start[len]))) {
+            return iTrue;
+        }
+    }
+    return endsWith_Rangecc(label, "\u2192") || endsWith_Rangecc(label, "\u00bb") ||
+           endsWith_Rangecc(label, "->");
+}
+
+static void updateFindCount_DocumentWidget_(const iDocumentWidget *d) {
+    /* Show the position of the found mark among all the matches. */
+    iLabelWidget *count = findWidget_App("find.count");
+    if (!count) {
+        return;
+    }
+    const iString *text = text_InputWidget(findWidget_App("find.input"));
+    const size_t   ord  = d->foundMark.start
+                              ? matchOrdinal_GmDocument(d->view->doc, text, d->foundMark.start)
+                              : iInvalidPos;
+    updateTextAndResizeWidthCStr_LabelWidget(
+        count,
+        ord != iInvalidPos
+            ? format_CStr("%zu/%zu", ord + 1, numMatches_GmDocument(d->view->doc, text))
+            : "");
+    arrange_Widget(parent_Widget(count));
+}
+
+static void prefetchNextPage_DocumentWidget_(const iDocumentWidget *d) {
+    const iGmDocument *doc = d->view->doc;
+    if (!prefs_App()->prefetchLinks || !isSuccess_GmStatusCode(d->sourceStatus) ||
+        !startsWithCase_String(&d->sourceMime, "text/gemini")) {
+        return;
+    }
+    /* Pagination links tend to be at the bottom of the page. */
+    for (size_t linkId = numLinks_GmDocument(doc); linkId > 0; linkId--) {
+        if (scheme_GmLinkFlag(linkFlags_GmDocument(doc, linkId)) == gemini_GmLinkScheme &&
+            isNextPageLabel_(linkLabel_GmDocument(doc, linkId))) {
+            prefetch_ResponseCache(linkUrl_GmDocument(doc, linkId));
+            break;
+        }
+    }
+}
+
 static const char *setIdentArg_DocumentWidget_(const iDocumentWidget *d, const iString *dstUrl) {
     if (isIdentityPinned_DocumentWidget(d) &&
         isSetIdentityRetained_DocumentWidget(d, dstUrl)) {
@@ -2926,6 +3090,7 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
     else if (equal_Command(cmd, "tabs.changed")) {
         setLinkNumberMode_DocumentWidget_(d, iFalse);
         if (cmp_String(id_Widget(w), suffixPtr_Command(cmd, "id")) == 0) {
+            wake_DocumentWidget_(d);
             /* Set palette for our document. */
             updateTheme_DocumentWidget_(d);
             updateTrust_DocumentWidget_(d, NULL);
@@ -3013,6 +3178,7 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
         return iFalse;
     }
     else if (equal_Command(cmd, "document.visitlinks") && d == document_App()) {
+        finishLayout_DocumentView(d->view); /* all links */
         const iGmDocument *doc = d->view->doc;
         for (size_t linkId = 1; linkId <= numLinks_GmDocument(doc); linkId++) {
             const iString *url = linkUrl_GmDocument(doc, linkId);
@@ -3303,6 +3469,7 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
         iChangeFlags(d->flags, fromCache_DocumentWidgetFlag | preventInlining_DocumentWidgetFlag,
                      iFalse);
         iChangeFlags(d->flags, proxyRequest_DocumentWidgetFlag, isProxy_GmRequest(d->request));
+        discardHibernatedContent_DocumentWidget_(d);
         set_Block(&d->sourceContent, body_GmRequest(d->request));
         if (!isSuccess_GmStatusCode(status_GmRequest(d->request))) {
             /* TODO: Why is this here? Can it be removed? */
@@ -3332,6 +3499,11 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
                 setCachedResponse_History(d->mod.history, lockResponse_GmRequest(d->request));
                 unlockResponse_GmRequest(d->request);
             }
+            /* Other tabs may reuse the response, too. */
+            if (!isIdentityPinned_DocumentWidget(d)) {
+                add_ResponseCache(url_GmRequest(d->request), lockResponse_GmRequest(d->request));
+                unlockResponse_GmRequest(d->request);
+            }
         }
         iReleasePtr(&d->request);
         updateVisible_DocumentView(d->view);
@@ -3357,6 +3529,8 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
                     }
                 }
             }
+            prefetchNextPage_DocumentWidget_(d);
+            resumePrefetch_ResponseCache();
         }
         /* Reactivate numbered links mode. */
         if (document_App() == d && isDown_Keys(findCommand_Keys("document.linkkeys arg:0"))) {
@@ -3666,6 +3840,7 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
         return iTrue;
     }
     else if (equal_Command(cmd, "scroll.bottom") && document_App() == d) {
+        finishLayout_DocumentView(d->view);
         if (argLabel_Command(cmd, "smooth")) {
             stopWidgetMomentum_Touch(w);
             smoothScroll_DocumentView(d->view, d->view->scrollY.max, 400);
@@ -3705,9 +3880,10 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
             return iTrue;
         }
         const char *loc = pointerLabel_Command(cmd, "loc");
+        layoutUntilLoc_DocumentView(d->view, loc);
         const iGmRun *run = findRunAtLoc_GmDocument(d->view->doc, loc);
         if (run) {
-            scrollTo_DocumentView(d->view, run->visBounds.pos.y, iFalse);
+            scrollTo_DocumentView(d->view, visBounds_GmRun(run).pos.y, iFalse);
         }
         return iTrue;
     }
@@ -3730,12 +3906,14 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
             }
             if (d->foundMark.start) {
                 const iGmRun *found;
+                layoutUntilLoc_DocumentView(d->view, d->foundMark.start);
                 if ((found = findRunAtLoc_GmDocument(d->view->doc, d->foundMark.start)) != NULL) {
                     scrollTo_DocumentView(d->view, mid_Rect(found->bounds).y, iTrue);
                     updateVisible_DocumentView(d->view);
                 }
             }
         }
+        updateFindCount_DocumentWidget_(d);
         if (flags_Widget(w) & touchDrag_WidgetFlag) {
             postCommand_Root(w->root, "document.select arg:0"); /* we can't handle both at the same time */
         }
@@ -3746,11 +3924,13 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
     else if (equal_Command(cmd, "find.clearmark")) {
         if (d->foundMark.start) {
             d->foundMark = iNullRange;
+            updateFindCount_DocumentWidget_(d);
             refresh_Widget(w);
         }
         return iTrue;
     }
     else if (equal_Command(cmd, "bookmark.links") && document_App() == d) {
+        finishLayout_DocumentView(d->view); /* all links and headings */
         iIntSet *linkIds = collectNew_IntSet();
         /* Find links that aren't already bookmarked. */
         const iGmDocument *doc = d->view->doc;
@@ -3868,6 +4048,13 @@ static iBool handleCommand_DocumentWidget_(iDocumentWidget *d, const char *cmd)
         showOrHideIndicators_DocumentWidget_(d);
     }
     else if (equal_Command(cmd, "document.autoreload")) {
+        /* This is posted once per minute, so also check if the tab should hibernate. */
+        if (isVisible_Widget(w)) {
+            wake_DocumentWidget_(d);
+        }
+        else {
+            hibernate_DocumentWidget_(d);
+        }
         if (d->mod.reloadInterval) {
             if (!isValid_Time(&d->sourceTime) || elapsedSeconds_Time(&d->sourceTime) >=
                     seconds_ReloadInterval_(d->mod.reloadInterval)) {
@@ -5307,6 +5494,8 @@ void init_DocumentWidget(iDocumentWidget *d) {
     iZap(d->sourceTime);
     d->sourceGempub    = NULL;
     d->initNormScrollY = 0;
+    initCurrent_Time(&d->lastVisibleTime);
+    d->hibernatedContent = NULL;
     d->grabbedPlayer   = NULL;
     d->mediaTimer      = 0;
     init_String(&d->pendingGotoHeading);
@@ -5365,6 +5554,7 @@ void deinit_DocumentWidget(iDocumentWidget *d) {
     deinit_String(&d->linePrecedingLink);
     deinit_String(&d->pendingGotoHeading);
     deinit_Block(&d->sourceContent);
+    delete_Block(d->hibernatedContent);
     deinit_String(&d->sourceMime);
     deinit_String(&d->sourceHeader);
     delete_Banner(d->banner);
@@ -5411,6 +5601,19 @@ const iGmDocument *document_DocumentWidget(const iDocumentWidget *d) {
     return d->view->doc;
 }
 
+iBool isHibernating_DocumentWidget(const iDocumentWidget *d) {
+    return d->hibernatedContent != NULL;
+}
+
+size_t memorySize_DocumentWidget(const iDocumentWidget *d) {
+    return memorySize_GmDocument(d->view->doc) + size_Block(&d->sourceContent) +
+           (d->hibernatedContent ? size_Block(d->hibernatedContent) : 0);
+}
+
+size_t textureMemorySize_DocumentWidget(const iDocumentWidget *d) {
+    return textureMemorySize_DocumentView(d->view);
+}
+
 const iBlock *sourceContent_DocumentWidget(const iDocumentWidget *d) {
     return &d->sourceContent;
 }
@@ -5516,7 +5719,9 @@ void setUrlFlags_DocumentWidget(iDocumentWidget *d, const iString *url, int setU
             setUrlAndSource_DocumentWidget(
                 d, url, collectNewCStr_String("text/gemini"), collect_Block(newCStr_Block("")), 0);
         }
-        else {
+        else if (setIdent || isIdentityPinned_DocumentWidget(d) ||
+                 !updateFromResponseCache_DocumentWidget_(d)) {
+            /* The page may have been recently received in another tab or prefetched. */
             fetch_DocumentWidget_(d);
             if (setIdent) {
                 setIdentity_History(d->mod.history, setIdent);
@@ -5536,6 +5741,7 @@ void setUrlAndSource_DocumentWidget(iDocumentWidget *d, const iString *url, cons
     initCurrent_Time(&resp->when);
     set_String(&resp->meta, mime);
     set_Block(&resp->body, source);
+    deflateBody_GmResponse(resp);
     updateFromCachedResponse_DocumentWidget_(d, normScrollY, resp, NULL);
     updateBanner_DocumentWidget_(d);
     delete_GmResponse(resp);
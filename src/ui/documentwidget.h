@@ -71,6 +71,9 @@ iBool               noHoverWhileScrolling_DocumentWidget(const iDocumentWidget *
 iBool               isShowingLinkNumbers_DocumentWidget (const iDocumentWidget *);
 iBool               isBlank_DocumentWidget              (const iDocumentWidget *);
 iBool               isUnseen_DocumentWidget             (const iDocumentWidget *);
+iBool               isHibernating_DocumentWidget        (const iDocumentWidget *); /* inactive tab, layout released */
+size_t              memorySize_DocumentWidget           (const iDocumentWidget *); /* bytes */
+size_t              textureMemorySize_DocumentWidget    (const iDocumentWidget *); /* view buffers */
 iMediaRequest *     findMediaRequest_DocumentWidget     (const iDocumentWidget *, iGmLinkId linkId);
 
 size_t              ordinalBase_DocumentWidget          (const iDocumentWidget *);
@@ -104,6 +107,7 @@ void    setSource_DocumentWidget        (iDocumentWidget *, const iString *sourc
 void    takeRequest_DocumentWidget      (iDocumentWidget *, iGmRequest *finishedRequest); /* ownership given */
 
 void    documentRunsInvalidated_DocumentWidget  (iDocumentWidget *);
+void    documentRunsMoved_DocumentWidget        (iDocumentWidget *); /* layout continued, marks kept */
 void    updateSize_DocumentWidget               (iDocumentWidget *);
 void    updateHoverLinkInfo_DocumentWidget      (iDocumentWidget *, uint16_t linkId);
 void    scrollBegan_DocumentWidget              (iAnyObject *, int, uint32_t); /* SmoothScroll callback */
@@ -112,3 +116,4 @@ void    didScrollView_DocumentWidget            (iDocumentWidget *);
 
 void    animate_DocumentWidget                  (iAny *); /* ticker */
 void    refreshWhileScrolling_DocumentWidget    (iAny *); /* ticker */
+void    continueLayout_DocumentWidget           (iAny *); /* ticker */
@@ -119,16 +119,20 @@ iDefineTypeConstructionArgs(AttributedText,
                             text, maxLen, font, colorId, baseDir, baseFont, baseFgColorId,
                             overrideChar)
 
+iLocalDef int sourceOffset_AttributedText_(const iAttributedText *d, int logicalPos) {
+    /* In ASCII text, each character is one byte. */
+    return d->isAsciiSource ? logicalPos
+                            : ((const int *) constData_Array(&d->logicalToSourceOffset))[logicalPos];
+}
+
 const char *sourcePtr_AttributedText(const iAttributedText *d, int logicalPos) {
-    const int *logToSource = constData_Array(&d->logicalToSourceOffset);
-    return d->source.start + logToSource[logicalPos];
+    return d->source.start + sourceOffset_AttributedText_(d, logicalPos);
 }
 
 static iRangecc sourceRange_AttributedText_(const iAttributedText *d, iRangei logical) {
-    const int *logToSource = constData_Array(&d->logicalToSourceOffset);
     iRangecc range = {
-        d->source.start + logToSource[logical.start],
-        d->source.start + logToSource[logical.end]
+        d->source.start + sourceOffset_AttributedText_(d, logical.start),
+        d->source.start + sourceOffset_AttributedText_(d, logical.end)
     };
     iAssert(range.start <= range.end);
     return range;
@@ -152,10 +156,39 @@ static void finishRun_AttributedText_(iAttributedText *d, iAttributedRun *run, i
     run->logical.start = endAt;
 }
 
+#if defined (LAGRANGE_ENABLE_FRIBIDI)
+static iBool isBidiSignificant_(iChar ch) {
+    if (ch < 0x590) {
+        return iFalse; /* no RTL letters, Arabic numbers, or directional controls before Hebrew */
+    }
+    const FriBidiCharType type = fribidi_get_bidi_type(ch);
+    return FRIBIDI_IS_RTL(type) || FRIBIDI_IS_ARABIC(type) || FRIBIDI_IS_EXPLICIT(type) ||
+           FRIBIDI_IS_ISOLATE(type);
+}
+#endif
+
 static void prepare_AttributedText_(iAttributedText *d, int overrideBaseDir, iChar overrideChar) {
     iAssert(isEmpty_Array(&d->runs));
     size_t length = 0;
-    /* Prepare the UTF-32 logical string. */ {
+    iBool  isBidi = iFalse;
+    /* Prepare the UTF-32 logical string. */
+    if (isAscii_Rangecc(d->source) &&
+        (d->maxLen == 0 || size_Range(&d->source) < d->maxLen)) {
+        /* Source offsets are the same as logical indices, so they need not be mapped. */
+        d->isAsciiSource = iTrue;
+        length = size_Range(&d->source);
+        resize_Array(&d->logical, length);
+        iChar *logicalText = data_Array(&d->logical);
+        for (size_t i = 0; i < length; i++) {
+            logicalText[i] = overrideChar ? overrideChar : (iChar) d->source.start[i];
+        }
+#if defined (LAGRANGE_ENABLE_FRIBIDI)
+        isBidi = (overrideChar && isBidiSignificant_(overrideChar));
+#endif
+    }
+    else {
+        reserve_Array(&d->logical, iMin(size_Range(&d->source), d->maxLen));
+        reserve_Array(&d->logicalToSourceOffset, iMin(size_Range(&d->source), d->maxLen) + 1);
         for (const char *ch = d->source.start; ch < d->source.end; ) {
             iChar u32;
             int len = decodeBytes_MultibyteChar(ch, d->source.end, &u32);
@@ -163,6 +196,9 @@ static void prepare_AttributedText_(iAttributedText *d, int overrideBaseDir, iCh
             if (overrideChar) {
                 u32 = overrideChar;
             }
+#if defined (LAGRANGE_ENABLE_FRIBIDI)
+            isBidi |= isBidiSignificant_(u32);
+#endif
             pushBack_Array(&d->logical, &u32);
             length++;
             if (length == d->maxLen) {
@@ -174,38 +210,49 @@ static void prepare_AttributedText_(iAttributedText *d, int overrideBaseDir, iCh
             pushBack_Array(&d->logicalToSourceOffset, &(int){ ch - d->source.start });
             ch += len;
         }
-        iBool bidiOk = iFalse;
+        /* The mapping needs to include the terminating NULL position. */
+        pushBack_Array(&d->logicalToSourceOffset, &(int){ d->source.end - d->source.start });
+    }
+    /* Forcing an RTL base direction changes how LTR runs are split. */
+    if (overrideBaseDir < 0) {
+        isBidi = iTrue;
+    }
 #if defined (LAGRANGE_ENABLE_FRIBIDI)
+    if (isBidi && length) {
         /* Use FriBidi to reorder the codepoints. */
         resize_Array(&d->visual, length);
         resize_Array(&d->logicalToVisual, length);
         resize_Array(&d->visualToLogical, length);
-        d->bidiLevels = length ? malloc(length) : NULL;
+        d->bidiLevels = malloc(length);
         FriBidiParType baseDir = (FriBidiParType) FRIBIDI_TYPE_ON;
-        bidiOk = fribidi_log2vis(constData_Array(&d->logical),
-                                 (FriBidiStrIndex) length,
-                                 &baseDir,
-                                 data_Array(&d->visual),
-                                 data_Array(&d->logicalToVisual),
-                                 data_Array(&d->visualToLogical),
-                                 (FriBidiLevel *) d->bidiLevels) > 0;
-        d->isBaseRTL = (overrideBaseDir == 0 ? FRIBIDI_IS_RTL(baseDir) : (overrideBaseDir < 0));
-#endif
-        if (!bidiOk) {
-            /* 1:1 mapping. */
-            setCopy_Array(&d->visual, &d->logical);
-            resize_Array(&d->logicalToVisual, length);
-            for (size_t i = 0; i < length; i++) {
-                set_Array(&d->logicalToVisual, i, &(int){ i });
-            }
-            setCopy_Array(&d->visualToLogical, &d->logicalToVisual);
-            d->isBaseRTL = iFalse;
+        if (fribidi_log2vis(constData_Array(&d->logical),
+                            (FriBidiStrIndex) length,
+                            &baseDir,
+                            data_Array(&d->visual),
+                            data_Array(&d->logicalToVisual),
+                            data_Array(&d->visualToLogical),
+                            (FriBidiLevel *) d->bidiLevels) > 0) {
+            d->isBaseRTL = (overrideBaseDir == 0 ? FRIBIDI_IS_RTL(baseDir) : (overrideBaseDir < 0));
+            d->isVisualOrder = iFalse;
+            /* The mapping needs to include the terminating NULL position. */
+            pushBack_Array(&d->logicalToVisual, &(int){ length });
+            pushBack_Array(&d->visualToLogical, &(int){ length });
+        }
+        else {
+            free(d->bidiLevels);
+            d->bidiLevels = NULL;
         }
     }
-    /* The mapping needs to include the terminating NULL position. */ {
-        pushBack_Array(&d->logicalToSourceOffset, &(int){ d->source.end - d->source.start });
-        pushBack_Array(&d->logicalToVisual, &(int){ length });
-        pushBack_Array(&d->visualToLogical, &(int){ length });
+#else
+    iUnused(isBidi);
+#endif
+    if (d->isVisualOrder) {
+        /* Plain LTR text: visual order is the same as logical order, so the visual arrays
+           are left empty. */
+        clear_Array(&d->visual);
+        clear_Array(&d->logicalToVisual);
+        clear_Array(&d->visualToLogical);
+        d->isBaseRTL = iFalse;
     }
     iAttributedRun run = {
         .logical = { 0, length },
@@ -213,7 +260,6 @@ static void prepare_AttributedText_(iAttributedText *d, int overrideBaseDir, iCh
                      .isBaseRTL = d->isBaseRTL },
         .font    = d->font,
     };
-    const int     *logToSource = constData_Array(&d->logicalToSourceOffset);
     const iChar *  logicalText = constData_Array(&d->logical);
     iBool          isRTL       = d->isBaseRTL;
     int            numNonSpace = 0;
@@ -240,7 +286,7 @@ static void prepare_AttributedText_(iAttributedText *d, int overrideBaseDir, iCh
         run.attrib.isRTL = isRTL;
         if (ch == 0x1b) { /* ANSI escape. */
             pos++;
-            const char *srcPos = d->source.start + logToSource[pos];
+            const char *srcPos = sourcePtr_AttributedText(d, pos);
             /* Do a regexp match in the source text. */
             iRegExpMatch m;
             init_RegExpMatch(&m);
@@ -332,7 +378,7 @@ static void prepare_AttributedText_(iAttributedText *d, int overrideBaseDir, iCh
                     }
                 }
                 pos += length_Rangecc(capturedRange_RegExpMatch(&m, 0));
-//                iAssert(logToSource[pos] == end_RegExpMatch(&m) - d->source.start);
+//                iAssert(sourceOffset_AttributedText_(d, pos) == end_RegExpMatch(&m) - d->source.start);
                 /* The run continues after the escape sequence. */
                 run.logical.start = pos--; /* loop increments `pos` */
                 continue;
@@ -439,7 +485,8 @@ static void prepare_AttributedText_(iAttributedText *d, int overrideBaseDir, iCh
                isMonospaced_Font(run->font) ? 'M' : 'v',
                cstr_String(&run->font->spec->name),
                run->logical.start, run->logical.end - 1,
-               logToVis[run->logical.start], logToVis[run->logical.end - 1],
+               d->isVisualOrder ? run->logical.start : logToVis[run->logical.start],
+               d->isVisualOrder ? run->logical.end - 1 : logToVis[run->logical.end - 1],
                cstr_Rangecc(sourceRange_AttributedText_(d, run->logical)));
     }
 #endif
@@ -455,6 +502,8 @@ void init_AttributedText(iAttributedText *d, iRangecc text, size_t maxLen, iAnyF
     d->baseFont      = baseFont;
     d->baseFgColorId = baseFgColorId;
     d->isBaseRTL     = iFalse;
+    d->isVisualOrder = iTrue;
+    d->isAsciiSource = iFalse;
     init_Array(&d->runs, sizeof(iAttributedRun));
     init_Array(&d->logical, sizeof(iChar));
     init_Array(&d->visual, sizeof(iChar));
@@ -177,6 +177,8 @@ struct Impl_AttributedText {
     iBaseFont *baseFont;
     int      baseFgColorId;
     iBool    isBaseRTL;
+    iBool    isVisualOrder;   /* no bidi reordering needed; `visual` and the index maps are empty */
+    iBool    isAsciiSource;   /* `logicalToSourceOffset` is empty; offsets equal logical indices */
     iArray   runs;
     iArray   logical;         /* UTF-32 text in logical order (mixed directions; matches source) */
     iArray   visual;          /* UTF-32 text in visual order (LTR) */
@@ -197,16 +197,31 @@ iDefineTypeConstruction(InputLine)
 iDeclareType(InputUndo)
 
 struct Impl_InputUndo {
-    iString text;
-    iInt2 cursor;
+    iString text;     /* entire content, or just the saved `lines` */
+    iRangei lines;    /* empty if `text` has the entire content */
+    int     numLines; /* total number of lines when saved */
+    iInt2   cursor;
 };
 
 static void init_InputUndo_(iInputUndo *d, const iArray *lines, iInt2 cursor) {
     init_String(&d->text);
     mergeLines_(lines, &d->text);
+    iZap(d->lines);
+    d->numLines = size_Array(lines);
     d->cursor = cursor;
 }
 
+static void initLines_InputUndo_(iInputUndo *d, const iArray *lines, iRangei saved,
+                                 iInt2 cursor) {
+    init_String(&d->text);
+    for (int i = saved.start; i < saved.end; i++) {
+        append_String(&d->text, &((const iInputLine *) constAt_Array(lines, i))->text);
+    }
+    d->lines    = saved;
+    d->numLines = size_Array(lines);
+    d->cursor   = cursor;
+}
+
 static void deinit_InputUndo_(iInputUndo *d) {
     deinit_String(&d->text);
 }
@@ -530,9 +545,25 @@ static iRangecc rangeSize_String(const iString *d, size_t size) {
     };
 }
 
+static size_t lineIndexByWrapY_InputWidget_(const iInputWidget *d, int wrapY) {
+    /* Lines are in wrap order, so find the first one ending below `wrapY` with a binary search. */
+    size_t first = 0, last = size_Array(&d->lines);
+    while (first < last) {
+        const size_t mid = (first + last) / 2;
+        if (((const iInputLine *) constAt_Array(&d->lines, mid))->wrapLines.end <= wrapY) {
+            first = mid + 1;
+        }
+        else {
+            last = mid;
+        }
+    }
+    return first;
+}
+
 static const iInputLine *findLineByWrapY_InputWidget_(const iInputWidget *d, int wrapY) {
-    iConstForEach(Array, i, &d->lines) {
-        const iInputLine *line = i.value;
+    const size_t index = lineIndexByWrapY_InputWidget_(d, wrapY);
+    if (index < size_Array(&d->lines)) {
+        const iInputLine *line = constAt_Array(&d->lines, index);
         if (contains_Range(&line->wrapLines, wrapY)) {
             return line;
         }
@@ -550,11 +581,13 @@ static int visLineOffsetY_InputWidget_(const iInputWidget *d) {
 static iRangei visibleLineRange_InputWidget_(const iInputWidget *d) {
     iRangei vis = { -1, -1 };
     /* Determine which lines are in the potentially visible range. */
-    for (int i = 0; i < size_Array(&d->lines); i++) {
+    const int first = lineIndexByWrapY_InputWidget_(d, d->visWrapLines.start);
+    if (first == size_Array(&d->lines)) {
+        return vis;
+    }
+    vis.start = vis.end = first;
+    for (int i = first; i < size_Array(&d->lines); i++) {
         const iInputLine *line = constAt_Array(&d->lines, i);
-        if (vis.start < 0 && line->wrapLines.end > d->visWrapLines.start) {
-            vis.start = vis.end = i;
-        }
         if (line->wrapLines.start < d->visWrapLines.end) {
             vis.end = i + 1;
         }
@@ -937,25 +970,100 @@ void setFont_InputWidget(iInputWidget *d, int fontId) {
 }
 
 #if !LAGRANGE_USE_SYSTEM_TEXT_INPUT
-static void pushUndo_InputWidget_(iInputWidget *d) {
-    iInputUndo undo;
-    init_InputUndo_(&undo, &d->lines, d->cursor);
-    pushBack_Array(&d->undoStack, &undo);
+static void addUndo_InputWidget_(iInputWidget *d, iInputUndo *undo) {
+    pushBack_Array(&d->undoStack, undo);
     if (size_Array(&d->undoStack) > maxUndo_InputWidget_) {
         deinit_InputUndo_(front_Array(&d->undoStack));
         popFront_Array(&d->undoStack);
     }
 }
 
+static void pushUndo_InputWidget_(iInputWidget *d) {
+    iInputUndo undo;
+    init_InputUndo_(&undo, &d->lines, d->cursor);
+    addUndo_InputWidget_(d, &undo);
+}
+
+static void pushLocalUndo_InputWidget_(iInputWidget *d) {
+    /* Typing a character or deleting one next to the cursor can only affect the cursor's
+       line and its neighbors (when a newline is deleted), so the rest of a potentially
+       very long text doesn't need to be copied. */
+    if (!isEmpty_Range(&d->mark)) {
+        pushUndo_InputWidget_(d);
+        return;
+    }
+    iInputUndo undo;
+    initLines_InputUndo_(&undo,
+                         &d->lines,
+                         (iRangei){ iMax(0, d->cursor.y - 1),
+                                    iMin(d->cursor.y + 2, (int) size_Array(&d->lines)) },
+                         d->cursor);
+    addUndo_InputWidget_(d, &undo);
+}
+
+static iBool restoreLines_InputWidget_(iInputWidget *d, const iInputUndo *undo) {
+    /* The saved lines have since been edited into `numChanged` lines. */
+    const int numChanged = size_Range(&undo->lines) + (int) size_Array(&d->lines) - undo->numLines;
+    if (numChanged < 0 || undo->lines.start + numChanged > (int) size_Array(&d->lines)) {
+        return iFalse; /* text has been replaced since */
+    }
+    iArray restored;
+    init_Array(&restored, sizeof(iInputLine));
+    splitToLines_(&undo->text, &restored);
+    if (undo->lines.end < undo->numLines) {
+        /* The last saved line ends in a newline, but the next line is not part of the
+           saved text. */
+        iInputLine *last = back_Array(&restored);
+        iAssert(isEmpty_String(&last->text));
+        deinit_InputLine(last);
+        popBack_Array(&restored);
+    }
+    for (int i = 0; i < numChanged; i++) {
+        deinit_InputLine(at_Array(&d->lines, undo->lines.start + i));
+    }
+    removeN_Array(&d->lines, undo->lines.start, numChanged);
+    insertN_Array(&d->lines, undo->lines.start, constData_Array(&restored), size_Array(&restored));
+    deinit_Array(&restored); /* lines now owned by `d->lines` */
+    /* Rewrap only the restored lines. */
+    iInputLine *first = at_Array(&d->lines, undo->lines.start);
+    if (undo->lines.start > 0) {
+        const iInputLine *prev = constAt_Array(&d->lines, undo->lines.start - 1);
+        first->range.start     = prev->range.end;
+        first->wrapLines.start = prev->wrapLines.end;
+    }
+    else {
+        first->range.start     = 0;
+        first->wrapLines.start = 0;
+    }
+    for (int i = undo->lines.start; i < undo->lines.end; i++) {
+        updateLine_InputWidget_(d, at_Array(&d->lines, i));
+    }
+    updateLineRangesStartingFrom_InputWidget_(d, undo->lines.start);
+    updateVisible_InputWidget_(d);
+    updateMetrics_InputWidget_(d);
+    return iTrue;
+}
+
 static iBool popUndo_InputWidget_(iInputWidget *d) {
     if (!isEmpty_Array(&d->undoStack)) {
         iInputUndo *undo = back_Array(&d->undoStack);
-        splitToLines_(&undo->text, &d->lines);
-        d->cursor = undo->cursor;
+        iZap(d->mark);
+        if (isEmpty_Range(&undo->lines)) {
+            splitToLines_(&undo->text, &d->lines);
+            d->cursor = undo->cursor;
+            updateAllLinesAndResizeHeight_InputWidget_(d);
+        }
+        else {
+            const iInt2 oldCursor = d->cursor;
+            d->cursor = undo->cursor;
+            if (!restoreLines_InputWidget_(d, undo)) {
+                d->cursor = oldCursor;
+                clearUndo_InputWidget_(d);
+                return iFalse;
+            }
+        }
         deinit_InputUndo_(undo);
         popBack_Array(&d->undoStack);
-        iZap(d->mark);
-        updateAllLinesAndResizeHeight_InputWidget_(d);
         return iTrue;
     }
     return iFalse;
@@ -987,11 +1095,21 @@ static size_t cursorToIndex_InputWidget_(const iInputWidget *d, iInt2 pos) {
 }
 
 static iInt2 indexToCursor_InputWidget_(const iInputWidget *d, size_t index) {
-    /* TODO: The lines are sorted; this could use a binary search. */
-    iConstForEach(Array, i, &d->lines) {
-        const iInputLine *line = i.value;
+    /* The lines are sorted, so use a binary search. */
+    size_t first = 0, last = size_Array(&d->lines);
+    while (first < last) {
+        const size_t mid = (first + last) / 2;
+        if (((const iInputLine *) constAt_Array(&d->lines, mid))->range.end <= index) {
+            first = mid + 1;
+        }
+        else {
+            last = mid;
+        }
+    }
+    if (first < size_Array(&d->lines)) {
+        const iInputLine *line = constAt_Array(&d->lines, first);
         if (contains_Range(&line->range, index)) {
-            return init_I2(index - line->range.start, index_ArrayConstIterator(&i));
+            return init_I2(index - line->range.start, first);
         }
     }
     return cursorMax_InputWidget_(d);
@@ -1412,6 +1530,7 @@ void end_InputWidget(iInputWidget *d, iBool accept) {
     if (!accept) {
         /* Overwrite the edited lines. */
         splitToLines_(&d->oldText, &d->lines);
+        clearUndo_InputWidget_(d);
     }
     d->inFlags &= ~isMarking_InputWidgetFlag;
     deactivateInputMode_InputWidget_(d);
@@ -2469,7 +2588,7 @@ static iBool processEvent_InputWidget_(iInputWidget *d, const SDL_Event *ev) {
         return iTrue;
     }
     else if (isCommand_UserEvent(ev, "text.insert")) {
-        pushUndo_InputWidget_(d);
+        pushLocalUndo_InputWidget_(d);
         deleteMarked_InputWidget_(d);
         insertChar_InputWidget_(d, arg_Command(command_UserEvent(ev)));
         contentsWereChanged_InputWidget_(d);
@@ -2600,7 +2719,7 @@ static iBool processEvent_InputWidget_(iInputWidget *d, const SDL_Event *ev) {
         if (isLinux_Platform() && keyMods_Sym(modState_Keys()) == KMOD_CTRL) {
             return iTrue;
         }
-        pushUndo_InputWidget_(d);
+        pushLocalUndo_InputWidget_(d);
         deleteMarked_InputWidget_(d);
         insertRange_InputWidget_(d, range_CStr(ev->text.text));
         contentsWereChanged_InputWidget_(d);
@@ -2670,7 +2789,7 @@ static iBool processEvent_InputWidget_(iInputWidget *d, const SDL_Event *ev) {
 #if !LAGRANGE_USE_SYSTEM_TEXT_INPUT
                 if (isAllowedToInsertNewline_InputWidget_(d)) {
                     if (checkLineBreakMods_InputWidget_(d, mods)) {
-                        pushUndo_InputWidget_(d);
+                        pushLocalUndo_InputWidget_(d);
                         deleteMarked_InputWidget_(d);
                         insertChar_InputWidget_(d, '\n');
                         contentsWereChanged_InputWidget_(d);
@@ -2722,7 +2841,7 @@ static iBool processEvent_InputWidget_(iInputWidget *d, const SDL_Event *ev) {
                     contentsWereChanged_InputWidget_(d);
                 }
                 else if (!isEqual_I2(d->cursor, zero_I2())) {
-                    pushUndo_InputWidget_(d);
+                    pushLocalUndo_InputWidget_(d);
                     d->mark.end = cursorToIndex_InputWidget_(d, d->cursor);
                     movePos_InputWidget_(d, &d->cursor, -1);
                     d->mark.start = cursorToIndex_InputWidget_(d, d->cursor);
@@ -2755,7 +2874,7 @@ static iBool processEvent_InputWidget_(iInputWidget *d, const SDL_Event *ev) {
                     contentsWereChanged_InputWidget_(d);
                 }
                 else if (!isEqual_I2(d->cursor, curMax)) {
-                    pushUndo_InputWidget_(d);
+                    pushLocalUndo_InputWidget_(d);
                     deleteIndexRange_InputWidget_(d, (iRanges){
                         cursorToIndex_InputWidget_(d, d->cursor),
                         cursorToIndex_InputWidget_(d, movedCursor_InputWidget_(d, d->cursor, +1, 0))
@@ -2836,7 +2955,7 @@ static iBool processEvent_InputWidget_(iInputWidget *d, const SDL_Event *ev) {
             }
             case SDLK_TAB:
                 if (mods == (KMOD_ALT | KMOD_SHIFT)) {
-                    pushUndo_InputWidget_(d);
+                    pushLocalUndo_InputWidget_(d);
                     deleteMarked_InputWidget_(d);
                     insertChar_InputWidget_(d, '\t');
                     contentsWereChanged_InputWidget_(d);
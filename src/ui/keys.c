@@ -278,6 +278,7 @@ static const struct { int id; iMenuItem bind; int flags; } defaultBindings_[] =
     { 1100, { NULL, SDLK_SPACE,        KMOD_PRIMARY | KMOD_CTRL, "emojipicker"          }, 0 },
 #endif
     { 1004, { NULL, SDLK_F5, 0,                         "document.reload"               }, 0 },
+    { 1012, { NULL, SDLK_F12, KMOD_SHIFT,               "debug.profiler"                }, 0 },
     /* Media keys. */
     { 1005, { NULL, SDLK_AC_SEARCH, 0,                  "focus.set id:find.input id2:filter.bookmark.input"       }, 0 },
     { 1006, { NULL, SDLK_AC_HOME, 0,                    "navigate.home"                 }, 0 },
@@ -93,6 +93,8 @@ void init_ListWidget(iListWidget *d) {
     d->noHoverWhileScrolling = iFalse;
     d->hideItemOnDrag = iFalse;
     init_PtrArray(&d->items);
+    iZap(d->source);
+    iZap(d->madeItems);
     d->cursorItem = iInvalidPos;
     d->hoverItem = iInvalidPos;
     d->dragItem = iInvalidPos;
@@ -128,16 +130,132 @@ void invalidateItem_ListWidget(iListWidget *d, size_t index) {
 
 void clear_ListWidget(iListWidget *d) {
     iForEach(PtrArray, i, &d->items) {
-        deref_Object(i.ptr);
+        deref_Object(i.ptr); /* may be NULL if never made by the source */
     }
     clear_PtrArray(&d->items);
+    iZap(d->source);
+    iZap(d->madeItems);
     d->hoverItem = iInvalidPos;
 }
 
 void addItem_ListWidget(iListWidget *d, iAnyObject *item) {
+    iAssert(!d->source.count); /* items come from the source */
     pushBack_PtrArray(&d->items, ref_Object(item));
 }
 
+void setSource_ListWidget(iListWidget *d, const iListItemSource *source) {
+    clear_ListWidget(d);
+    if (source) {
+        d->source = *source;
+        /* Items are made only when needed. */
+        resize_PtrArray(&d->items, d->source.count(d->source.context));
+    }
+}
+
+static void addMade_ListWidget_(iRanges *made, size_t index) {
+    if (isEmpty_Range(made)) {
+        *made = (iRanges){ index, index + 1 };
+    }
+    else {
+        made->start = iMin(made->start, index);
+        made->end   = iMax(made->end, index + 1);
+    }
+}
+
+static iAnyObject *madeItem_ListWidget_(const iListWidget *d, size_t index) {
+    iPtrArray  *items = iConstCast(iPtrArray *, &d->items);
+    iAnyObject *item  = at_PtrArray(items, index);
+    if (!item && d->source.makeItem) {
+        item = d->source.makeItem(d->source.context, index);
+        set_PtrArray(items, index, item);
+        addMade_ListWidget_(iConstCast(iRanges *, &d->madeItems), index);
+    }
+    return item;
+}
+
+static iBool isPinned_ListWidget_(const iListWidget *d, size_t index) {
+    return index == d->cursorItem || index == d->hoverItem || index == d->dragItem;
+}
+
+static void evictItems_ListWidget_(iListWidget *d, iRanges visible) {
+    /* Items made by the source are released when they are far enough from the visible
+       rows. They will be made again if needed. */
+    visible.start = iMin(visible.start, visible.end);
+    const size_t margin = iMax(size_Range(&visible), 32u);
+    const iRanges keep  = { visible.start > margin ? visible.start - margin : 0,
+                            iMin(visible.end + margin, size_PtrArray(&d->items)) };
+    iRanges stillMade = keep;
+    for (size_t i = d->madeItems.start; i < d->madeItems.end; i++) {
+        if (contains_Range(&keep, i)) {
+            continue;
+        }
+        if (isPinned_ListWidget_(d, i)) {
+            addMade_ListWidget_(&stillMade, i);
+            continue;
+        }
+        deref_Object(at_PtrArray(&d->items, i));
+        set_PtrArray(&d->items, i, NULL);
+    }
+    d->madeItems = stillMade;
+}
+
+void updateItem_ListWidget(iListWidget *d, size_t index) {
+    if (index >= size_PtrArray(&d->items)) {
+        return;
+    }
+    if (d->source.makeItem && index != d->dragItem) {
+        /* Make it again from the source when needed. */
+        deref_Object(at_PtrArray(&d->items, index));
+        set_PtrArray(&d->items, index, NULL);
+    }
+    invalidateItem_ListWidget(d, index);
+}
+
+static void shiftIndex_ListWidget_(size_t *pos, size_t index, int delta) {
+    if (*pos == iInvalidPos || *pos < index) {
+        return;
+    }
+    if (delta < 0 && *pos == index) {
+        *pos = iInvalidPos; /* removed */
+        return;
+    }
+    *pos += delta;
+}
+
+static void itemsShifted_ListWidget_(iListWidget *d, size_t index, int delta) {
+    if (d->madeItems.end > index) {
+        /* A removed item at `start` leaves `start` as is; the next item takes its place. */
+        if (d->madeItems.start > index || (delta > 0 && d->madeItems.start == index)) {
+            d->madeItems.start += delta;
+        }
+        d->madeItems.end += delta;
+    }
+    shiftIndex_ListWidget_(&d->hoverItem, index, delta);
+    shiftIndex_ListWidget_(&d->cursorItem, index, delta);
+    shiftIndex_ListWidget_(&d->dragItem, index, delta);
+    /* All the following rows have moved. */
+    updateVisible_ListWidget(d);
+    invalidate_ListWidget(d);
+}
+
+void insertItem_ListWidget(iListWidget *d, size_t index, iAnyObject *item) {
+    iAssert(item || d->source.makeItem);
+    index = iMin(index, size_PtrArray(&d->items));
+    insert_PtrArray(&d->items, index, item ? ref_Object(item) : NULL);
+    itemsShifted_ListWidget_(d, index, 1);
+    if (item && d->source.makeItem) {
+        addMade_ListWidget_(&d->madeItems, index);
+    }
+}
+
+void removeItem_ListWidget(iListWidget *d, size_t index) {
+    void *item = NULL;
+    if (take_PtrArray(&d->items, index, &item)) {
+        deref_Object(item);
+        itemsShifted_ListWidget_(d, index, -1);
+    }
+}
+
 iScrollWidget *scroll_ListWidget(iListWidget *d) {
     return d->scroll;
 }
@@ -271,7 +389,7 @@ size_t itemIndex_ListWidget(const iListWidget *d, iInt2 pos) {
 
 const iAnyObject *constItem_ListWidget(const iListWidget *d, size_t index) {
     if (index < size_PtrArray(&d->items)) {
-        return constAt_PtrArray(&d->items, index);
+        return madeItem_ListWidget_(d, index);
     }
     return NULL;
 }
@@ -290,7 +408,7 @@ const iAnyObject *constCursorItem_ListWidget(const iListWidget *d) {
 
 iAnyObject *item_ListWidget(iListWidget *d, size_t index) {
     if (index < size_PtrArray(&d->items)) {
-        return at_PtrArray(&d->items, index);
+        return madeItem_ListWidget_(d, index);
     }
     return NULL;
 }
@@ -305,7 +423,7 @@ size_t hoverItemIndex_ListWidget(const iListWidget *d) {
 
 void setHoverItem_ListWidget(iListWidget *d, size_t index) {
     if (index < size_PtrArray(&d->items)) {
-        const iListItem *item = at_PtrArray(&d->items, index);
+        const iListItem *item = madeItem_ListWidget_(d, index);
         if (item->flags.isSeparator) {
             index = iInvalidPos;
         }
@@ -357,6 +475,7 @@ void updateMouseHover_ListWidget(iListWidget *d) {
 }
 
 void sort_ListWidget(iListWidget *d, int (*cmp)(const iListItem **item1, const iListItem **item2)) {
+    iAssert(!d->source.count); /* sources provide items in order */
     sort_Array(&d->items, (iSortedArrayCompareElemFunc) cmp);
 }
 
@@ -750,7 +869,7 @@ static void draw_ListWidget_(const iListWidget *d) {
             iConstForEach(IntSet, v, &d->invalidItems) {
                 const size_t index = *v.value;
                 if (contains_Range(&drawItems, index) && index < size_PtrArray(&d->items)) {
-                    const iListItem *item = constAt_PtrArray(&d->items, index);
+                    const iListItem *item = madeItem_ListWidget_(d, index);
                     if (item->flags.isHidden) continue;
                     const iRect itemRect = { init_I2(0, index * d->itemHeight - buf->origin),
                                              init_I2(d->visBuf->texSize.x, d->itemHeight) };
@@ -769,7 +888,7 @@ static void draw_ListWidget_(const iListWidget *d) {
                 drawItems.end   = invalidRange[i].end   / d->itemHeight + 1;
                 for (size_t j = drawItems.start; j < drawItems.end && j < size_PtrArray(&d->items);
                      j++) {
-                    const iListItem *item = constAt_PtrArray(&d->items, j);
+                    const iListItem *item = madeItem_ListWidget_(d, j);
                     if (item->flags.isHidden) continue;
                     const iRect itemRect = { init_I2(0, j * d->itemHeight - buf->origin),
                                              init_I2(d->visBuf->texSize.x, d->itemHeight) };
@@ -784,6 +903,12 @@ static void draw_ListWidget_(const iListWidget *d) {
         }
         validate_VisBuf(d->visBuf);
         clear_IntSet(&iConstCast(iListWidget *, d)->invalidItems);
+        if (d->source.makeItem) {
+            evictItems_ListWidget_(iConstCast(iListWidget *, d),
+                                   (iRanges){ vis.start / d->itemHeight,
+                                              iMin((size_t) (vis.end / d->itemHeight),
+                                                   size_PtrArray(&d->items)) });
+        }
     }
     setClip_Paint(&p, bounds_Widget(w));
     draw_VisBuf(d->visBuf, addY_I2(topLeft_Rect(bounds), -scrollY), ySpan_Rect(bounds));
@@ -792,7 +917,7 @@ static void draw_ListWidget_(const iListWidget *d) {
     /* The dragged item is drawn independently of the rest. */
     if (d->dragItem != iInvalidPos && (isMobile || contains_Rect(bounds, mousePos))) {
         iInt2 pos = add_I2(mousePos, d->dragOrigin);
-        const iListItem *item = constAt_PtrArray(&d->items, d->dragItem);
+        const iListItem *item = madeItem_ListWidget_(d, d->dragItem);
         const iRect itemRect = { init_I2(left_Rect(bounds), pos.y),
                                  init_I2(d->visBuf->texSize.x, d->itemHeight) };
         SDL_SetRenderDrawBlendMode(renderer_Window(get_Window()), SDL_BLENDMODE_BLEND);
@@ -49,6 +49,19 @@ struct Impl_ListItem {
 
 iDeclareObjectConstruction(ListItem)
 
+iDeclareType(ListItemSource)
+
+/* A source provides list items on demand, so only the rows that are actually accessed
+   (drawn, hovered, clicked) are ever created. `makeItem` returns a new reference that the
+   list takes ownership of. Items far outside the visible rows are released again, so a
+   pointer to an item is valid only until the list is next drawn unless a reference is
+   held to it. */
+struct Impl_ListItemSource {
+    size_t       (*count)   (void *context);
+    iAnyObject * (*makeItem)(void *context, size_t index);
+    void          *context;
+};
+
 iDeclareWidgetClass(ListWidget)
 iDeclareObjectConstruction(ListWidget)
 
@@ -66,7 +79,9 @@ struct Impl_ListWidget {
     iScrollWidget *scroll;
     iSmoothScroll  scrollY;
     int            itemHeight;
-    iPtrArray      items;
+    iPtrArray      items; /* NULL for rows not yet made by the source */
+    iListItemSource source;
+    iRanges        madeItems; /* rows that may have been made by the source */
     size_t         cursorItem; /* when has focus */
     size_t         hoverItem;
     size_t         dragItem;
@@ -89,6 +104,10 @@ void    invalidate_ListWidget       (iListWidget *);
 void    invalidateItem_ListWidget   (iListWidget *, size_t index);
 void    clear_ListWidget            (iListWidget *);
 void    addItem_ListWidget          (iListWidget *, iAnyObject *item);
+void    setSource_ListWidget        (iListWidget *, const iListItemSource *source);
+void    updateItem_ListWidget       (iListWidget *, size_t index); /* item contents changed */
+void    insertItem_ListWidget       (iListWidget *, size_t index, iAnyObject *item);
+void    removeItem_ListWidget       (iListWidget *, size_t index);
 
 iScrollWidget * scroll_ListWidget   (iListWidget *);
 
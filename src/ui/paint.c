@@ -22,11 +22,15 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "paint.h"
 #include "app.h"
+#include "profiler.h"
 
 #include <SDL_version.h>
 
 iInt2 origin_Paint;
 
+static SDL_Texture *damageTarget_Paint_;
+static iRect        damage_Paint_;
+
 iLocalDef SDL_Renderer *renderer_Paint_(const iPaint *d) {
     iAssert(d->dst);
     return d->dst->render;
@@ -63,6 +67,9 @@ void beginTarget_Paint(iPaint *d, SDL_Texture *target) {
 void endTarget_Paint(iPaint *d) {
     if (d->setTarget) {
         SDL_SetRenderTarget(renderer_Paint_(d), d->oldTarget);
+        if (d->oldTarget && d->oldTarget == damageTarget_Paint_) {
+            SDL_RenderSetClipRect(renderer_Paint_(d), (const SDL_Rect *) &damage_Paint_);
+        }
         origin_Paint = d->oldOrigin;
         d->oldOrigin = zero_I2();
         d->oldTarget = NULL;
@@ -77,6 +84,9 @@ void setClip_Paint(iPaint *d, iRect rect) {
     if (target) {
         SDL_QueryTexture(target, NULL, NULL, &targetRect.size.x, &targetRect.size.y);
         rect = intersect_Rect(rect, targetRect);
+        if (target == damageTarget_Paint_) {
+            rect = intersect_Rect(rect, damage_Paint_);
+        }
     }
     /* The origin is non-zero when drawing into a widget's own buffer. */
     if (isEqual_I2(zero_I2(), origin_Paint)) {
@@ -93,6 +103,10 @@ void unsetClip_Paint(iPaint *d) {
         setClip_Paint(d, rect_Root(get_Root()));
         return;
     }
+    if (damageTarget_Paint_ && SDL_GetRenderTarget(renderer_Paint_(d)) == damageTarget_Paint_) {
+        SDL_RenderSetClipRect(renderer_Paint_(d), (const SDL_Rect *) &damage_Paint_);
+        return;
+    }
 #if SDL_VERSION_ATLEAST(2, 0, 12)
     SDL_RenderSetClipRect(renderer_Paint_(d), NULL);
 #else
@@ -102,6 +116,11 @@ void unsetClip_Paint(iPaint *d) {
 #endif
 }
 
+void setDamage_Paint(SDL_Texture *target, iRect damage) {
+    damageTarget_Paint_ = (isEmpty_Rect(damage) ? NULL : target);
+    damage_Paint_       = damage;
+}
+
 void drawRect_Paint(const iPaint *d, iRect rect, int color) {
     addv_I2(&rect.pos, origin_Paint);
     iInt2 br = bottomRight_Rect(rect);
@@ -156,6 +175,7 @@ void drawSoftShadow_Paint(const iPaint *d, iRect inner, int thickness, int color
     SDL_SetTextureColorMod(shadow, clr.r, clr.g, clr.b);
     SDL_SetTextureAlphaMod(shadow, alpha);
     /* Classic stretched segmented border. */
+    iCountFrameN(renderCopies, 8);
     SDL_RenderCopy(render, shadow, &(SDL_Rect){ 0, 0, size.x / 2, size.y / 2},
                    &(SDL_Rect){ outer.pos.x, outer.pos.y, thickness, thickness });
     SDL_RenderCopy(render, shadow, &(SDL_Rect){ size.x / 2, 0, 1, size.y / 2},
@@ -46,6 +46,7 @@ void    endTarget_Paint     (iPaint *);
 
 void    setClip_Paint       (iPaint *, iRect rect);
 void    unsetClip_Paint     (iPaint *);
+void    setDamage_Paint     (SDL_Texture *target, iRect damage); /* all clips in target are limited to damage */
 
 void    drawRect_Paint          (const iPaint *, iRect rect, int color);
 void    drawRectThickness_Paint (const iPaint *, iRect rect, int thickness, int color);
@@ -0,0 +1,151 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "profiler.h"
+#include "app.h"
+#include "metrics.h"
+#include "paint.h"
+#include "periodic.h"
+#include "root.h"
+#include "text.h"
+#include "window.h"
+
+#include <SDL_timer.h>
+
+iFrameStats frameStats_;
+
+#define numHistory_Profiler_    120
+#define graphMaxMs_Profiler_    50.0f
+
+static struct {
+    iBool    isEnabled;
+    uint64_t frameStart;
+    uint64_t lastFrameStart;
+    float    frameMs;   /* interval between consecutive frames */
+    float    drawMs;    /* time spent inside the draw call */
+    float    history[numHistory_Profiler_];
+    size_t   historyPos;
+} profiler_;
+
+static float toMs_Profiler_(uint64_t ticks) {
+    return (float) ((double) ticks * 1000.0 / (double) SDL_GetPerformanceFrequency());
+}
+
+iBool isEnabled_Profiler(void) {
+    return profiler_.isEnabled;
+}
+
+void setEnabled_Profiler(iBool enable) {
+    profiler_.isEnabled = enable;
+    profiler_.lastFrameStart = 0;
+    iZap(profiler_.history);
+    iZap(frameStats_);
+}
+
+void beginFrame_Profiler(void) {
+    if (!profiler_.isEnabled) {
+        return;
+    }
+    profiler_.frameStart = SDL_GetPerformanceCounter();
+    if (profiler_.lastFrameStart) {
+        profiler_.frameMs = toMs_Profiler_(profiler_.frameStart - profiler_.lastFrameStart);
+        profiler_.history[profiler_.historyPos] = profiler_.frameMs;
+        profiler_.historyPos = (profiler_.historyPos + 1) % numHistory_Profiler_;
+    }
+    profiler_.lastFrameStart = profiler_.frameStart;
+}
+
+static void draw_Profiler_(const iFrameStats *stats, iWindow *win) {
+    const iRoot *root = win->roots[0];
+    if (!root) {
+        return;
+    }
+    const int   font    = uiLabelSmall_FontId;
+    const int   lineHgt = lineHeight_Text(font);
+    const int   pad     = gap_UI;
+    const int   barW    = iMax(1, gap_UI / 4);
+    const int   graphH  = 3 * lineHgt;
+    const int   width   = iMax(numHistory_Profiler_ * barW, 20 * lineHgt);
+    const char *lines[] = { "Frame", "Draw", "RenderCopy", "Glyphs rasterized",
+                            "VisBuf redraws", "Arrangements", "Tickers", "Periodic" };
+    const iRect safe    = safeRect_Root(root);
+    const iRect rect    = { init_I2(right_Rect(safe) - width - 2 * pad - gap_UI,
+                                    top_Rect(safe) + gap_UI),
+                            init_I2(width + 2 * pad,
+                                    2 * pad + iElemCount(lines) * lineHgt + pad + graphH) };
+    iPaint p;
+    init_Paint(&p);
+    p.alpha = 208;
+    fillRect_Paint(&p, rect, black_ColorId);
+    p.alpha = 255;
+    const iPeriodic *periodic = periodic_App();
+    const iString   *values[iElemCount(lines)] = {
+        collectNewFormat_String("%.1f ms", profiler_.frameMs),
+        collectNewFormat_String("%.1f ms", profiler_.drawMs),
+        collectNewFormat_String("%d", stats->renderCopies),
+        collectNewFormat_String("%d", stats->glyphsRasterized),
+        collectNewFormat_String("%d", stats->visBufRedraws),
+        collectNewFormat_String("%d", stats->arrangements),
+        collectNewFormat_String("%d run, %zu pending", stats->tickers, numTickers_App()),
+        collectNewFormat_String("%d run, %zu pending",
+                                stats->periodics,
+                                size_SortedArray(&periodic->commands)),
+    };
+    iInt2 pos = add_I2(rect.pos, init1_I2(pad));
+    iForIndices(i, lines) {
+        draw_Text(font, pos, gray75_ColorId, "%s", lines[i]);
+        drawAlign_Text(font,
+                       init_I2(right_Rect(rect) - pad, pos.y),
+                       white_ColorId,
+                       right_Alignment,
+                       "%s",
+                       cstr_String(values[i]));
+        pos.y += lineHgt;
+    }
+    /* Graph of recent frame intervals. The line marks 60 FPS. */
+    pos.y += pad;
+    const int bottom = pos.y + graphH;
+    for (size_t i = 0; i < numHistory_Profiler_; i++) {
+        const float ms = profiler_.history[(profiler_.historyPos + i) % numHistory_Profiler_];
+        const int   h  = (int) (iMin(ms, graphMaxMs_Profiler_) * graphH / graphMaxMs_Profiler_);
+        if (h > 0) {
+            fillRect_Paint(&p,
+                           (iRect){ init_I2(pos.x + (int) i * barW, bottom - h), init_I2(barW, h) },
+                           ms > 1000.0f / 30 ? red_ColorId
+                           : ms > 1000.0f / 55 ? orange_ColorId
+                                               : green_ColorId);
+        }
+    }
+    const int y60 = bottom - (int) (1000.0f / 60 * graphH / graphMaxMs_Profiler_);
+    fillRect_Paint(&p, (iRect){ init_I2(pos.x, y60), init_I2(numHistory_Profiler_ * barW, 1) },
+                   gray50_ColorId);
+}
+
+void endFrame_Profiler(iWindow *win) {
+    if (profiler_.isEnabled) {
+        /* Take a copy first so the HUD itself does not count. */
+        const iFrameStats stats = frameStats_;
+        profiler_.drawMs = toMs_Profiler_(SDL_GetPerformanceCounter() - profiler_.frameStart);
+        draw_Profiler_(&stats, win);
+    }
+    iZap(frameStats_);
+}
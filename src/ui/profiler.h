@@ -0,0 +1,52 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#pragma once
+
+/* Live per-frame statistics drawn on top of the main window. Toggled with the
+   "debug.profiler" command. The counters are always updated (they are cheap); the HUD is
+   only drawn when enabled. All counting happens on the main thread. */
+
+#include "defs.h"
+
+iDeclareType(FrameStats)
+iDeclareType(Window)
+
+struct Impl_FrameStats {
+    int renderCopies;       /* SDL_RenderCopy calls */
+    int glyphsRasterized;
+    int visBufRedraws;      /* document buffers that were drawn into */
+    int arrangements;       /* arrange_Widget calls */
+    int tickers;            /* tickers run */
+    int periodics;          /* periodic commands dispatched */
+};
+
+extern iFrameStats frameStats_;
+
+#define iCountFrame(counter)        (frameStats_.counter++)
+#define iCountFrameN(counter, n)    (frameStats_.counter += (n))
+
+iBool   isEnabled_Profiler  (void);
+void    setEnabled_Profiler (iBool enable);
+
+void    beginFrame_Profiler (void);
+void    endFrame_Profiler   (iWindow *); /* draws the HUD (if enabled) and resets counters */
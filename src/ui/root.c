@@ -2165,6 +2165,9 @@ void createUserInterface_Root(iRoot *d) {
         setLineBreaksEnabled_InputWidget(input, iFalse);
         setId_Widget(addChildFlags_Widget(searchBar, iClob(input), expand_WidgetFlag),
                      "find.input");
+        setId_Widget(addChildFlags_Widget(
+                         searchBar, iClob(new_LabelWidget("", NULL)), frameless_WidgetFlag),
+                     "find.count");
         addChild_Widget(searchBar, iClob(newIcon_LabelWidget("  \u2b9f  ", 'g', KMOD_PRIMARY, "find.next")));
         addChild_Widget(searchBar, iClob(newIcon_LabelWidget("  \u2b9d  ", 'g', KMOD_PRIMARY | KMOD_SHIFT, "find.prev")));
         addChild_Widget(searchBar, iClob(newIcon_LabelWidget(close_Icon, SDLK_ESCAPE, 0, "find.close")));
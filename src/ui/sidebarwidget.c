@@ -140,10 +140,11 @@ struct Impl_SidebarWidget {
     iWidget          *menu;          /* context menu for an item */
     iWidget          *modeMenu;      /* context menu for the sidebar mode (no item) */
     iWidget          *folderMenu;    /* context menu for bookmark folders */
-    iSidebarItem     *contextItem;   /* list item accessed in the context menu */
+    iSidebarItem     *contextItem;   /* list item accessed in the context menu (holds a ref) */
     size_t            contextIndex;  /* index of list item accessed in the context menu */
     iIntSet          *closedFolders; /* otherwise open */
     iString           bookmarkFilter;
+    iArray            bookmarkIds;   /* listed bookmarks; items are made on demand */
     iStringSet       *structureUrls;
     iString           structureHost;
     iStringSet       *structureUnfolds;
@@ -155,6 +156,14 @@ iLocalDef iListWidget *list_SidebarWidget_(iSidebarWidget *d) {
     return d->mode == identities_SidebarMode ? (iListWidget *) d->certList : d->list;
 }
 
+static void setContextItem_SidebarWidget_(iSidebarWidget *d, iSidebarItem *item) {
+    /* The list may release items that are not visible, so the context item is kept alive
+       with a reference of its own. */
+    ref_Object(item);
+    deref_Object(d->contextItem);
+    d->contextItem = item;
+}
+
 static iBool isResizing_SidebarWidget_(const iSidebarWidget *d) {
     return (flags_Widget(d->resizer) & pressed_WidgetFlag) != 0;
 }
@@ -349,25 +358,55 @@ static const iMenuItem bookmarkMenuItems_[] = {
     { reload_Icon " ${bookmarks.reload}", 0, 0, "bookmarks.reload.remote" }
 };
 
+static size_t numBookmarkItems_SidebarWidget_(void *context) {
+    const iSidebarWidget *d = context;
+    return size_Array(&d->bookmarkIds);
+}
+
+static iAnyObject *makeBookmarkItem_SidebarWidget_(void *context, size_t index) {
+    const iSidebarWidget *d    = context;
+    iSidebarItem         *item = new_SidebarItem();
+    const iBookmark      *bm   = get_Bookmarks(bookmarks_App(),
+                                          constValue_Array(&d->bookmarkIds, index, uint32_t));
+    if (!bm) {
+        /* Removed after the list was updated; it will be gone after the next update. */
+        item->listItem.flags.isHidden = iTrue;
+        return item;
+    }
+    setupFromBookmark_SidebarItem_(item, bm);
+    if (!isEmpty_String(&d->bookmarkFilter)) {
+        item->indent = 0; /* filtered results are a flat list */
+        return item;
+    }
+    item->listItem.flags.isDraggable = iTrue;
+    item->isBold = item->listItem.flags.isDropTarget = isFolder_Bookmark(bm);
+    if (isFolder_Bookmark(bm)) {
+        item->icon = contains_IntSet(d->closedFolders, item->id) ? 0x27e9 : 0xfe40;
+    }
+    if (bm->flags & remote_BookmarkFlag) {
+        item->listItem.flags.isDraggable = iFalse;
+    }
+    return item;
+}
+
+static void setBookmarkSource_SidebarWidget_(iSidebarWidget *d) {
+    /* With thousands of bookmarks, only the visible ones get a SidebarItem. */
+    setSource_ListWidget(d->list,
+                         &(iListItemSource){ numBookmarkItems_SidebarWidget_,
+                                             makeBookmarkItem_SidebarWidget_,
+                                             d });
+}
+
 static void updateBookmarkItems_SidebarWidget_(iSidebarWidget *d) {
+    clear_Array(&d->bookmarkIds);
     iConstForEach(PtrArray, i, list_Bookmarks(bookmarks_App(), cmpTree_Bookmark, NULL, NULL)) {
         const iBookmark *bm = i.ptr;
         if (isBookmarkFolded_SidebarWidget_(d, bm)) {
             continue; /* inside a closed folder */
         }
-        iSidebarItem *item = new_SidebarItem();
-        setupFromBookmark_SidebarItem_(item, bm);
-        item->listItem.flags.isDraggable = iTrue;
-        item->isBold = item->listItem.flags.isDropTarget = isFolder_Bookmark(bm);
-        if (isFolder_Bookmark(bm)) {
-            item->icon = contains_IntSet(d->closedFolders, item->id) ? 0x27e9 : 0xfe40;
-        }
-        if (bm->flags & remote_BookmarkFlag) {
-            item->listItem.flags.isDraggable = iFalse;
-        }
-        addItem_ListWidget(d->list, item);
-        iRelease(item);
+        pushBack_Array(&d->bookmarkIds, &(uint32_t){ id_Bookmark(bm) });
     }
+    setBookmarkSource_SidebarWidget_(d);
     d->menu = makeMenu_Widget(as_Widget(d), bookmarkMenuItems_, iElemCount(bookmarkMenuItems_));
     /* Menu for a bookmark folder. */ {
         iArray *items = new_Array(sizeof(iMenuItem));
@@ -430,18 +469,15 @@ static iBool isSubscribed_Bookmark_(void *context, const iBookmark *bm) {
 static void updateFilteredBookmarkItems_SidebarWidget_(iSidebarWidget *d) {
     const iWidget *w    = constAs_Widget(d);
     iString       *term = lower_String(&d->bookmarkFilter);
+    clear_Array(&d->bookmarkIds);
     iConstForEach(
         PtrArray,
         i,
         list_Bookmarks(bookmarks_App(), cmpTitleAscending_Bookmark, filterBookmark_String_, term)) {
-        const iBookmark *bm   = i.ptr;
-        iSidebarItem    *item = new_SidebarItem();
-        setupFromBookmark_SidebarItem_(item, bm);
-        item->indent = 0;
-        addItem_ListWidget(d->list, item);
-        iRelease(item);
+        pushBack_Array(&d->bookmarkIds, &(uint32_t){ id_Bookmark(i.ptr) });
     }
     delete_String(term);
+    setBookmarkSource_SidebarWidget_(d);
     d->menu = makeMenu_Widget(as_Widget(d),
                               bookmarkMenuItems_,
                               iElemCount(bookmarkMenuItems_) -
@@ -1238,6 +1274,15 @@ static void updateItems_SidebarWidget_(iSidebarWidget *d) {
 
 static size_t findItem_SidebarWidget_(const iSidebarWidget *d, int id) {
     /* Note that this is O(n), so only meant for infrequent use. */
+    if (d->mode == bookmarks_SidebarMode) {
+        /* Look up the IDs so the items don't need to be made. */
+        iConstForEach(Array, i, &d->bookmarkIds) {
+            if (*(const uint32_t *) i.value == (uint32_t) id) {
+                return index_ArrayConstIterator(&i);
+            }
+        }
+        return iInvalidPos;
+    }
     for (size_t i = 0; i < numItems_ListWidget(d->list); i++) {
         const iSidebarItem *item = constItem_ListWidget(d->list, i);
         if (item->id == id) {
@@ -1417,6 +1462,7 @@ void init_SidebarWidget(iSidebarWidget *d, enum iSidebarSide side) {
     d->actions       = NULL;
     d->closedFolders = new_IntSet();
     init_String(&d->bookmarkFilter);
+    init_Array(&d->bookmarkIds, sizeof(uint32_t));
     init_String(&d->structureHost);
     d->structureUrls    = new_StringSet();
     d->structureUnfolds = new_StringSet();
@@ -1553,10 +1599,12 @@ void init_SidebarWidget(iSidebarWidget *d, enum iSidebarSide side) {
 }
 
 void deinit_SidebarWidget(iSidebarWidget *d) {
+    setContextItem_SidebarWidget_(d, NULL);
     iRelease(d->structureUnfolds);
     iRelease(d->structureUrls);
     deinit_String(&d->structureHost);
     deinit_String(&d->bookmarkFilter);
+    deinit_Array(&d->bookmarkIds);
     delete_IntSet(d->closedFolders);
     deinit_String(&d->cmdPrefix);
 }
@@ -1589,6 +1637,48 @@ static iGmIdentity *hoverIdentity_SidebarWidget_(const iSidebarWidget *d) {
     return NULL;
 }
 
+static iBool isInsideFolder_Bookmark_(void *context, const iBookmark *bm) {
+    return hasParent_Bookmark(bm, *(const uint32_t *) context);
+}
+
+static void toggleFolder_SidebarWidget_(iSidebarWidget *d, size_t folderIndex) {
+    /* Only the folder's contents are added or removed; rest of the list is kept as is. */
+    if (folderIndex >= size_Array(&d->bookmarkIds)) {
+        return;
+    }
+    uint32_t folderId = constValue_Array(&d->bookmarkIds, folderIndex, uint32_t);
+    if (contains_IntSet(d->closedFolders, folderId)) {
+        remove_IntSet(d->closedFolders, folderId);
+        setRecentFolder_Bookmarks(bookmarks_App(), folderId);
+        size_t pos = folderIndex + 1;
+        iConstForEach(PtrArray,
+                      i,
+                      list_Bookmarks(
+                          bookmarks_App(), cmpTree_Bookmark, isInsideFolder_Bookmark_, &folderId)) {
+            const iBookmark *bm = i.ptr;
+            if (!isBookmarkFolded_SidebarWidget_(d, bm)) {
+                insert_Array(&d->bookmarkIds, pos, &(uint32_t){ id_Bookmark(bm) });
+                insertItem_ListWidget(d->list, pos++, NULL);
+            }
+        }
+    }
+    else {
+        insert_IntSet(d->closedFolders, folderId);
+        setRecentFolder_Bookmarks(bookmarks_App(), 0);
+        const size_t pos = folderIndex + 1;
+        while (pos < size_Array(&d->bookmarkIds)) {
+            const iBookmark *bm =
+                get_Bookmarks(bookmarks_App(), constValue_Array(&d->bookmarkIds, pos, uint32_t));
+            if (!bm || !hasParent_Bookmark(bm, folderId)) {
+                break;
+            }
+            remove_Array(&d->bookmarkIds, pos);
+            removeItem_ListWidget(d->list, pos);
+        }
+    }
+    updateItem_ListWidget(d->list, folderIndex); /* folder icon */
+}
+
 static void itemClicked_SidebarWidget_(iSidebarWidget *d, iSidebarItem *item, size_t itemIndex,
                                        int mouseButton) {
     const int mouseTabMode =
@@ -1642,15 +1732,7 @@ static void itemClicked_SidebarWidget_(iSidebarWidget *d, iSidebarItem *item, si
         case bookmarks_SidebarMode:
             /* Bookmark folder folding is toggled when clicking. */
             if (isEmpty_String(&item->url) /* is a folder */) {
-                if (contains_IntSet(d->closedFolders, item->id)) {
-                    remove_IntSet(d->closedFolders, item->id);
-                    setRecentFolder_Bookmarks(bookmarks_App(), item->id);
-                }
-                else {
-                    insert_IntSet(d->closedFolders, item->id);
-                    setRecentFolder_Bookmarks(bookmarks_App(), 0);
-                }
-                updateItems_SidebarWidget_(d);
+                toggleFolder_SidebarWidget_(d, itemIndex); /* `item` becomes invalid */
                 break;
             }
             else {
@@ -1662,7 +1744,7 @@ static void itemClicked_SidebarWidget_(iSidebarWidget *d, iSidebarItem *item, si
                 }
             }
             if (d->isEditing) {
-                d->contextItem  = item;
+                setContextItem_SidebarWidget_(d, item);
                 d->contextIndex = itemIndex;
                 setFocus_Widget(NULL);
                 postCommand_Widget(d, "bookmark.edit");
@@ -2073,6 +2155,33 @@ static iBool isFolder_(void *context, const iBookmark *bm) {
     return isFolder_Bookmark(bm);
 }
 
+static iBool updateDocumentItem_SidebarWidget_(iSidebarWidget *d, const iDocumentWidget *doc) {
+    /* Refresh the status of a single open document without rebuilding the list. */
+    iBool isKnown = iFalse;
+    iConstForEach(ObjectList, i, listDocuments_App(as_Widget(d)->root)) {
+        if (i.object == doc) {
+            isKnown = iTrue;
+            break;
+        }
+    }
+    if (!isKnown) {
+        return iFalse;
+    }
+    const iString *docId = id_Widget(constAs_Widget(doc));
+    for (size_t i = 0; i < numItems_ListWidget(d->list); i++) {
+        iSidebarItem *item = item_ListWidget(d->list, i);
+        if (equal_String(&item->meta, docId)) {
+            item->id = (isRequestOngoing_DocumentWidget(doc) ? 1 : 0);
+            if (numActivePlayers_Media(constMedia_GmDocument(document_DocumentWidget(doc)))) {
+                item->id |= 2;
+            }
+            updateItem_ListWidget(d->list, i);
+            return iTrue;
+        }
+    }
+    return iFalse;
+}
+
 static void handleFeedUnsubscribeCommand_SidebarWidget_(iSidebarWidget *d, const char *cmd,
                                                         iBookmark *feedBookmark) {
     if (arg_Command(cmd) /* was confirmed? */) {
@@ -2172,6 +2281,14 @@ static iBool processEvent_SidebarWidget_(iSidebarWidget *d, const SDL_Event *ev)
                 scrollOffset_ListWidget(d->list, 0);
             }
         }
+        else if (equal_Command(cmd, "document.layout.finished")) {
+            /* The outline and links were incomplete while the page was being laid out. */
+            if ((d->mode == documentOutline_SidebarMode || d->mode == siteStructure_SidebarMode) &&
+                pointerLabel_Command(cmd, "doc") == document_App()) {
+                updateItems_SidebarWidget_(d);
+            }
+            return iFalse;
+        }
         else if (equal_Command(cmd, "sidebar.modes.changed")) {
             checkModeButtonLayout_SidebarWidget_(d);
             arrange_Widget(parent_Widget(d->modeButtons[0]));
@@ -2232,7 +2349,9 @@ static iBool processEvent_SidebarWidget_(iSidebarWidget *d, const SDL_Event *ev)
                   equal_Command(cmd, "document.request.finished"))) {
             /* TODO: There are no notifications for audio player starting/stopping.
                These would be useful for updating the active-player status icons. */
-            updateItemsWithFlags_SidebarWidget_(d, iTrue);
+            if (!updateDocumentItem_SidebarWidget_(d, pointerLabel_Command(cmd, "doc"))) {
+                updateItemsWithFlags_SidebarWidget_(d, iTrue);
+            }
             return iFalse;
         }
         else if (equal_Command(cmd, "idents.changed") && d->mode == identities_SidebarMode) {
@@ -2297,7 +2416,7 @@ static iBool processEvent_SidebarWidget_(iSidebarWidget *d, const SDL_Event *ev)
         }
         else if (isCommand_Widget(w, ev, "list.delete")) {
             if (d->mode == bookmarks_SidebarMode) {
-                d->contextItem = item_ListWidget(d->list, arg_Command(cmd));
+                setContextItem_SidebarWidget_(d, item_ListWidget(d->list, arg_Command(cmd)));
                 postCommand_Widget(w, "bookmark.delete");
                 return iTrue;
             }
@@ -2854,12 +2973,12 @@ static iBool processEvent_SidebarWidget_(iSidebarWidget *d, const SDL_Event *ev)
             return iTrue;
         }
         if (ev->button.button == SDL_BUTTON_RIGHT) {
-            d->contextItem = NULL;
+            setContextItem_SidebarWidget_(d, NULL);
             if (!isVisible_Widget(d->menu) && !isEmulatedMouseDevice_UserEvent(ev)) {
                 updateMouseHover_ListWidget(d->list);
             }
             if (constHoverItem_ListWidget(d->list) || isVisible_Widget(d->menu)) {
-                d->contextItem = hoverItem_ListWidget(d->list);
+                setContextItem_SidebarWidget_(d, hoverItem_ListWidget(d->list));
                 if (isMobile_Platform()) {
                     setCursorItem_ListWidget(d->list, hoverItemIndex_ListWidget(d->list));
                 }
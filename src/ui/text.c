@@ -23,6 +23,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "text.h"
 #include "color.h"
 #include "paint.h"
+#include "profiler.h"
+#include "texturepool.h"
 
 #include <the_Foundation/regexp.h>
 #include <SDL_hints.h>
@@ -341,11 +343,7 @@ void init_TextBuf(iTextBuf *d, iWrapText *wrapText, int font, int color) {
     d->size = measure_WrapText(wrapText, font).bounds.size;
     SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
     if (d->size.x * d->size.y) {
-        d->texture = SDL_CreateTexture(render,
-                                       SDL_PIXELFORMAT_RGBA4444,
-                                       SDL_TEXTUREACCESS_STATIC | SDL_TEXTUREACCESS_TARGET,
-                                       d->size.x,
-                                       d->size.y);
+        d->texture = acquire_TexturePool(render, SDL_PIXELFORMAT_RGBA4444, d->size);
     }
     else {
         d->texture = NULL;
@@ -368,7 +366,7 @@ void init_TextBuf(iTextBuf *d, iWrapText *wrapText, int font, int color) {
 }
 
 void deinit_TextBuf(iTextBuf *d) {
-    SDL_DestroyTexture(d->texture);
+    release_TexturePool(d->texture);
 }
 
 iTextBuf *newRange_TextBuf(int font, int color, iRangecc text) {
@@ -379,6 +377,7 @@ void draw_TextBuf(const iTextBuf *d, iInt2 pos, int color) {
     addv_I2(&pos, origin_Paint);
     const iColor clr = get_Color(color);
     SDL_SetTextureColorMod(d->texture, clr.r, clr.g, clr.b);
+    iCountFrame(renderCopies);
     SDL_RenderCopy(current_Text()->render,
                    d->texture,
                    &(SDL_Rect){ 0, 0, d->size.x, d->size.y },
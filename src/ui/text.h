@@ -78,6 +78,8 @@ iChar   missing_Text            (size_t index);
 void    resetMissing_Text       (iText *);
 iBool   checkMissing_Text       (void); /* returns the flag, and clears it */
 SDL_Texture *glyphCache_Text    (void);
+size_t  glyphCacheSize_Text     (const iText *); /* texture bytes */
+void    fallbackCacheStats_Text (const iText *, size_t *hits, size_t *probesSaved);
 
 /*----------------------------------------------------------------------------------------------*/
 
@@ -22,6 +22,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "text.h"
 #include "defs.h"
+#include "profiler.h"
 #include <SDL_version.h>
 
 iDeclareType(Font)
@@ -362,6 +363,7 @@ static void runSimple_Font_(iFont *d, const iRunArgs *args) {
                 SDL_RenderFillRect(render, &dst);
             }
 #if defined (LAGRANGE_ENABLE_STB_TRUETYPE)
+            iCountFrame(renderCopies);
             SDL_RenderCopy(render, cache, &src, &dst);
 #endif
 #if defined (SDL_SEAL_CURSES)
@@ -387,8 +389,8 @@ static void runSimple_Font_(iFont *d, const iRunArgs *args) {
             const iChar next = nextChar_(&peek, args->text.end);
             if (enableKerning_Text && next) {
                 const uint32_t nextGlyphIndex = glyphIndex_Font_(glyph->font, next);
-                int kern = stbtt_GetGlyphKernAdvance(
-                    &glyph->font->font.file->stbInfo, index_Glyph_(glyph), nextGlyphIndex);
+                int kern = glyphKernAdvance_FontFile(
+                    glyph->font->font.file, index_Glyph_(glyph), nextGlyphIndex);
                 /* Nunito needs some kerning fixes. */
                 if (glyph->font->font.spec->flags & fixNunitoKerning_FontSpecFlag) {
                     if (ch == 'W' && (next == 'i' || next == 'h')) {
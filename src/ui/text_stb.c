@@ -47,7 +47,9 @@ Optimization notes:
 #include "resources.h"
 #include "window.h"
 #include "paint.h"
+#include "profiler.h"
 #include "app.h"
+#include "trace.h"
 
 #include <the_Foundation/array.h>
 #include <the_Foundation/file.h>
@@ -97,6 +99,7 @@ enum iGlyphFlag {
 
 int   enableHalfPixelGlyphs_Text    = iTrue; /* debug setting */
 int   enableKerning_Text            = iTrue; /* note: looking up kern pairs is slow */
+int   enableShapingFastPath_Text    = iTrue; /* debug setting */
 
 static int numOffsetSteps_Glyph_    = 4;   /* subpixel offsets for glyphs */
 static int rasterizedAll_GlyphFlag_ = 0xf; /* updated with numOffsetSteps_Glyph */
@@ -266,6 +269,19 @@ static int cmp_PrioMapItem_(const void *a, const void *b) {
     return -iCmp(i->priority, j->priority);
 }
 
+iDeclareType(FallbackEntry)
+
+#define iFallbackCacheSize  4096 /* must be a power of two */
+
+/* Resolved font for a character. Glyph coverage does not depend on the size, so entries are
+   keyed by the character, the requested font family, and the style. */
+struct Impl_FallbackEntry {
+    uint32_t key;    /* zero if unused */
+    uint16_t family; /* index of the resolved font family */
+    uint16_t probes; /* glyph lookups that were needed to resolve this */
+    uint32_t glyphIndex;
+};
+
 iDeclareType(FontRunArgs)
 iDeclareType(FontRun)
 iDeclareTypeConstructionArgs(FontRun, const iFontRunArgs *args, const iRangecc text, uint32_t crc)
@@ -289,6 +305,9 @@ struct Impl_StbText {
     iBool          missingGlyphs;  /* true if a glyph couldn't be found */
     iChar          missingChars[20]; /* rotating buffer of the latest missing characters */
     iFontRun *     cachedFontRuns[16]; /* recently generated HarfBuzz glyph buffers */
+    iFallbackEntry fallbackCache[iFallbackCacheSize]; /* direct-mapped */
+    size_t         fallbackHits;
+    size_t         fallbackProbesSaved;
 };
 
 iLocalDef iStbText *current_StbText_(void) {
@@ -361,6 +380,7 @@ static void initFonts_StbText_(iStbText *d) {
        and styles for each available font. Indices to `fonts` act as font runtime IDs. */
     /* First the mandatory fonts. */
     d->overrideFontId = -1;
+    iZap(d->fallbackCache); /* font IDs are about to change */
     clear_Array(&d->fontPriorityOrder);
     resize_Array(&d->fonts, auxiliary_FontId); /* room for the built-ins */
     setupFontVariants_StbText_(d, tryFindSpec_(uiFont_PrefsString, "default"), default_FontId);
@@ -459,6 +479,9 @@ void init_StbText(iStbText *d, SDL_Renderer *render, float documentFontSizeFacto
     d->missingGlyphs   = iFalse;
     iZap(d->missingChars);
     iZap(d->cachedFontRuns);
+    iZap(d->fallbackCache);
+    d->fallbackHits        = 0;
+    d->fallbackProbesSaved = 0;
     /* A grayscale palette for rasterized glyphs. */ {
         SDL_Color colors[256];
         for (int i = 0; i < 256; ++i) {
@@ -543,6 +566,7 @@ static SDL_Palette *glyphPalette_(void) {
 }
 
 static SDL_Surface *rasterizeGlyph_Font_(const iFont *d, uint32_t glyphIndex, float xShift) {
+    iCountFrame(glyphsRasterized);
     int w, h;
     uint8_t *bmp = rasterizeGlyph_FontFile(d->font.file, d->xScale, d->yScale, xShift, glyphIndex,
                                            &w, &h);
@@ -605,11 +629,8 @@ static void allocate_Font_(iFont *d, iGlyph *glyph, int hoff) {
     }
 }
 
-iLocalDef iFont *characterFont_Font_(iFont *d, iChar ch, uint32_t *glyphIndex) {
-    if (isVariationSelector_Char(ch)) {
-        return d;
-    }
-
+static iFont *resolveCharacterFont_Font_(iFont *d, iChar ch, uint32_t *glyphIndex,
+                                         int *probes) {
     const enum iFontStyle styleId      = styleId_Text_(d);
     const enum iFontSize  sizeId       = sizeId_Text_(d);
     const iBool           isMonospaced = isMonospaced_Font(d);
@@ -618,11 +639,15 @@ iLocalDef iFont *characterFont_Font_(iFont *d, iChar ch, uint32_t *glyphIndex) {
     if (ch != 0x20 && current_StbText_()->overrideFontId >= 0) {
         /* Override font is checked first. */
         overrideFont = font_Text_(FONT_ID(current_StbText_()->overrideFontId, styleId, sizeId));
-        if (overrideFont != d && (*glyphIndex = glyphIndex_Font_(overrideFont, ch)) != 0) {
-            return overrideFont;
+        if (overrideFont != d) {
+            (*probes)++;
+            if ((*glyphIndex = glyphIndex_Font_(overrideFont, ch)) != 0) {
+                return overrideFont;
+            }
         }
     }
     /* The font's own version of the glyph. */
+    (*probes)++;
     if ((*glyphIndex = glyphIndex_Font_(d, ch)) != 0) {
         return d;
     }
@@ -637,6 +662,7 @@ iLocalDef iFont *characterFont_Font_(iFont *d, iChar ch, uint32_t *glyphIndex) {
             if (preferMonospaced && !isMonospaced_Font(font)) {
                 continue;
             }
+            (*probes)++;
             if ((*glyphIndex = glyphIndex_Font_(font, ch)) != 0) {
 #if 0
             printf("using '%s' (pr:%d) for %lc (%x) => %d  [missing in '%s']\n",
@@ -673,6 +699,44 @@ iLocalDef iFont *characterFont_Font_(iFont *d, iChar ch, uint32_t *glyphIndex) {
     return d;
 }
 
+static iFont *characterFont_Font_(iFont *d, iChar ch, uint32_t *glyphIndex) {
+    if (isVariationSelector_Char(ch)) {
+        return d;
+    }
+    iStbText *tx = current_StbText_();
+    const int family = fontId_Text_(d) / maxVariants_Fonts;
+    if (ch < 0x80 || family > 0xff) {
+        /* ASCII glyph indices are already in a lookup table. */
+        int probes = 0;
+        return resolveCharacterFont_Font_(d, ch, glyphIndex, &probes);
+    }
+    const enum iFontStyle styleId = styleId_Text_(d);
+    const uint32_t key = ch | ((uint32_t) styleId << 21) | ((uint32_t) family << 24);
+    iFallbackEntry *entry =
+        &tx->fallbackCache[((key * 2654435761u) >> 20) & (iFallbackCacheSize - 1)];
+    if (entry->key == key) {
+        tx->fallbackHits++;
+        tx->fallbackProbesSaved += entry->probes;
+        *glyphIndex = entry->glyphIndex;
+        return font_Text_(FONT_ID(entry->family * maxVariants_Fonts, styleId, sizeId_Text_(d)));
+    }
+    int probes = 0;
+    iFont *font = resolveCharacterFont_Font_(d, ch, glyphIndex, &probes);
+    if (*glyphIndex) { /* missing glyphs are reported each time */
+        *entry = (iFallbackEntry){ .key        = key,
+                                   .family     = fontId_Text_(font) / maxVariants_Fonts,
+                                   .probes     = iMin(probes, 0xffff),
+                                   .glyphIndex = *glyphIndex };
+    }
+    return font;
+}
+
+void fallbackCacheStats_Text(const iText *d, size_t *hits, size_t *probesSaved) {
+    const iStbText *tx = (const iStbText *) d;
+    *hits        = tx->fallbackHits;
+    *probesSaved = tx->fallbackProbesSaved;
+}
+
 static iGlyph *glyphByIndex_Font_(iFont *d, uint32_t glyphIndex) {
     if (!d->table) {
         d->table = new_GlyphTable();
@@ -743,6 +807,7 @@ struct Impl_RasterGlyph {
 };
 
 static void cacheGlyphs_Font_(iFont *d, const uint32_t *glyphIndices, size_t numGlyphIndices) {
+    iTrace("cacheGlyphs_Font");
     /* TODO: Make this an object so it can be used sequentially without reallocating buffers. */
     SDL_Surface *buf     = NULL;
     const iInt2  bufSize = init_I2(iMin(1024, d->font.height * iMin(5 * numGlyphIndices, 20)),
@@ -838,6 +903,7 @@ static void cacheGlyphs_Font_(iFont *d, const uint32_t *glyphIndices, size_t num
                 const iRasterGlyph *rg = i.value;
 //                iAssert(isEqual_I2(rg->rect.size, rg->glyph->rect[rg->hoff].size));
                 const iRect *glRect = &rg->glyph->rect[rg->hoff];
+                iCountFrame(renderCopies);
                 SDL_RenderCopy(render,
                                bufTex,
                                (const SDL_Rect *) &rg->rect,
@@ -967,6 +1033,33 @@ static void shape_GlyphBuffer_(iGlyphBuffer *d) {
     }
 }
 
+/* ASCII in a monospaced font without ligature or kerning features has nothing to apply, so
+   shaping it is just a cmap lookup. The buffer is filled directly without calling HarfBuzz.
+   Programming fonts like Fira Code and Iosevka do have ligatures and must be shaped. */
+static iBool isShapingTrivial_GlyphBuffer_(const iGlyphBuffer *d, const iAttributedRun *run) {
+    if (!enableShapingFastPath_Text || run->flags.script || !isMonospaced_Font(d->font) ||
+        d->font->font.file->hasDefaultFeatures) {
+        return iFalse;
+    }
+    for (int pos = run->logical.start; pos < run->logical.end; pos++) {
+        if (d->logicalText[pos] >= 0x80) {
+            return iFalse;
+        }
+    }
+    return iTrue;
+}
+
+static void shapeTrivially_GlyphBuffer_(iGlyphBuffer *d) {
+    hb_buffer_set_content_type(d->hb, HB_BUFFER_CONTENT_TYPE_GLYPHS);
+    d->glyphInfo = hb_buffer_get_glyph_infos(d->hb, &d->glyphCount);
+    d->glyphPos  = hb_buffer_get_glyph_positions(d->hb, &d->glyphCount); /* zeroed */
+    for (unsigned int i = 0; i < d->glyphCount; i++) {
+        const uint32_t glyphIndex = glyphIndex_Font_(d->font, d->glyphInfo[i].codepoint);
+        d->glyphInfo[i].codepoint = glyphIndex;
+        d->glyphPos[i].x_advance  = glyphAdvance_FontFile(d->font->font.file, glyphIndex);
+    }
+}
+
 static float advance_GlyphBuffer_(const iGlyphBuffer *d, iRangei wrapPosRange) {
     float x = 0.0f;
     for (unsigned int i = 0; i < d->glyphCount; i++) {
@@ -1167,12 +1260,23 @@ void init_FontRun(iFontRun *d, const iFontRunArgs *args, const iRangecc text, ui
         init_GlyphBuffer_(buf, (iFont *) run->font, logicalText);
         /* Insert the text in visual order (LTR) in the HarfBuzz buffer for shaping.
            First we need to map the logical run to the corresponding visual run. */
-        int v[2] = { logToVis[run->logical.start], logToVis[run->logical.end - 1] };
-        if (v[0] > v[1]) {
-            iSwap(int, v[0], v[1]); /* always LTR */
+        if (d->attrText.isVisualOrder) {
+            for (int pos = run->logical.start; pos < run->logical.end; pos++) {
+                hb_buffer_add(buf->hb, logicalText[pos], pos);
+            }
         }
-        for (int vis = v[0]; vis <= v[1]; vis++) {
-            hb_buffer_add(buf->hb, visualText[vis], visToLog[vis]);
+        else {
+            int v[2] = { logToVis[run->logical.start], logToVis[run->logical.end - 1] };
+            if (v[0] > v[1]) {
+                iSwap(int, v[0], v[1]); /* always LTR */
+            }
+            for (int vis = v[0]; vis <= v[1]; vis++) {
+                hb_buffer_add(buf->hb, visualText[vis], visToLog[vis]);
+            }
+        }
+        if (isShapingTrivial_GlyphBuffer_(buf, run)) {
+            shapeTrivially_GlyphBuffer_(buf);
+            continue;
         }
         hb_buffer_set_content_type(buf->hb, HB_BUFFER_CONTENT_TYPE_UNICODE);
         hb_buffer_set_direction(buf->hb, HB_DIRECTION_LTR); /* visual */
@@ -1360,6 +1464,7 @@ void process_RunLayer_(iRunLayer *d, int layerIndex) {
                     }
                     SDL_Rect src;
                     memcpy(&src, &glyph->rect[hoff], sizeof(SDL_Rect));
+                    iCountFrame(renderCopies);
                     SDL_RenderCopy(current_Text()->render, current_StbText_()->cache, &src, &dst);
                 }
 #if 0
@@ -1392,15 +1497,9 @@ static unsigned fontRunCacheTotal_ = 0;
 static iFontRun *makeOrFindCachedFontRun_StbText_(iStbText *d, const iFontRunArgs *runArgs,
                                                   const iRangecc text, iBool *wasFound) {
     fontRunCacheTotal_++;
-#if 0
     if (fontRunCacheTotal_ % 100 == 0) {
-        printf("FONT RUN CACHE: %d/%d rate:%.1f%%\n",
-               fontRunCacheHits_,
-               fontRunCacheTotal_,
-               (float) fontRunCacheHits_ / (float) fontRunCacheTotal_ * 100);
-        fflush(stdout);
+        iTraceCounter("fontRunCacheHitPercent", fontRunCacheHits_ * 100 / fontRunCacheTotal_);
     }
-#endif
     const uint32_t crc = iCrc32(text.start, size_Range(&text));
     iForIndices(i, d->cachedFontRuns) {
         if (d->cachedFontRuns[i] && d->cachedFontRuns[i]->textCrc32 == crc &&
@@ -1843,3 +1942,8 @@ void resetMissing_Text(iText *d) {
 SDL_Texture *glyphCache_Text(void) {
     return current_StbText_()->cache;
 }
+
+size_t glyphCacheSize_Text(const iText *d) {
+    const iStbText *tx = (const iStbText *) d;
+    return tx->cache ? 2 * tx->cacheSize.x * tx->cacheSize.y : 0; /* RGBA4444 */
+}
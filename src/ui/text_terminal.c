@@ -178,6 +178,16 @@ SDL_Texture *glyphCache_Text(void) {
     return NULL;
 }
 
+size_t glyphCacheSize_Text(const iText *d) {
+    iUnused(d);
+    return 0;
+}
+
+void fallbackCacheStats_Text(const iText *d, size_t *hits, size_t *probesSaved) {
+    iUnused(d);
+    *hits = *probesSaved = 0;
+}
+
 void setOpacity_Text(float opacity) {
     iUnused(opacity);
 }
@@ -0,0 +1,199 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#include "texturepool.h"
+
+#include <the_Foundation/array.h>
+
+iDeclareType(PooledTexture)
+
+struct Impl_PooledTexture {
+    SDL_Texture  *texture;
+    SDL_Renderer *render;
+    uint32_t      format;
+    iInt2         size; /* bucketed */
+    iBool         isIdle;
+    uint32_t      releaseOrder; /* least recently released are destroyed first */
+};
+
+#if defined (iPlatformMobile)
+static const size_t idleBudget_TexturePool_ = 16 * 1000000;
+#else
+static const size_t idleBudget_TexturePool_ = 64 * 1000000;
+#endif
+
+static iArray  *pool_;
+static size_t   idleSize_;
+static size_t   totalSize_;
+static uint32_t releaseCounter_;
+
+static iArray *pool_TexturePool_(void) {
+    if (!pool_) {
+        pool_ = new_Array(sizeof(iPooledTexture));
+    }
+    return pool_;
+}
+
+static int bucket_TexturePool_(int dim) {
+    /* Round up to 1/8 of the next power of two, so the waste is at most 12.5% while small
+       size changes (e.g., resizing a window) don't need a new texture. */
+    int pow2 = 16;
+    while (pow2 < dim) {
+        pow2 <<= 1;
+    }
+    const int step = iMax(16, pow2 / 8);
+    return (dim + step - 1) / step * step;
+}
+
+static size_t byteSize_PooledTexture_(const iPooledTexture *d) {
+    return (size_t) SDL_BYTESPERPIXEL(d->format) * d->size.x * d->size.y;
+}
+
+static void destroy_TexturePool_(size_t index) {
+    iArray         *pool = pool_TexturePool_();
+    iPooledTexture *tex  = at_Array(pool, index);
+    const size_t    size = byteSize_PooledTexture_(tex);
+    if (tex->isIdle) {
+        idleSize_ -= size;
+    }
+    totalSize_ -= size;
+    SDL_DestroyTexture(tex->texture);
+    remove_Array(pool, index);
+}
+
+static void trim_TexturePool_(void) {
+    while (idleSize_ > idleBudget_TexturePool_) {
+        const iPooledTexture *oldest = NULL;
+        size_t oldestIndex = iInvalidPos;
+        iConstForEach(Array, i, pool_TexturePool_()) {
+            const iPooledTexture *tex = i.value;
+            if (tex->isIdle && (!oldest || tex->releaseOrder < oldest->releaseOrder)) {
+                oldest      = tex;
+                oldestIndex = index_ArrayConstIterator(&i);
+            }
+        }
+        if (!oldest) {
+            break;
+        }
+        destroy_TexturePool_(oldestIndex);
+    }
+}
+
+SDL_Texture *acquire_TexturePool(SDL_Renderer *render, uint32_t format, iInt2 size) {
+    if (size.x <= 0 || size.y <= 0) {
+        return NULL;
+    }
+    const iInt2     bucket = init_I2(bucket_TexturePool_(size.x), bucket_TexturePool_(size.y));
+    iPooledTexture *found  = NULL;
+    iForEach(Array, i, pool_TexturePool_()) {
+        iPooledTexture *tex = i.value;
+        if (tex->isIdle && tex->render == render && tex->format == format &&
+            isEqual_I2(tex->size, bucket) &&
+            (!found || tex->releaseOrder > found->releaseOrder)) {
+            found = tex;
+        }
+    }
+    if (found) {
+        found->isIdle = iFalse;
+        idleSize_ -= byteSize_PooledTexture_(found);
+        /* Reset to the state of a new texture. */
+        SDL_SetTextureBlendMode(found->texture,
+                                SDL_ISPIXELFORMAT_ALPHA(format) ? SDL_BLENDMODE_BLEND
+                                                                : SDL_BLENDMODE_NONE);
+        SDL_SetTextureColorMod(found->texture, 255, 255, 255);
+        SDL_SetTextureAlphaMod(found->texture, 255);
+        return found->texture;
+    }
+    iPooledTexture tex = {
+        .texture = SDL_CreateTexture(render,
+                                     format,
+                                     SDL_TEXTUREACCESS_STATIC | SDL_TEXTUREACCESS_TARGET,
+                                     bucket.x,
+                                     bucket.y),
+        .render  = render,
+        .format  = format,
+        .size    = bucket,
+    };
+    if (!tex.texture) {
+        return NULL;
+    }
+    pushBack_Array(pool_TexturePool_(), &tex);
+    totalSize_ += byteSize_PooledTexture_(&tex);
+    return tex.texture;
+}
+
+void release_TexturePool(SDL_Texture *texture) {
+    if (!texture) {
+        return;
+    }
+    iForEach(Array, i, pool_TexturePool_()) {
+        iPooledTexture *tex = i.value;
+        if (tex->texture == texture) {
+            iAssert(!tex->isIdle);
+            tex->isIdle       = iTrue;
+            tex->releaseOrder = ++releaseCounter_;
+            idleSize_ += byteSize_PooledTexture_(tex);
+            trim_TexturePool_();
+            return;
+        }
+    }
+    SDL_DestroyTexture(texture); /* not from the pool */
+}
+
+void clear_TexturePool(void) {
+    if (!pool_) {
+        return;
+    }
+    for (size_t i = size_Array(pool_); i-- > 0; ) {
+        if (((const iPooledTexture *) constAt_Array(pool_, i))->isIdle) {
+            destroy_TexturePool_(i);
+        }
+    }
+}
+
+void removeRenderer_TexturePool(SDL_Renderer *render) {
+    if (!pool_) {
+        return;
+    }
+    for (size_t i = size_Array(pool_); i-- > 0; ) {
+        iPooledTexture *tex = at_Array(pool_, i);
+        if (tex->render != render) {
+            continue;
+        }
+        if (tex->isIdle) {
+            destroy_TexturePool_(i);
+        }
+        else {
+            /* Still in use, but will be destroyed with the renderer. */
+            totalSize_ -= byteSize_PooledTexture_(tex);
+            remove_Array(pool_, i);
+        }
+    }
+}
+
+size_t idleMemorySize_TexturePool(void) {
+    return idleSize_;
+}
+
+size_t memorySize_TexturePool(void) {
+    return totalSize_;
+}
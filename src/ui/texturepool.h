@@ -0,0 +1,41 @@
+/* Copyright 2026 Jaakko Keränen <jaakko.keranen@iki.fi>
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+1. Redistributions of source code must retain the above copyright notice, this
+   list of conditions and the following disclaimer.
+2. Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND
+ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR
+ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+(INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON
+ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+(INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
+
+#pragma once
+
+/* Render target textures are recycled through a shared pool instead of being created and
+   destroyed whenever a buffer changes size. Sizes are rounded up to buckets, so an acquired
+   texture may be larger than requested and only its top left part should be used. Released
+   textures stay in the pool for reuse up to a memory budget. All use happens on the main
+   thread. */
+
+#include "defs.h"
+#include <the_Foundation/vec2.h>
+#include <SDL_render.h>
+
+SDL_Texture *   acquire_TexturePool         (SDL_Renderer *, uint32_t format, iInt2 size);
+void            release_TexturePool         (SDL_Texture *);
+void            clear_TexturePool           (void); /* destroys idle textures */
+void            removeRenderer_TexturePool  (SDL_Renderer *); /* renderer is about to be destroyed */
+
+size_t          idleMemorySize_TexturePool  (void); /* bytes in textures waiting for reuse */
+size_t          memorySize_TexturePool      (void); /* bytes in all pooled textures */
@@ -3593,6 +3593,7 @@ iWidget *makePreferences_Widget(void) {
             { "input id:prefs.urlsize maxlen:7 selectall:1" },
             { "padding" },
             { "toggle id:prefs.redirect.allowscheme" },
+            { "toggle id:prefs.prefetch" },
             { "padding" },
             { NULL }
         };
@@ -4064,6 +4065,7 @@ iWidget *makePreferences_Widget(void) {
                      "prefs.page.network");
         addDialogToggle_Widget(headings, values, "${prefs.warn.security}", "prefs.warn.security");
         addDialogToggle_Widget(headings, values, "${prefs.redirect.allowscheme}", "prefs.redirect.allowscheme");
+        addDialogToggle_Widget(headings, values, "${prefs.prefetch}", "prefs.prefetch");
         addDialogToggle_Widget(headings, values, "${prefs.decodeurls}", "prefs.decodeurls");
         addPrefsInputWithHeading_(headings, values, "prefs.urlsize", iClob(new_InputWidget(10)));
         makeTwoColumnHeading_("${heading.prefs.proxies}", headings, values);
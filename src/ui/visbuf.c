@@ -22,6 +22,8 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "visbuf.h"
 #include "paint.h"
+#include "profiler.h"
+#include "texturepool.h"
 #include "window.h"
 #include "util.h"
 
@@ -56,16 +58,9 @@ iBool alloc_VisBuf(iVisBuf *d, const iInt2 size, int granularity) {
         d->texSize = texSize;
         iForIndices(i, d->buffers) {
             iVisBufTexture *tex = &d->buffers[i];
-            if (tex->texture) {
-                SDL_DestroyTexture(tex->texture);
-            }
-            SDL_Renderer *rend = renderer_Window(get_Window());
-            tex->texture =
-                SDL_CreateTexture(rend,
-                                  SDL_PIXELFORMAT_RGBA8888,
-                                  SDL_TEXTUREACCESS_STATIC | SDL_TEXTUREACCESS_TARGET,
-                                  texSize.x,
-                                  texSize.y);
+            release_TexturePool(tex->texture);
+            tex->texture = acquire_TexturePool(
+                renderer_Window(get_Window()), SDL_PIXELFORMAT_RGBA8888, texSize);
             SDL_SetTextureBlendMode(tex->texture, SDL_BLENDMODE_NONE);
         }
         invalidate_VisBuf(d);
@@ -77,7 +72,7 @@ iBool alloc_VisBuf(iVisBuf *d, const iInt2 size, int granularity) {
 void dealloc_VisBuf(iVisBuf *d) {
     d->texSize = zero_I2();
     iForIndices(i, d->buffers) {
-        SDL_DestroyTexture(d->buffers[i].texture);
+        release_TexturePool(d->buffers[i].texture);
         d->buffers[i].texture = NULL;
     }
 }
@@ -237,7 +232,8 @@ void draw_VisBuf(const iVisBuf *d, const iInt2 topLeft, const iRangei yClipBound
         dst.x += get_Window()->root->rect.size.x / 4;
         dst.y += get_Window()->root->rect.size.y / 4;
 #endif
-        SDL_RenderCopy(render, buf->texture, NULL, &dst);
+        iCountFrame(renderCopies);
+        SDL_RenderCopy(render, buf->texture, &(SDL_Rect){ 0, 0, d->texSize.x, d->texSize.y }, &dst);
 #if defined (DEBUG_SCALE)
         SDL_SetRenderDrawColor(render, 0, 0, 255, 255);
         SDL_RenderDrawRect(render, &dst);
@@ -255,3 +251,10 @@ void draw_VisBuf(const iVisBuf *d, const iInt2 topLeft, const iRangei yClipBound
     SDL_RenderDrawRect(render, &dst);
 #endif
 }
+
+size_t memorySize_VisBuf(const iVisBuf *d) {
+    if (!d->buffers[0].texture) {
+        return 0;
+    }
+    return numBuffers_VisBuf * 4 * d->texSize.x * d->texSize.y; /* RGBA */
+}
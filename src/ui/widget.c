@@ -24,10 +24,13 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 
 #include "app.h"
 #include "periodic.h"
+#include "profiler.h"
 #include "touch.h"
+#include "trace.h"
 #include "command.h"
 #include "paint.h"
 #include "root.h"
+#include "texturepool.h"
 #include "util.h"
 #include "window.h"
 
@@ -86,7 +89,7 @@ static void init_WidgetDrawBuffer(iWidgetDrawBuffer *d) {
 }
 
 static void deinit_WidgetDrawBuffer(iWidgetDrawBuffer *d) {
-    SDL_DestroyTexture(d->texture);
+    release_TexturePool(d->texture);
 }
 
 iDefineTypeConstruction(WidgetDrawBuffer)
@@ -94,24 +97,16 @@ iDefineTypeConstruction(WidgetDrawBuffer)
 static void realloc_WidgetDrawBuffer(iWidgetDrawBuffer *d, SDL_Renderer *render, iInt2 size) {
     if (!isEqual_I2(d->size, size)) {
         d->size = size;
-        if (d->texture) {
-            SDL_DestroyTexture(d->texture);
-        }
-        d->texture = SDL_CreateTexture(render,
-                                       SDL_PIXELFORMAT_RGBA8888,
-                                       SDL_TEXTUREACCESS_STATIC | SDL_TEXTUREACCESS_TARGET,
-                                       size.x,
-                                       size.y);
+        release_TexturePool(d->texture); /* may be reacquired if in the same size bucket */
+        d->texture = acquire_TexturePool(render, SDL_PIXELFORMAT_RGBA8888, size);
         SDL_SetTextureBlendMode(d->texture, SDL_BLENDMODE_BLEND);
         d->isValid = iFalse;
     }
 }
 
 static void release_WidgetDrawBuffer(iWidgetDrawBuffer *d) {
-    if (d->texture) {
-        SDL_DestroyTexture(d->texture);
-        d->texture = NULL;
-    }
+    release_TexturePool(d->texture);
+    d->texture = NULL;
     d->size = zero_I2();
     d->isValid = iFalse;
 }
@@ -321,6 +316,9 @@ void setFlags_Widget(iWidget *d, int64_t flags, iBool set) {
         }
         const int64_t oldFlags = d->flags;
         iChangeFlags(d->flags, flags, set);
+        if ((oldFlags ^ d->flags) & hidden_WidgetFlag && d->root) {
+            setFullDamage_Window(d->root->window); /* may reveal anything underneath */
+        }
         if (flags & keepOnTop_WidgetFlag && !isRoot_Widget_(d)) {
             iPtrArray *onTop = onTop_Root(d->root);
             if (set) {
@@ -1073,6 +1071,7 @@ void arrange_Widget(iWidget *d) {
             puts("\n==== NEW WIDGET ARRANGEMENT ====\n");
         }
 #endif
+        iCountFrame(arrangements);
         resetArrangement_Widget_(d); /* back to initial default sizes */
         arrange_Widget_(d);
         clampCenteredInRoot_Widget_(d);
@@ -1787,6 +1786,16 @@ int backgroundFadeColor_Widget(void) {
     }
 }
 
+iLocalDef int shadowBorderWidth_Widget_(void) {
+    return 12 * gap_UI;
+}
+
+static iBool hasShadowBorder_Widget_(const iWidget *d) {
+    return d->flags & keepOnTop_WidgetFlag &&
+           ~d->flags & (mouseModal_WidgetFlag | noShadowBorder_WidgetFlag) &&
+           deviceType_App() != phone_AppDeviceType;
+}
+
 void drawLayerEffects_Widget(const iWidget *d) {
     /* Layered effects are not buffered, so they are drawn here separately. */
     iAssert(isDrawn_Widget_(d));
@@ -1804,7 +1813,7 @@ void drawLayerEffects_Widget(const iWidget *d) {
     if (shadowBorder && ~d->flags & noShadowBorder_WidgetFlag) {
         iPaint p;
         init_Paint(&p);
-        drawSoftShadow_Paint(&p, bounds_Widget(d), 12 * gap_UI, black_ColorId, 30);
+        drawSoftShadow_Paint(&p, bounds_Widget(d), shadowBorderWidth_Widget_(), black_ColorId, 30);
     }
     if (isFaded) {
         iPaint p;
@@ -1985,7 +1994,8 @@ void drawChildren_Widget(const iWidget *d) {
     }
     iConstForEach(ObjectList, i, d->children) {
         const iWidget *child = constAs_Widget(i.object);
-        if (~child->flags & keepOnTop_WidgetFlag && isDrawn_Widget_(child)) {
+        if (~child->flags & keepOnTop_WidgetFlag && isDrawn_Widget_(child) &&
+            isDamaged_Widget_(child)) {
             incrementDrawCount_(child);
             class_Widget(child)->draw(child);
         }
@@ -1999,6 +2009,9 @@ void drawRoot_Widget(const iWidget *d) {
     init_PtrArray(&pvs);
     findPotentiallyVisible_Widget_(d, &pvs);
     iReverseConstForEach(PtrArray, i, &pvs) {
+        if (!isDamaged_Widget_(i.ptr)) {
+            continue; /* retained from the previous frame */
+        }
         incrementDrawCount_(i.ptr);
         class_Widget(i.ptr)->draw(i.ptr);
     }
@@ -2051,6 +2064,7 @@ static void endBufferDraw_Widget_(const iWidget *d) {
 }
 
 void draw_Widget(const iWidget *d) {
+    iTrace("draw_Widget");
     iAssert(window_Widget(d) == get_Window());
     if (!isDrawn_Widget_(d)) {
         if (d->drawBuf) {
@@ -2071,7 +2085,9 @@ void draw_Widget(const iWidget *d) {
         iPaint p;
         init_Paint(&p);
         setClip_Paint(&p, rect_Root(d->root));
-        SDL_RenderCopy(renderer_Window(get_Window()), d->drawBuf->texture, NULL,
+        iCountFrame(renderCopies);
+        SDL_RenderCopy(renderer_Window(get_Window()), d->drawBuf->texture,
+                       &(SDL_Rect){ 0, 0, d->drawBuf->size.x, d->drawBuf->size.y },
                        &(SDL_Rect){ bounds.pos.x, bounds.pos.y,
                                     d->drawBuf->size.x, d->drawBuf->size.y });
         unsetClip_Paint(&p);
@@ -2342,6 +2358,17 @@ size_t childCount_Widget(const iWidget *d) {
     return size_ObjectList(d->children);
 }
 
+size_t drawBufferSize_Widget(const iWidget *d) {
+    size_t size = 0;
+    if (d->drawBuf && d->drawBuf->texture) {
+        size += 4 * d->drawBuf->size.x * d->drawBuf->size.y; /* RGBA */
+    }
+    iConstForEach(ObjectList, i, d->children) {
+        size += drawBufferSize_Widget(i.object);
+    }
+    return size;
+}
+
 iBool isVisible_Widget(const iAnyObject *d) {
     if (!d) return iFalse;
     iAssert(isInstance_Object(d, &Class_Widget));
@@ -2625,6 +2652,65 @@ void postCommand_Widget(const iAnyObject *d, const char *cmd, ...) {
     deinit_String(&str);
 }
 
+#if defined (LAGRANGE_ENABLE_PARTIAL_REDRAW)
+static iBool isPartiallyRefreshable_Widget_(const iWidget *d) {
+    /* Moving widgets also need to be erased from where they were in the previous frame. */
+    for (const iWidget *w = d; w; w = w->parent) {
+        if (w->flags & (visualOffset_WidgetFlag | dragged_WidgetFlag)) {
+            return iFalse;
+        }
+    }
+    return !isEnabled_Profiler();
+}
+#endif
+
+static iRect damageBounds_Widget_(const iWidget *d) {
+    /* Focus rings and such may be drawn slightly outside the bounds. */
+    iRect bounds = expanded_Rect(bounds_Widget(d), init1_I2(gap_UI));
+    if (d->flags & drawBackgroundToBottom_WidgetFlag) {
+        bounds.size.y += size_Root(d->root).y;
+    }
+    if (hasShadowBorder_Widget_(d)) {
+        bounds = expanded_Rect(bounds, init1_I2(shadowBorderWidth_Widget_()));
+    }
+    return bounds;
+}
+
+static iBool isSubtreeDamaged_Widget_(const iWidget *d, const iWindow *win) {
+    if (isDamaged_Window(win, damageBounds_Widget_(d))) {
+        return iTrue;
+    }
+    /* Children are not confined to the parent's bounds. */
+    iConstForEach(ObjectList, i, d->children) {
+        const iWidget *child = constAs_Widget(i.object);
+        if (~child->flags & (hidden_WidgetFlag | keepOnTop_WidgetFlag) &&
+            isSubtreeDamaged_Widget_(child, win)) {
+            return iTrue;
+        }
+    }
+    return iFalse;
+}
+
+static iBool isDamaged_Widget_(const iWidget *d) {
+    const iWindow *win = window_Widget(d);
+    if (isEmpty_Rect(win->drawDamage)) {
+        return iTrue; /* everything is being redrawn */
+    }
+    if (d->flags & (keepOnTop_WidgetFlag | mouseModal_WidgetFlag) ||
+        d->flags2 & fadeBackground_WidgetFlag2 || isEmpty_Rect(d->rect)) {
+        /* Layer effects may cover the entire root, and unsized widgets may have children
+           anywhere. */
+        return iTrue;
+    }
+    for (const iWidget *w = d->parent; w; w = w->parent) {
+        if (w->drawBuf) {
+            /* The buffer is retained as a whole, so its contents must always be complete. */
+            return iTrue;
+        }
+    }
+    return isSubtreeDamaged_Widget_(d, win);
+}
+
 void refresh_Widget(const iAnyObject *d) {
     if (!d) return;
     /* TODO: Could be widget specific, if parts of the tree are cached. */
@@ -2640,6 +2726,12 @@ void refresh_Widget(const iAnyObject *d) {
             w->drawBuf->isValid = iFalse;
         }
     }
+#if defined (LAGRANGE_ENABLE_PARTIAL_REDRAW)
+    if (isPartiallyRefreshable_Widget_(d)) {
+        postDamage_Window(window_Widget(d), damageBounds_Widget_(d));
+        return;
+    }
+#endif
     postRefresh_Window(window_Widget(d));
 }
 
@@ -237,6 +237,7 @@ iAny *  findFocusable_Widget            (const iWidget *startFrom, enum iWidgetF
 iAny *  findAdjacentFocusable_Widget    (const iWidget *, enum iDirection direction);
 iAny *  findOverflowScrollable_Widget   (iWidget *);
 size_t  childCount_Widget               (const iWidget *);
+size_t  drawBufferSize_Widget           (const iWidget *); /* texture bytes, including children */
 void    draw_Widget                     (const iWidget *);
 void    drawLayerEffects_Widget         (const iWidget *);
 void    drawBackground_Widget           (const iWidget *);
@@ -23,6 +23,7 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "window.h"
 
 #include "../app.h"
+#include "../imagecache.h"
 #include "bookmarks.h"
 #include "command.h"
 #include "defs.h"
@@ -32,8 +33,10 @@ SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. */
 #include "documentwidget.h"
 #include "sidebarwidget.h"
 #include "paint.h"
+#include "profiler.h"
 #include "snippets.h"
 #include "root.h"
+#include "texturepool.h"
 #include "touch.h"
 #include "util.h"
 
@@ -666,6 +669,9 @@ void init_Window(iWindow *d, enum iWindowType type, iRect rect, uint32_t flags)
     d->isInvalidated = iFalse; /* set when posting event, to avoid repeated events */
     d->isMouseInside = iTrue;
     set_Atomic(&d->isRefreshPending, iTrue);
+    set_Atomic(&d->isFullyDamaged, iTrue);
+    d->damage        = zero_Rect();
+    d->drawDamage    = zero_Rect();
     d->ignoreClick   = iFalse;
     d->focusGainedAt = SDL_GetTicks();
     d->frameTime     = SDL_GetTicks();
@@ -725,6 +731,8 @@ void deinit_Window(iWindow *d) {
     }
     deinitRoots_Window_(d);
     delete_Text(d->text);
+    removeRenderer_TexturePool(d->render);
+    removeRenderer_ImageCache(d->render);
     SDL_DestroyRenderer(d->render);
     SDL_DestroyWindow(d->win);
     iForIndices(i, d->cursors) {
@@ -741,7 +749,7 @@ static void setWindowIcon_Window_(iWindow *d) {
     useExecutableIconResource_SDLWindow(d->win);
 #   endif
 #   if defined (iPlatformLinux)
-    SDL_Surface *surf = loadImage_(&imageLagrange64_Resources, 0);
+    SDL_Surface *surf = loadImage_(load_Resources(&imageLagrange64_Resources), 0);
     SDL_SetWindowIcon(d->win, surf);
     free(surf->pixels);
     SDL_FreeSurface(surf);
@@ -779,6 +787,10 @@ void init_MainWindow(iMainWindow *d, iRect rect) {
     if (!forceSoftwareRender_App()) {
         flags |= SDL_WINDOW_OPENGL;
     }
+#endif
+#if defined (LAGRANGE_ENABLE_PARTIAL_REDRAW)
+    /* Partial redraws paint over the retained contents of the previous frame. */
+    d->enableBackBuf = iTrue;
 #endif
     SDL_SetHint(SDL_HINT_RENDER_VSYNC, "1");
     init_Window(&d->base, main_WindowType, rect, flags);
@@ -840,14 +852,14 @@ void init_MainWindow(iMainWindow *d, iRect rect) {
     setupUserInterface_MainWindow(d);
     postCommand_App("~bindings.changed"); /* update from bindings */
     /* Load the border shadow texture. */ {
-        SDL_Surface *surf = loadImage_(&imageShadow_Resources, 0);
+        SDL_Surface *surf = loadImage_(load_Resources(&imageShadow_Resources), 0);
         d->base.borderShadow = SDL_CreateTextureFromSurface(d->base.render, surf);
         SDL_SetTextureBlendMode(d->base.borderShadow, SDL_BLENDMODE_BLEND);
         free(surf->pixels);
         SDL_FreeSurface(surf);
     }
     /* Load the emboss graphic. */ {
-        SDL_Surface *surf = loadImage_(&imageLogo_Resources, 0);
+        SDL_Surface *surf = loadImage_(load_Resources(&imageLogo_Resources), 0);
         d->logo = SDL_CreateTextureFromSurface(d->base.render, surf);
         SDL_SetTextureBlendMode(d->logo, SDL_BLENDMODE_BLEND);
 #if SDL_VERSION_ATLEAST(2, 0, 12) && !defined (iPlatformTerminal)
@@ -860,7 +872,7 @@ void init_MainWindow(iMainWindow *d, iRect rect) {
 #if defined (LAGRANGE_ENABLE_CUSTOM_FRAME)
     /* Load the app icon for drawing in the title bar. */
     if (prefs_App()->customFrame) {
-        SDL_Surface *surf = loadImage_(&imageLagrange64_Resources, appIconSize_Root());
+        SDL_Surface *surf = loadImage_(load_Resources(&imageLagrange64_Resources), appIconSize_Root());
         SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
         d->appIcon = SDL_CreateTextureFromSurface(d->base.render, surf);
         free(surf->pixels);
@@ -1539,6 +1551,11 @@ static uint32_t windowId_SDLEvent_(const SDL_Event *ev) {
     }
 }
 
+static iBool isRefreshOnlyCommand_(const SDL_Event *ev) {
+    /* Periodic updates whose handlers refresh everything they change. */
+    return isCommand_UserEvent(ev, "window.reload.update");
+}
+
 iBool dispatchEvent_Window(iWindow *d, const SDL_Event *ev) {
     /* For the right window? */
     const uint32_t evWin = windowId_SDLEvent_(ev);
@@ -1546,10 +1563,18 @@ iBool dispatchEvent_Window(iWindow *d, const SDL_Event *ev) {
         return iFalse; /* Meant for a different window. */
     }
     const iWidget *oldHover = d->hover;
+    const iRect oldHoverBounds = oldHover ? bounds_Widget(oldHover) : zero_Rect();
     if (ev->type == SDL_MOUSEMOTION) {
         /* Hover widget may change. */
         setHover_Widget(NULL);
     }
+    if ((ev->type != SDL_MOUSEMOTION || d->mouseGrab) &&
+        !(ev->type == SDL_USEREVENT && ev->user.code != command_UserEventCode) &&
+        !isRefreshOnlyCommand_(ev)) {
+        /* Input events and commands may change any part of the UI without each affected
+           widget asking for a refresh. */
+        setFullDamage_Window(d);
+    }
     iBool wasUsed = iFalse;
     iRoot *order[2];
     rootOrder_Window(d, order);
@@ -1586,6 +1611,7 @@ iBool dispatchEvent_Window(iWindow *d, const SDL_Event *ev) {
         }
     }
     if (d->hover != oldHover) {
+        postDamage_Window(d, expanded_Rect(oldHoverBounds, init1_I2(gap_UI)));
         refresh_Widget(d->hover); /* Note: oldHover may have been deleted */
         if (d->hover && d->hover->flags2 & commandOnHover_WidgetFlag2) {
             notifyHovered_Window_(d);
@@ -1629,6 +1655,7 @@ void draw_Window(iWindow *d) {
         return;
     }
     isDrawing_ = iTrue;
+    d->damage = zero_Rect(); /* always redrawn fully */
     iPaint p;
     init_Paint(&p);
     iRoot *root = d->roots[0];
@@ -1696,6 +1723,7 @@ void draw_MainWindow(iMainWindow *d) {
         return;
     }
     isDrawing_ = iTrue;
+    beginFrame_Profiler();
     if (deviceType_App() == desktop_AppDeviceType) {
         checkPixelRatioChange_Window_(&d->base);
     }
@@ -1732,6 +1760,7 @@ void draw_MainWindow(iMainWindow *d) {
                 if (d->backBuf) {
                     SDL_DestroyTexture(d->backBuf);
                 }
+                setFullDamage_Window(w); /* new buffer has no contents */
                 d->backBuf = SDL_CreateTexture(d->base.render,
                                                SDL_PIXELFORMAT_RGB888,
                                                SDL_TEXTUREACCESS_TARGET,
@@ -1749,6 +1778,24 @@ void draw_MainWindow(iMainWindow *d) {
     if (d->backBuf) {
         SDL_SetRenderTarget(d->base.render, d->backBuf);
     }
+    /* Only the damaged area needs repainting if the previous frame is retained. */ {
+        iBool isFull = exchange_Atomic(&w->isFullyDamaged, iFalse);
+#if defined (LAGRANGE_ENABLE_PARTIAL_REDRAW)
+        iForIndices(i, w->roots) {
+            if (w->roots[i] && w->roots[i]->didChangeArrangement) {
+                isFull = iTrue;
+            }
+        }
+        w->drawDamage = (isFull || !d->backBuf || isEnabled_Profiler()
+                             ? zero_Rect()
+                             : intersect_Rect(w->damage, (iRect){ zero_I2(), w->size }));
+#else
+        iUnused(isFull);
+        w->drawDamage = zero_Rect();
+#endif
+        w->damage = zero_Rect();
+        setDamage_Paint(d->backBuf, w->drawDamage);
+    }
     /* Clear the window. The clear color is visible as a border around the window
        when the custom frame is being used. */ {
         setCurrent_Root(w->roots[0]);
@@ -1767,7 +1814,12 @@ void draw_MainWindow(iMainWindow *d) {
 #endif
         unsetClip_Paint(&p); /* update clip to full window */
         SDL_SetRenderDrawColor(w->render, back.r, back.g, back.b, 255);
-        SDL_RenderClear(w->render);
+        if (isEmpty_Rect(w->drawDamage)) {
+            SDL_RenderClear(w->render);
+        }
+        else {
+            SDL_RenderFillRect(w->render, (const SDL_Rect *) &w->drawDamage);
+        }
     }
     /* Draw widgets. */
     w->frameTime = SDL_GetTicks();
@@ -1806,6 +1858,7 @@ void draw_MainWindow(iMainWindow *d) {
                     iColor iconColor    = get_Color(gotFocus || isLight ? white_ColorId : uiAnnotation_ColorId);
                     SDL_SetTextureColorMod(d->appIcon, iconColor.r, iconColor.g, iconColor.b);
                     SDL_SetTextureAlphaMod(d->appIcon, gotFocus || !isLight ? 255 : 92);
+                    iCountFrame(renderCopies);
                     SDL_RenderCopy(
                         w->render,
                         d->appIcon,
@@ -1833,6 +1886,7 @@ void draw_MainWindow(iMainWindow *d) {
                 }
             }
         }
+        endFrame_Profiler(w);
         setCurrent_Root(NULL);
 #if !defined (NDEBUG)
         draw_Text(uiLabelBold_FontId,
@@ -1843,6 +1897,11 @@ void draw_MainWindow(iMainWindow *d) {
         drawCount_ = 0;
 #endif
     }
+    else {
+        setFullDamage_Window(w); /* damage was not repainted */
+    }
+    setDamage_Paint(NULL, zero_Rect());
+    w->drawDamage = zero_Rect();
     if (d->backBuf) {
         SDL_SetRenderTarget(d->base.render, NULL);
         SDL_RenderCopy(d->base.render, d->backBuf, NULL, NULL);
@@ -1961,6 +2020,17 @@ void setCurrent_Window(iAnyWindow *d) {
     }
 }
 
+void setFullDamage_Window(iAnyWindow *d) {
+    if (d) {
+        set_Atomic(&((iWindow *) d)->isFullyDamaged, iTrue);
+    }
+}
+
+iBool isDamaged_Window(const iAnyWindow *d, iRect rect) {
+    const iWindow *w = d;
+    return !w || isEmpty_Rect(w->drawDamage) || isOverlapping_Rect(w->drawDamage, rect);
+}
+
 iMainWindow *get_MainWindow(void) {
     return theMainWindow_;
 }
@@ -94,6 +94,9 @@ struct Impl_Window {
     iBool         isMouseInside;
     iBool         isInvalidated;
     iAtomicInt    isRefreshPending;
+    iAtomicInt    isFullyDamaged; /* next draw must repaint everything */
+    iRect         damage;       /* union of refreshed areas since the last draw (window coords) */
+    iRect         drawDamage;   /* area being repainted; empty means the whole window */
     iBool         ignoreClick; /* used on the Windows platform only */
     uint32_t      focusGainedAt;
     SDL_Renderer *render;
@@ -129,7 +132,7 @@ struct Impl_MainWindow {
     SDL_Texture * logo;
     int           keyboardHeight; /* mobile software keyboards */
     int           maxDrawableHeight;
-    iBool         enableBackBuf; /* only used on macOS with Metal (helps with refresh glitches for some reason??) */
+    iBool         enableBackBuf; /* macOS with Metal (helps with refresh glitches for some reason??), partial redraw */
     SDL_Texture * backBuf; /* enables refreshing the window without redrawing anything */
 };
 
@@ -170,6 +173,9 @@ iBool       isOpenGLRenderer_Window (void);
 
 void        setCurrent_Window       (iAnyWindow *);
 void        postRefresh_Window      (iAnyWindow *);
+void        postDamage_Window       (iAnyWindow *, iRect rect); /* refresh only part of the window */
+void        setFullDamage_Window    (iAnyWindow *);
+iBool       isDamaged_Window        (const iAnyWindow *, iRect rect);
 
 iLocalDef iBool isExposed_Window(const iWindow *d) {
     iAssert(d);
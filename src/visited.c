@@ -246,6 +246,17 @@ iBool containsUrl_Visited(const iVisited *d, const iString *url) {
     return isValid_Time(&time);
 }
 
+size_t memorySize_Visited(const iVisited *d) {
+    size_t size = 0;
+    iGuardMutex(d->mtx, {
+        size = size_SortedArray(&d->visited) * sizeof(iVisitedUrl);
+        iConstForEach(Array, i, &d->visited.values) {
+            size += size_String(&((const iVisitedUrl *) i.value)->url);
+        }
+    });
+    return size;
+}
+
 static int cmpWhenDescending_VisitedUrlPtr_(const void *a, const void *b) {
     const iVisitedUrl *s = *(const void **) a, *t = *(const void **) b;
     return -cmp_Time(&s->when, &t->when);
@@ -59,6 +59,7 @@ void    visitUrlTime_Visited    (iVisited *, const iString *url, uint16_t visitF
 void    setUrlKept_Visited      (iVisited *, const iString *url, iBool isKept); /* URL is marked as (non)discardable */
 void    removeUrl_Visited       (iVisited *, const iString *url);
 iBool   containsUrl_Visited     (const iVisited *, const iString *url);
+size_t  memorySize_Visited      (const iVisited *); /* bytes */
 
 const iPtrArray *   list_Visited        (const iVisited *, size_t count); /* returns collected */
 const iPtrArray *   listMatching_Visited(const iVisited *, const char *prefix);